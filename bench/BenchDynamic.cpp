@@ -0,0 +1,101 @@
+#include <melon/FeatureExpansion.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <benchmark/benchmark.h>
+
+#include <memory>
+
+namespace {
+
+constexpr size_t NumExamples = 1 << 16;
+
+ml::Dataset<ml::Dynamic> syntheticDataset(const size_t numFeatures) {
+    ml::Random random;
+    ml::Dataset<ml::Dynamic> dataset(0, numFeatures);
+    dataset.reserve(NumExamples);
+    for (size_t i = 0; i < NumExamples; i++)
+        dataset.emplace_back(random.uniform<ml::DynamicVector>(numFeatures, -1.0, 1.0),
+                             random.uniform<ml::Vector<1>>(0.0, 1.0)[0]);
+    return dataset;
+}
+
+/**
+ * Copy of a Dynamic dataset with its number of features fixed at compile time.
+ */
+template <size_t dim> ml::Dataset<dim> fixedDataset(const ml::Dataset<ml::Dynamic> &dynamic) {
+    ml::Dataset<dim> dataset(dynamic.size());
+    for (size_t i = 0; i < dynamic.size(); i++) {
+        std::copy(dynamic.row(i), dynamic.row(i) + dim, dataset.row(i));
+        dataset.label(i) = dynamic.label(i);
+    }
+    return dataset;
+}
+
+template <template <size_t> class TCostFunction, size_t dim>
+void BM_FixedValueAndGradient(benchmark::State &state) {
+    const auto dataset = fixedDataset<dim>(syntheticDataset(dim));
+    const TCostFunction<dim> costFunction(dataset.view());
+    const auto parameters =
+        ml::Random().uniform<typename TCostFunction<dim>::argument_type>(-0.5, 0.5);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(costFunction.valueAndGradient(parameters));
+
+    state.SetItemsProcessed(state.iterations() * NumExamples);
+}
+
+template <template <size_t> class TCostFunction, size_t dim>
+void BM_DynamicValueAndGradient(benchmark::State &state) {
+    const auto dataset = syntheticDataset(dim);
+    const TCostFunction<ml::Dynamic> costFunction(dataset.view());
+    const auto parameters = ml::Random().uniform<ml::DynamicVector>(dim + 1, -0.5, 0.5);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(costFunction.valueAndGradient(parameters));
+
+    state.SetItemsProcessed(state.iterations() * NumExamples);
+}
+
+/**
+ * valueAndGradient() of a logistic cost over the degree 3 polynomial of 8 features, 164
+ * features in all, expanded as blocks are read when Lazy, or precomputed into a dataset.
+ */
+template <bool Lazy> void BM_PolynomialValueAndGradient(benchmark::State &state) {
+    const auto dataset = syntheticDataset(8);
+    ml::FeatureExpansion expansion(8);
+    expansion.withPolynomialDegree(3);
+
+    ml::Dataset<ml::Dynamic> expanded(Lazy ? 0 : dataset.size(), expansion.numOutputs());
+    for (size_t i = 0; i < expanded.size(); i++) {
+        expansion.expand(dataset.row(i), expanded.row(i));
+        expanded.label(i) = dataset.label(i);
+    }
+
+    ml::LogisticRegressionCostFunction<ml::Dynamic> costFunction(Lazy ? dataset.view()
+                                                                      : expanded.view());
+    if (Lazy)
+        costFunction.setFeatureExpansion(std::make_shared<const ml::FeatureExpansion>(expansion));
+    const auto parameters =
+        ml::Random().uniform<ml::DynamicVector>(expansion.numOutputs() + 1, -0.5, 0.5);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(costFunction.valueAndGradient(parameters));
+
+    state.SetItemsProcessed(state.iterations() * NumExamples);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_FixedValueAndGradient, ml::LinearRegressionCostFunction, 4);
+BENCHMARK_TEMPLATE(BM_DynamicValueAndGradient, ml::LinearRegressionCostFunction, 4);
+BENCHMARK_TEMPLATE(BM_FixedValueAndGradient, ml::LinearRegressionCostFunction, 32);
+BENCHMARK_TEMPLATE(BM_DynamicValueAndGradient, ml::LinearRegressionCostFunction, 32);
+BENCHMARK_TEMPLATE(BM_FixedValueAndGradient, ml::LinearRegressionCostFunction, 256);
+BENCHMARK_TEMPLATE(BM_DynamicValueAndGradient, ml::LinearRegressionCostFunction, 256);
+BENCHMARK_TEMPLATE(BM_FixedValueAndGradient, ml::LogisticRegressionCostFunction, 4);
+BENCHMARK_TEMPLATE(BM_DynamicValueAndGradient, ml::LogisticRegressionCostFunction, 4);
+BENCHMARK_TEMPLATE(BM_FixedValueAndGradient, ml::LogisticRegressionCostFunction, 32);
+BENCHMARK_TEMPLATE(BM_DynamicValueAndGradient, ml::LogisticRegressionCostFunction, 32);
+BENCHMARK_TEMPLATE(BM_PolynomialValueAndGradient, false);
+BENCHMARK_TEMPLATE(BM_PolynomialValueAndGradient, true);
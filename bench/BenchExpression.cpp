@@ -0,0 +1,119 @@
+#include <melon/Random.h>
+#include <melon/Simd.h>
+#include <melon/Types.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+/**
+ * Inputs of a gradient step x - rate * g and of feature normalization (x - means) / sdevs.
+ */
+struct Operands {
+    ml::DynamicVector x, g, means, sdevs;
+
+    explicit Operands(const size_t size) {
+        ml::Random random;
+        x = random.uniform<ml::DynamicVector>(size, -1.0, 1.0);
+        g = random.uniform<ml::DynamicVector>(size, -1.0, 1.0);
+        means = random.uniform<ml::DynamicVector>(size, -1.0, 1.0);
+        sdevs = random.uniform<ml::DynamicVector>(size, 0.5, 2.0);
+    }
+};
+
+/**
+ * Gradient step evaluated one operator at a time, each into a temporary, as the operators did
+ * before expression templates: two passes and one temporary.
+ */
+void BM_StepEager(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+    ml::DynamicVector scaled(size), result(size);
+
+    for (auto _ : state) {
+        ml::simd::mul(operands.g.data(), 1E-3, scaled.data(), size);
+        ml::simd::sub(operands.x.data(), scaled.data(), result.data(), size);
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size * 3 * sizeof(double));
+}
+
+void BM_StepFused(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+    ml::DynamicVector result(size);
+
+    for (auto _ : state) {
+        (operands.x - 1E-3 * operands.g).evalTo(result.data());
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size * 3 * sizeof(double));
+}
+
+void BM_NormalizeEager(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+    ml::DynamicVector centered(size), result(size);
+
+    for (auto _ : state) {
+        ml::simd::sub(operands.x.data(), operands.means.data(), centered.data(), size);
+        ml::simd::div(centered.data(), operands.sdevs.data(), result.data(), size);
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size * 4 * sizeof(double));
+}
+
+void BM_NormalizeFused(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+    ml::DynamicVector result(size);
+
+    for (auto _ : state) {
+        ((operands.x - operands.means) / operands.sdevs).evalTo(result.data());
+        benchmark::DoNotOptimize(result.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * size * 4 * sizeof(double));
+}
+
+/**
+ * Squared distance, the convergence test of stochastic gradient descent: a temporary difference
+ * then a reduction, against a reduction of the expression block by block.
+ */
+void BM_DistanceEager(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+    ml::DynamicVector difference(size);
+
+    for (auto _ : state) {
+        ml::simd::sub(operands.x.data(), operands.g.data(), difference.data(), size);
+        benchmark::DoNotOptimize(ml::simd::sumOfSquares(difference.data(), size));
+    }
+
+    state.SetBytesProcessed(state.iterations() * size * 2 * sizeof(double));
+}
+
+void BM_DistanceFused(benchmark::State &state) {
+    const size_t size = state.range(0);
+    Operands operands(size);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(ml::sqLength(operands.x - operands.g));
+
+    state.SetBytesProcessed(state.iterations() * size * 2 * sizeof(double));
+}
+
+void vectorSizes(benchmark::internal::Benchmark *benchmark) {
+    benchmark->RangeMultiplier(32)->Range(1 << 10, 1 << 20);
+}
+} // namespace
+
+BENCHMARK(BM_StepEager)->Apply(vectorSizes);
+BENCHMARK(BM_StepFused)->Apply(vectorSizes);
+BENCHMARK(BM_NormalizeEager)->Apply(vectorSizes);
+BENCHMARK(BM_NormalizeFused)->Apply(vectorSizes);
+BENCHMARK(BM_DistanceEager)->Apply(vectorSizes);
+BENCHMARK(BM_DistanceFused)->Apply(vectorSizes);
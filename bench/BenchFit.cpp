@@ -0,0 +1,140 @@
+#include <melon/BatchTrainer.h>
+#include <melon/GradientDescent.h>
+#include <melon/LBFGS.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+constexpr size_t MaxExamples = 1 << 18;
+constexpr size_t FitExamples = 1 << 14;
+
+/**
+ * MaxExamples examples labeled by a random model of dim features, with noise, or with the
+ * class of the noisy score when Binary.
+ */
+template <size_t dim, bool Binary> const ml::Dataset<dim> &syntheticDataset() {
+    static const ml::Dataset<dim> dataset = [] {
+        ml::Random random;
+        const ml::LinearModel<dim> model(
+            random.uniform<typename ml::LinearModel<dim>::parameters_type>(-1.0, 1.0));
+        ml::Dataset<dim> dataset;
+        dataset.reserve(MaxExamples);
+        for (size_t i = 0; i < MaxExamples; i++) {
+            const auto x = random.uniform<ml::Vector<dim>>(-1.0, 1.0);
+            const double y = model.eval(x) + random.uniform<ml::Vector<1>>(-0.5, 0.5)[0];
+            dataset.emplace_back(x, Binary ? (y > 0.0 ? 1.0 : 0.0) : y);
+        }
+        return dataset;
+    }();
+
+    return dataset;
+}
+
+/**
+ * eval() and gradient() of a cost function over the first state.range(0) examples, from data
+ * in cache to data well beyond the last level cache.
+ */
+template <typename TCostFunction, bool Binary, bool Gradient>
+void BM_CostBySize(benchmark::State &state) {
+    constexpr size_t dim = TCostFunction::model_type::ArgumentDim;
+    const size_t numExamples = state.range(0);
+    const TCostFunction costFunction(syntheticDataset<dim, Binary>().view().slice(0, numExamples));
+    const auto parameters = ml::Random().uniform<typename TCostFunction::argument_type>(-0.5, 0.5);
+
+    for (auto _ : state) {
+        if constexpr (Gradient)
+            benchmark::DoNotOptimize(costFunction.gradient(parameters));
+        else
+            benchmark::DoNotOptimize(costFunction.eval(parameters));
+    }
+
+    state.SetItemsProcessed(state.iterations() * numExamples);
+}
+
+/**
+ * Full fit, normalization included, of FitExamples examples from random initial parameters.
+ */
+template <typename TRegression, typename TOptimizer, bool Binary>
+void BM_Fit(benchmark::State &state) {
+    constexpr size_t dim = TRegression::ArgumentDim;
+    const auto view = syntheticDataset<dim, Binary>().view().slice(0, FitExamples);
+
+    for (auto _ : state) {
+        TRegression regression;
+        regression.fit(view, TOptimizer());
+        benchmark::DoNotOptimize(regression.scoringModel().parameters().data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * FitExamples);
+}
+
+/**
+ * Batch of 256 logistic regressions on slices of 64 to 4096 examples, most of them small, on
+ * state.range(0) threads.
+ */
+void BM_BatchTrainer(benchmark::State &state) {
+    const auto view = syntheticDataset<8, true>().view();
+    using Trainer = ml::BatchTrainer<ml::LogisticRegression<8>, ml::LBFGS>;
+    std::vector<Trainer::Job> jobs;
+    size_t offset = 0, numExamples = 0;
+    for (size_t j = 0; j < 256; j++) {
+        const size_t size = j % 32 == 0 ? 4096 : 64 + 8 * (j % 32);
+        jobs.push_back({view.slice(offset, offset + size)});
+        offset += size;
+        numExamples += size;
+    }
+
+    Trainer trainer;
+    trainer.withNumThreads(state.range(0));
+    for (auto _ : state)
+        benchmark::DoNotOptimize(trainer.fit(jobs).wallSeconds);
+
+    state.SetItemsProcessed(state.iterations() * numExamples);
+}
+
+void datasetSizes(benchmark::internal::Benchmark *benchmark) {
+    benchmark->RangeMultiplier(16)->Range(1 << 10, MaxExamples);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LinearRegressionCostFunction<8>, false, false)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LinearRegressionCostFunction<8>, false, true)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LinearRegressionCostFunction<64>, false, false)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LinearRegressionCostFunction<64>, false, true)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LogisticRegressionCostFunction<8>, true, false)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LogisticRegressionCostFunction<8>, true, true)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LogisticRegressionCostFunction<64>, true, false)
+    ->Apply(datasetSizes);
+BENCHMARK_TEMPLATE(BM_CostBySize, ml::LogisticRegressionCostFunction<64>, true, true)
+    ->Apply(datasetSizes);
+
+BENCHMARK_TEMPLATE(BM_Fit, ml::LinearRegression<8>, ml::GradientDescent, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fit, ml::LinearRegression<8>, ml::LBFGS, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fit, ml::LinearRegression<64>, ml::LBFGS, false)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fit, ml::LogisticRegression<8>, ml::GradientDescent, true)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fit, ml::LogisticRegression<8>, ml::LBFGS, true)
+    ->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_Fit, ml::LogisticRegression<64>, ml::LBFGS, true)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_BatchTrainer)
+    ->RangeMultiplier(2)
+    ->Range(1, 8)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
@@ -0,0 +1,70 @@
+#include <melon/LinearModel.h>
+#include <melon/LogisticModel.h>
+#include <melon/Random.h>
+#include <melon/Types.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+constexpr size_t NumRows = 1024;
+
+template <typename TModel> void BM_Eval(benchmark::State &state) {
+    using argument_type = typename TModel::argument_type;
+    ml::Random random;
+    const TModel model(random.uniform<typename TModel::parameters_type>(-0.5, 0.5));
+    std::vector<argument_type> rows(NumRows);
+    for (auto &row : rows)
+        row = random.uniform<argument_type>(-1.0, 1.0);
+
+    for (auto _ : state) {
+        double sum = 0.0;
+        for (const auto &row : rows)
+            sum += model.eval(row);
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * NumRows);
+}
+
+/**
+ * Element-wise operators of Types.h, as used by the optimizers on parameter vectors: an axpy
+ * step x + s * d and a component-wise product.
+ */
+template <typename TVector> void BM_VectorOperators(benchmark::State &state, TVector x) {
+    using ml::operator+;
+    using ml::operator*;
+
+    const TVector d = x + 1.0;
+    const TVector scale = x * 0.5 + 2.0;
+
+    for (auto _ : state) {
+        x = x + d * 1E-9;
+        const TVector product = x * scale;
+        benchmark::DoNotOptimize(product.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * x.size());
+}
+
+template <size_t dim> void BM_FixedVectorOperators(benchmark::State &state) {
+    BM_VectorOperators(state, ml::Random().uniform<ml::Vector<dim>>(-1.0, 1.0));
+}
+
+void BM_DynamicVectorOperators(benchmark::State &state) {
+    BM_VectorOperators(state, ml::Random().uniform<ml::DynamicVector>(state.range(0), -1.0, 1.0));
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Eval, ml::LinearModel<4>);
+BENCHMARK_TEMPLATE(BM_Eval, ml::LinearModel<32>);
+BENCHMARK_TEMPLATE(BM_Eval, ml::LinearModel<256>);
+BENCHMARK_TEMPLATE(BM_Eval, ml::LogisticModel<4>);
+BENCHMARK_TEMPLATE(BM_Eval, ml::LogisticModel<32>);
+BENCHMARK_TEMPLATE(BM_Eval, ml::LogisticModel<256>);
+BENCHMARK_TEMPLATE(BM_FixedVectorOperators, 4);
+BENCHMARK_TEMPLATE(BM_FixedVectorOperators, 33);
+BENCHMARK_TEMPLATE(BM_FixedVectorOperators, 257);
+BENCHMARK(BM_DynamicVectorOperators)->Arg(4)->Arg(33)->Arg(257)->Arg(4097);
@@ -0,0 +1,52 @@
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <benchmark/benchmark.h>
+
+#include <thread>
+
+namespace {
+
+constexpr size_t Dim = 32;
+constexpr size_t NumExamples = 1 << 18;
+
+const ml::Dataset<Dim> &syntheticDataset() {
+    static const ml::Dataset<Dim> dataset = [] {
+        ml::Random random;
+        ml::Dataset<Dim> dataset;
+        dataset.reserve(NumExamples);
+        for (size_t i = 0; i < NumExamples; i++)
+            dataset.emplace_back(random.uniform<ml::Vector<Dim>>(-1.0, 1.0),
+                                 random.uniform<ml::Vector<1>>(0.0, 1.0)[0]);
+        return dataset;
+    }();
+
+    return dataset;
+}
+
+template <typename TCostFunction> void BM_ParallelValueAndGradient(benchmark::State &state) {
+    TCostFunction costFunction(syntheticDataset());
+    costFunction.setThreadPool(std::make_shared<ml::ThreadPool>(state.range(0)));
+    const auto parameters = ml::Random().uniform<typename TCostFunction::argument_type>(-0.5, 0.5);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(costFunction.valueAndGradient(parameters));
+
+    state.SetItemsProcessed(state.iterations() * NumExamples);
+}
+
+void threadCounts(benchmark::internal::Benchmark *benchmark) {
+    const size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (size_t numThreads = 1; numThreads < maxThreads; numThreads *= 2)
+        benchmark->Arg(numThreads);
+    benchmark->Arg(maxThreads);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ParallelValueAndGradient, ml::LinearRegressionCostFunction<Dim>)
+    ->Apply(threadCounts)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ParallelValueAndGradient, ml::LogisticRegressionCostFunction<Dim>)
+    ->Apply(threadCounts)
+    ->UseRealTime();
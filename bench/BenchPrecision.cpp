@@ -0,0 +1,47 @@
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+constexpr size_t Dim = 32;
+constexpr size_t NumExamples = 1 << 19;
+
+/**
+ * Examples well beyond the last level cache, so that evaluation is bound by memory bandwidth.
+ */
+template <typename TScalar> const ml::Dataset<Dim, TScalar> &syntheticDataset() {
+    static const ml::Dataset<Dim, TScalar> dataset = [] {
+        ml::Random random;
+        ml::Dataset<Dim, TScalar> dataset;
+        dataset.reserve(NumExamples);
+        for (size_t i = 0; i < NumExamples; i++)
+            dataset.emplace_back(random.uniform<ml::Vector<Dim>>(-1.0, 1.0),
+                                 random.uniform<ml::Vector<1>>(0.0, 1.0)[0]);
+        return dataset;
+    }();
+
+    return dataset;
+}
+
+template <typename TCostFunction> void BM_ValueAndGradient(benchmark::State &state) {
+    const TCostFunction costFunction(
+        syntheticDataset<typename TCostFunction::scalar_type>().view());
+    const auto parameters = ml::Random().uniform<typename TCostFunction::argument_type>(-0.5, 0.5);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(costFunction.valueAndGradient(parameters));
+
+    state.SetItemsProcessed(state.iterations() * NumExamples);
+    state.SetBytesProcessed(state.iterations() * NumExamples *
+                            ml::Dataset<Dim, typename TCostFunction::scalar_type>::stride() *
+                            sizeof(typename TCostFunction::scalar_type));
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_ValueAndGradient, ml::LinearRegressionCostFunction<Dim, double>);
+BENCHMARK_TEMPLATE(BM_ValueAndGradient, ml::LinearRegressionCostFunction<Dim, float>);
+BENCHMARK_TEMPLATE(BM_ValueAndGradient, ml::LogisticRegressionCostFunction<Dim, double>);
+BENCHMARK_TEMPLATE(BM_ValueAndGradient, ml::LogisticRegressionCostFunction<Dim, float>);
@@ -0,0 +1,81 @@
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+namespace {
+
+constexpr size_t NumRows = 1 << 16;
+
+template <size_t dim> const ml::Dataset<dim> &syntheticDataset() {
+    static const ml::Dataset<dim> dataset = [] {
+        ml::Random random;
+        ml::Dataset<dim> dataset;
+        dataset.reserve(NumRows);
+        for (size_t i = 0; i < NumRows; i++)
+            dataset.emplace_back(random.uniform<ml::Vector<dim>>(-1.0, 1.0),
+                                 random.uniform<ml::Vector<1>>(0.0, 1.0)[0]);
+        return dataset;
+    }();
+
+    return dataset;
+}
+
+template <typename TRegression> TRegression fittedRegression() {
+    constexpr size_t dim = TRegression::ArgumentDim;
+    ml::GradientDescent::HyperParameters hyperParameters;
+    hyperParameters.maxIter = 1;
+
+    TRegression regression;
+    regression.fit(syntheticDataset<dim>().view().slice(0, 1024),
+                   ml::GradientDescent().withHyperParameters(hyperParameters));
+    return regression;
+}
+
+template <typename TRegression> void BM_Predict(benchmark::State &state) {
+    constexpr size_t dim = TRegression::ArgumentDim;
+    const auto regression = fittedRegression<TRegression>();
+    const auto &dataset = syntheticDataset<dim>();
+
+    std::vector<typename TRegression::argument_type> rows(NumRows);
+    for (size_t i = 0; i < NumRows; i++)
+        std::copy(dataset.row(i), dataset.row(i) + dim, rows[i].begin());
+    std::vector<double> predictions(NumRows);
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < NumRows; i++)
+            predictions[i] = regression.predict(rows[i]);
+        benchmark::DoNotOptimize(predictions.data());
+    }
+
+    state.counters["rows/s"] = benchmark::Counter(static_cast<double>(state.iterations() * NumRows),
+                                                  benchmark::Counter::kIsRate);
+}
+
+template <typename TRegression> void BM_PredictBatch(benchmark::State &state) {
+    constexpr size_t dim = TRegression::ArgumentDim;
+    const auto regression = fittedRegression<TRegression>();
+    const auto &dataset = syntheticDataset<dim>();
+    std::vector<double> predictions(NumRows);
+
+    for (auto _ : state) {
+        regression.predictBatch(dataset, predictions.data());
+        benchmark::DoNotOptimize(predictions.data());
+    }
+
+    state.counters["rows/s"] = benchmark::Counter(static_cast<double>(state.iterations() * NumRows),
+                                                  benchmark::Counter::kIsRate);
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(BM_Predict, ml::LinearRegression<8>);
+BENCHMARK_TEMPLATE(BM_PredictBatch, ml::LinearRegression<8>);
+BENCHMARK_TEMPLATE(BM_Predict, ml::LinearRegression<32>);
+BENCHMARK_TEMPLATE(BM_PredictBatch, ml::LinearRegression<32>);
+BENCHMARK_TEMPLATE(BM_Predict, ml::LogisticRegression<8>);
+BENCHMARK_TEMPLATE(BM_PredictBatch, ml::LogisticRegression<8>);
+BENCHMARK_TEMPLATE(BM_Predict, ml::LogisticRegression<32>);
+BENCHMARK_TEMPLATE(BM_PredictBatch, ml::LogisticRegression<32>);
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Cache line size assumed for aligned storage, in bytes.
+ */
+constexpr size_t CacheLineSize = 64;
+
+/**
+ * Allocator returning storage aligned to Alignment bytes.
+ */
+template <typename T, size_t Alignment = CacheLineSize> class AlignedAllocator {
+  public:
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment> &) {}
+
+    T *allocate(const size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T *p, const size_t) { ::operator delete(p, std::align_val_t(Alignment)); }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment> &) const {
+        return true;
+    }
+
+    template <typename U> bool operator!=(const AlignedAllocator<U, Alignment> &) const {
+        return false;
+    }
+};
+
+template <typename T> using AlignedVector = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * Round n up to a whole number of cache lines worth of T.
+ */
+template <typename T> constexpr size_t paddedSize(const size_t n) {
+    constexpr size_t perLine = CacheLineSize / sizeof(T);
+    return (n + perLine - 1) / perLine * perLine;
+}
+} // namespace ml
@@ -0,0 +1,144 @@
+#pragma once
+
+#include <melon/GradientDescent.h>
+#include <melon/Random.h>
+#include <melon/ThreadPool.h>
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Fitted regression of one job of a batch, the time its fit took and the worker that ran it.
+ */
+template <typename TRegression> struct BatchTrainingResult {
+    TRegression regression;
+    double seconds = 0.0;
+    size_t worker = 0;
+};
+
+/**
+ * Results of every job, in the order of the jobs, and the wall time of the whole batch.
+ */
+template <typename TRegression> struct BatchTrainingReport {
+    std::vector<BatchTrainingResult<TRegression>> results;
+    double wallSeconds = 0.0;
+
+    /**
+     * Sum of the fit times of all jobs, the wall time of a serial run.
+     */
+    double totalSeconds() const {
+        return std::accumulate(results.begin(), results.end(), 0.0,
+                               [](const double sum, const BatchTrainingResult<TRegression> &r) {
+                                   return sum + r.seconds;
+                               });
+    }
+};
+
+/**
+ * Fits many small independent models, one regression per job, each on its own dataset and with its
+ * own hyperparameters. Jobs run on a thread pool with work stealing, largest datasets first and
+ * dealt round-robin across threads, so a few large jobs among many small ones start on different
+ * threads and do not leave threads idle. Every worker owns a scratch dataset into which the
+ * examples of its current job are copied and normalized, so its storage is reused from one job to
+ * the next and the cost function reads normalized examples without buffering. Individual fits are
+ * serial: the parallelism is across jobs.
+ */
+template <typename TRegression, typename TOptimizer = GradientDescent> class BatchTrainer {
+  public:
+    using regression_type = TRegression;
+    using optimizer_type = TOptimizer;
+    using dataset_type = typename regression_type::dataset_type;
+    using dataset_view_type = typename regression_type::dataset_view_type;
+    using report_type = BatchTrainingReport<regression_type>;
+
+    /**
+     * Examples and hyperparameters of one model. The dataset must outlive the call to fit().
+     */
+    struct Job {
+        dataset_view_type dataset;
+        double regularizationFactor = 1E-6;
+        double l1RegularizationFactor = 0.0;
+        uint64_t seed = Random::DefaultSeed;
+    };
+
+    /**
+     * Trainer fitting copies of prototype, which sets the hyperparameters shared by all jobs,
+     * for instance the number of classes of a softmax regression, with optimizer.
+     */
+    explicit BatchTrainer(optimizer_type optimizer = optimizer_type(),
+                          regression_type prototype = regression_type())
+        : m_optimizer(std::move(optimizer)), m_prototype(std::move(prototype)) {
+        m_prototype.withThreadPool(nullptr);
+    }
+
+    /**
+     * Run jobs on threadPool, which may be shared.
+     */
+    BatchTrainer &withThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+        return *this;
+    }
+
+    BatchTrainer &withNumThreads(const size_t numThreads) {
+        return withThreadPool(numThreads > 1 ? std::make_shared<ThreadPool>(numThreads) : nullptr);
+    }
+
+    /**
+     * Fit a regression for every job. Results do not depend on the number of threads.
+     */
+    report_type fit(const std::vector<Job> &jobs) {
+        const auto start = std::chrono::steady_clock::now();
+        const size_t numWorkers = m_threadPool ? m_threadPool->size() : 1;
+        if (m_scratch.size() < numWorkers)
+            m_scratch.resize(numWorkers);
+
+        std::vector<size_t> order(jobs.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](const size_t a, const size_t b) {
+            return jobs[a].dataset.size() > jobs[b].dataset.size();
+        });
+
+        report_type report;
+        report.results.assign(jobs.size(), BatchTrainingResult<regression_type>{m_prototype});
+
+        const auto fitJob = [&](const size_t task, const size_t worker) {
+            const size_t index = order[task];
+            const Job &job = jobs[index];
+            const auto jobStart = std::chrono::steady_clock::now();
+
+            auto &result = report.results[index];
+            result.regression.withRegularizationFactor(job.regularizationFactor)
+                .withL1RegularizationFactor(job.l1RegularizationFactor)
+                .withSeed(job.seed);
+            result.regression.fit(job.dataset, m_optimizer, m_scratch[worker]);
+
+            const std::chrono::duration<double> elapsed =
+                std::chrono::steady_clock::now() - jobStart;
+            result.seconds = elapsed.count();
+            result.worker = worker;
+        };
+
+        if (m_threadPool) {
+            m_threadPool->parallelForWorkStealing(jobs.size(), fitJob);
+        } else {
+            for (size_t task = 0; task < jobs.size(); task++)
+                fitJob(task, 0);
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report.wallSeconds = elapsed.count();
+        return report;
+    }
+
+  private:
+    optimizer_type m_optimizer;
+    regression_type m_prototype;
+    std::shared_ptr<ThreadPool> m_threadPool;
+    std::vector<dataset_type> m_scratch;
+};
+} // namespace ml
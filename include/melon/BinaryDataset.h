@@ -0,0 +1,322 @@
+#pragma once
+
+#include <melon/Dataset.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ml {
+
+/**
+ * Storage type of the features and labels of a binary dataset file.
+ */
+enum class ScalarType : uint32_t { Float32 = 4, Float64 = 8 };
+
+/**
+ * Header of a binary dataset file, in native byte order. The header is followed by numRows
+ * feature rows of stride scalars, of which the first numFeatures are used, and then by numRows
+ * labels. Both blocks start on a cache line boundary, so a file has the same layout as a
+ * Dataset of its scalar type and can be used in place once mapped.
+ */
+struct BinaryDatasetHeader {
+    static constexpr char Magic[8] = {'M', 'E', 'L', 'O', 'N', 'D', 'S', '1'};
+
+    char magic[8];
+    ScalarType scalarType;
+    uint32_t reserved;
+    uint64_t numFeatures;
+    uint64_t numRows;
+    uint64_t stride;
+    uint8_t padding[24];
+
+    size_t featuresOffset() const { return sizeof(BinaryDatasetHeader); }
+
+    size_t labelsOffset() const {
+        const size_t featuresEnd = featuresOffset() + numRows * stride * scalarSize();
+        return (featuresEnd + CacheLineSize - 1) / CacheLineSize * CacheLineSize;
+    }
+
+    size_t fileSize() const { return labelsOffset() + numRows * scalarSize(); }
+
+    size_t scalarSize() const { return static_cast<size_t>(scalarType); }
+
+    /**
+     * Whether the layout, of a valid scalar type, has the stride the writer uses for
+     * numFeatures and fits in size bytes. Sizes are checked before they are multiplied, so a
+     * header cannot wrap the computed file size around.
+     */
+    bool fitsIn(const size_t size) const {
+        if (size < featuresOffset() ||
+            numFeatures > std::numeric_limits<size_t>::max() / CacheLineSize)
+            return false;
+
+        const size_t expectedStride = scalarType == ScalarType::Float32
+                                          ? paddedSize<float>(numFeatures)
+                                          : paddedSize<double>(numFeatures);
+        if (stride != expectedStride)
+            return false;
+
+        const size_t available = size - featuresOffset();
+        if (stride > available / scalarSize() ||
+            numRows > available / ((stride + 1) * scalarSize()))
+            return false;
+
+        return fileSize() <= size;
+    }
+};
+
+static_assert(sizeof(BinaryDatasetHeader) == CacheLineSize);
+
+namespace detail {
+
+template <typename TScalar, typename TValue>
+void writeScalars(std::ofstream &file, const TValue *values, const size_t n,
+                  const size_t paddedSize) {
+    TScalar buffer[CacheLineSize] = {};
+    for (size_t begin = 0; begin < paddedSize; begin += CacheLineSize) {
+        const size_t count = std::min(CacheLineSize, paddedSize - begin);
+        for (size_t i = 0; i < count; i++)
+            buffer[i] = begin + i < n ? static_cast<TScalar>(values[begin + i]) : TScalar(0);
+        file.write(reinterpret_cast<const char *>(buffer), count * sizeof(TScalar));
+    }
+}
+
+/**
+ * Write numRows examples, where row(i) returns the numFeatures features of example i and
+ * label(i) its label.
+ */
+template <typename TRow, typename TLabel>
+void writeBinaryDataset(const std::string &path, const size_t numRows, const size_t numFeatures,
+                        const ScalarType scalarType, TRow &&row, TLabel &&label) {
+    BinaryDatasetHeader header{};
+    std::copy(std::begin(BinaryDatasetHeader::Magic), std::end(BinaryDatasetHeader::Magic),
+              header.magic);
+    header.scalarType = scalarType;
+    header.numFeatures = numFeatures;
+    header.numRows = numRows;
+    header.stride = scalarType == ScalarType::Float32 ? paddedSize<float>(numFeatures)
+                                                      : paddedSize<double>(numFeatures);
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error("cannot open " + path + " for writing");
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    const auto write = [&](const auto *values, const size_t n, const size_t paddedSize) {
+        if (scalarType == ScalarType::Float32)
+            writeScalars<float>(file, values, n, paddedSize);
+        else
+            writeScalars<double>(file, values, n, paddedSize);
+    };
+
+    for (size_t i = 0; i < numRows; i++)
+        write(row(i), numFeatures, header.stride);
+
+    const size_t gap = header.labelsOffset() - header.featuresOffset() -
+                       numRows * header.stride * header.scalarSize();
+    write(static_cast<const double *>(nullptr), 0, gap / header.scalarSize());
+
+    for (size_t i = 0; i < numRows; i++) {
+        const double y = label(i);
+        write(&y, 1, 1);
+    }
+
+    if (!file)
+        throw std::runtime_error("failed writing " + path);
+}
+} // namespace detail
+
+/**
+ * Write dataset to path in the binary dataset format.
+ */
+template <size_t dim, typename TScalar>
+void writeBinaryDataset(const std::string &path, const DatasetView<dim, TScalar> &dataset,
+                        const ScalarType scalarType = ScalarType::Float64) {
+    detail::writeBinaryDataset(
+        path, dataset.size(), dataset.numFeatures(), scalarType,
+        [&](const size_t i) { return dataset.row(i); },
+        [&](const size_t i) { return dataset.label(i); });
+}
+
+/**
+ * Convert trainingSet to the binary dataset format, one example at a time.
+ */
+template <typename TVector>
+void writeBinaryDataset(const std::string &path,
+                        const std::vector<std::pair<TVector, double>> &trainingSet,
+                        const ScalarType scalarType = ScalarType::Float64) {
+    const size_t numFeatures = trainingSet.empty() ? 0 : trainingSet.front().first.size();
+    detail::writeBinaryDataset(
+        path, trainingSet.size(), numFeatures, scalarType,
+        [&](const size_t i) { return trainingSet[i].first.data(); },
+        [&](const size_t i) { return trainingSet[i].second; });
+}
+
+/**
+ * Read-only memory mapping of a binary dataset file. Pages are loaded by the operating system on
+ * first access and can be evicted again, so the file may be larger than memory.
+ */
+template <size_t dim> class MappedBinaryDataset {
+  public:
+    explicit MappedBinaryDataset(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0 ||
+            static_cast<size_t>(status.st_size) < sizeof(BinaryDatasetHeader)) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a binary dataset");
+        }
+
+        m_size = static_cast<size_t>(status.st_size);
+        m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (m_data == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path);
+
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        if (!std::equal(std::begin(m_header.magic), std::end(m_header.magic),
+                        std::begin(BinaryDatasetHeader::Magic)) ||
+            (m_header.scalarType != ScalarType::Float32 &&
+             m_header.scalarType != ScalarType::Float64) ||
+            !m_header.fitsIn(m_size) ||
+            (dim != Dynamic && m_header.numFeatures != dim)) {
+            ::munmap(m_data, m_size);
+            throw std::runtime_error(path + " is not a binary dataset of matching dimension");
+        }
+    }
+
+    MappedBinaryDataset(const MappedBinaryDataset &) = delete;
+
+    MappedBinaryDataset &operator=(const MappedBinaryDataset &) = delete;
+
+    ~MappedBinaryDataset() { ::munmap(m_data, m_size); }
+
+    size_t size() const { return m_header.numRows; }
+
+    size_t numFeatures() const { return m_header.numFeatures; }
+
+    ScalarType scalarType() const { return m_header.scalarType; }
+
+    /**
+     * Whether the file stores TScalar, so that it can be viewed in place as TScalar.
+     */
+    template <typename TScalar> bool stores() const {
+        return m_header.scalarSize() == sizeof(TScalar);
+    }
+
+    /**
+     * Zero-copy view of the mapped examples, only available when the file stores TScalar.
+     */
+    template <typename TScalar = double> DatasetView<dim, TScalar> view() const {
+        if (!stores<TScalar>())
+            throw std::logic_error("binary dataset does not store the requested scalar type");
+
+        return {scalars<TScalar>(m_header.featuresOffset()),
+                scalars<TScalar>(m_header.labelsOffset()), size(), m_header.stride,
+                numFeatures()};
+    }
+
+    /**
+     * Copy rows [begin, end) converted to TScalar into features, rows stride elements apart,
+     * and their labels into labels.
+     */
+    template <typename TScalar>
+    void read(const size_t begin, const size_t end, TScalar *features, const size_t stride,
+              TScalar *labels) const {
+        if (m_header.scalarType == ScalarType::Float32)
+            readStored<float>(begin, end, features, stride, labels);
+        else
+            readStored<double>(begin, end, features, stride, labels);
+    }
+
+  private:
+    template <typename TScalar> const TScalar *scalars(const size_t offset) const {
+        return reinterpret_cast<const TScalar *>(static_cast<const char *>(m_data) + offset);
+    }
+
+    template <typename TStored, typename TScalar>
+    void readStored(const size_t begin, const size_t end, TScalar *features, const size_t stride,
+                    TScalar *labels) const {
+        const TStored *rows = scalars<TStored>(m_header.featuresOffset());
+        const TStored *y = scalars<TStored>(m_header.labelsOffset());
+        for (size_t i = begin; i < end; i++) {
+            const TStored *x = rows + i * m_header.stride;
+            std::copy(x, x + numFeatures(), features + (i - begin) * stride);
+            labels[i - begin] = static_cast<TScalar>(y[i]);
+        }
+    }
+
+    void *m_data{nullptr};
+    size_t m_size{0};
+    BinaryDatasetHeader m_header;
+};
+
+/**
+ * Sequence of chunks of chunkSize consecutive examples of a mapped binary dataset, as TScalar.
+ * Chunks of files that store TScalar are views of the mapping; chunks of other files are
+ * converted into a buffer of chunkSize rows, so at most one chunk is materialized at a time.
+ * A view returned by chunk() is valid until the next call; chunk() is not thread safe.
+ */
+template <size_t dim, typename TScalar = double> class ChunkedDatasetSource {
+  public:
+    using scalar_type = TScalar;
+    using argument_type = Vector<dim>;
+    using dataset_view_type = DatasetView<dim, TScalar>;
+
+    ChunkedDatasetSource(std::shared_ptr<const MappedBinaryDataset<dim>> dataset,
+                         const size_t chunkSize)
+        : m_dataset(std::move(dataset)), m_chunkSize(std::max<size_t>(1, chunkSize)) {}
+
+    size_t size() const { return m_dataset->size(); }
+
+    size_t numFeatures() const { return m_dataset->numFeatures(); }
+
+    size_t chunkSize() const { return m_chunkSize; }
+
+    size_t numChunks() const { return (size() + m_chunkSize - 1) / m_chunkSize; }
+
+    /**
+     * Examples [i * chunkSize(), min((i + 1) * chunkSize(), size())).
+     */
+    dataset_view_type chunk(const size_t i) const {
+        const size_t begin = i * m_chunkSize, end = std::min(begin + m_chunkSize, size());
+
+        if (m_dataset->template stores<TScalar>())
+            return m_dataset->template view<TScalar>().slice(begin, end);
+
+        if (m_bufferedChunk != i) {
+            if (m_buffer.size() != end - begin)
+                m_buffer = Dataset<dim, TScalar>(end - begin, numFeatures());
+
+            m_dataset->read(begin, end, m_buffer.row(0), m_buffer.stride(), &m_buffer.label(0));
+            m_bufferedChunk = i;
+        }
+
+        return m_buffer.view();
+    }
+
+  private:
+    static constexpr size_t NoChunk = static_cast<size_t>(-1);
+
+    std::shared_ptr<const MappedBinaryDataset<dim>> m_dataset;
+    size_t m_chunkSize;
+    mutable Dataset<dim, TScalar> m_buffer;
+    mutable size_t m_bufferedChunk{NoChunk};
+};
+} // namespace ml
@@ -0,0 +1,377 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/DifferentiableFunction.h>
+#include <melon/Simd.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Cyclic coordinate descent for linear and logistic regression with an elastic-net penalty,
+ * the cost (sum of losses + 0.5 * l2 * |w|^2 + l1 * |w|_1) / N of cost functions with
+ * regularizationFactor() l2 and l1RegularizationFactor() l1.
+ *
+ * Every iteration approximates the loss by a quadratic around the current scores, exact for the
+ * squared error, and minimizes the penalized approximation one coordinate at a time: the new
+ * weight is a soft-thresholded weighted correlation of its feature with the residuals of the
+ * approximation. Residuals are cached and updated after every change of a weight, so a
+ * coordinate update costs O(N) instead of a full gradient. A sweep over all coordinates is
+ * followed by sweeps over the active set of non-zero weights until these converge, and the
+ * iteration ends when a full sweep changes nothing. A backtracking line search on the whole
+ * step keeps the logistic cost decreasing.
+ *
+ * Works on cost functions that provide forEachBlock(), the static loss() and curvature() of
+ * their scores, and the two regularization factors, so any feature scaling and example
+ * selection of the cost function apply. The features are read once and kept in memory feature
+ * by feature.
+ */
+class CoordinateDescent {
+  public:
+    struct HyperParameters {
+        size_t maxIterations = 100; // quadratic approximations of the loss
+        size_t maxSweeps = 1000;    // coordinate sweeps per approximation
+        double tolerance = 1E-12;   // largest cost decrease per example of a converged sweep
+    };
+
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
+
+    CoordinateDescent &withHyperParameters(const HyperParameters hyperParameters) {
+        m_hyperParameters = hyperParameters;
+        return *this;
+    }
+
+    /**
+     * Minimize the cost starting from initialArguments. numIterations counts coordinate
+     * sweeps, and every evaluation of the loss also evaluates its gradient.
+     */
+    template <typename TCostFunction>
+    Result<typename TCostFunction::argument_type>
+    optimize(const TCostFunction &costFunction,
+             const typename TCostFunction::argument_type &initialArguments) const {
+        const Problem problem = gather(costFunction);
+        assert(initialArguments.size() == problem.numFeatures + 1);
+
+        std::vector<size_t> coordinates(problem.numFeatures);
+        std::iota(coordinates.begin(), coordinates.end(), 0);
+        return solve<TCostFunction>(problem, costFunction.regularizationFactor(),
+                                    costFunction.l1RegularizationFactor(), initialArguments,
+                                    coordinates);
+    }
+
+    /**
+     * Smallest L1 factor for which all weights of the solution are zero, the natural start of a
+     * regularization path.
+     */
+    template <typename TCostFunction>
+    double maxL1RegularizationFactor(const TCostFunction &costFunction) const {
+        const Problem problem = gather(costFunction);
+        const auto parameters = interceptOnly<TCostFunction>(problem, costFunction);
+        const auto correlations = lossCorrelations<TCostFunction>(problem, parameters);
+        return *std::max_element(correlations.begin(), correlations.end());
+    }
+
+    /**
+     * Solutions for every factor of l1Factors, in decreasing order, each starting from the
+     * previous one. Features are read once for the whole path, and coordinates are screened
+     * with the sequential strong rule: going from factor l1' to l1, a zero weight whose loss
+     * gradient was below 2 l1 - l1' is left out of the sweeps. The optimality conditions of
+     * the weights left out are checked at the solution, and violators are added back.
+     */
+    template <typename TCostFunction>
+    std::vector<Result<typename TCostFunction::argument_type>>
+    regularizationPath(const TCostFunction &costFunction, std::vector<double> l1Factors) const {
+        std::sort(l1Factors.begin(), l1Factors.end(), std::greater<double>());
+
+        const Problem problem = gather(costFunction);
+        const double l2 = costFunction.regularizationFactor();
+        auto parameters = interceptOnly<TCostFunction>(problem, costFunction);
+        auto correlations = lossCorrelations<TCostFunction>(problem, parameters);
+        double previousFactor = *std::max_element(correlations.begin(), correlations.end());
+
+        std::vector<Result<typename TCostFunction::argument_type>> path;
+        for (const double l1 : l1Factors) {
+            std::vector<char> screened(problem.numFeatures, 1);
+            std::vector<size_t> coordinates;
+            const auto include = [&](const size_t j) {
+                screened[j] = 0;
+                coordinates.push_back(j);
+            };
+            for (size_t j = 0; j < problem.numFeatures; j++)
+                if (parameters[j] != 0.0 || correlations[j] >= 2.0 * l1 - previousFactor)
+                    include(j);
+
+            for (;;) {
+                auto result = solve<TCostFunction>(problem, l2, l1, parameters, coordinates);
+                parameters = result.optimalArguments;
+                correlations = lossCorrelations<TCostFunction>(problem, parameters);
+
+                const size_t numCoordinates = coordinates.size();
+                for (size_t j = 0; j < problem.numFeatures; j++)
+                    if (screened[j] && correlations[j] > l1)
+                        include(j);
+
+                if (coordinates.size() == numCoordinates) {
+                    path.push_back(std::move(result));
+                    break;
+                }
+            }
+            previousFactor = l1;
+        }
+
+        return path;
+    }
+
+  private:
+    /**
+     * Lower bound on the curvature of the loss, so that the quadratic approximation stays
+     * bounded when logistic predictions saturate.
+     */
+    static constexpr double MinCurvature = 1E-5;
+
+    static constexpr size_t MaxLineSearchSteps = 30;
+
+    /**
+     * Features of all examples of a cost function, feature j of example i at
+     * columns[j * stride + i], and their labels.
+     */
+    struct Problem {
+        size_t numExamples = 0;
+        size_t numFeatures = 0;
+        size_t stride = 0;
+        AlignedVector<double> columns;
+        AlignedVector<double> labels;
+
+        const double *column(const size_t j) const { return columns.data() + j * stride; }
+    };
+
+    template <typename TCostFunction> static Problem gather(const TCostFunction &costFunction) {
+        Problem problem;
+        problem.numExamples = costFunction.numExamples();
+        problem.stride = paddedSize<double>(problem.numExamples);
+        problem.labels.resize(problem.numExamples);
+        assert(problem.numExamples > 0);
+
+        size_t offset = 0;
+        costFunction.forEachBlock([&](const auto &block) {
+            if (problem.columns.empty()) {
+                problem.numFeatures = block.numFeatures();
+                problem.columns.assign(problem.numFeatures * problem.stride, 0.0);
+            }
+
+            for (size_t j = 0; j < problem.numFeatures; j++) {
+                double *column = problem.columns.data() + j * problem.stride + offset;
+                for (size_t k = 0; k < block.size(); k++)
+                    column[k] = block.row(k)[j];
+            }
+            for (size_t k = 0; k < block.size(); k++)
+                problem.labels[offset + k] = block.label(k);
+            offset += block.size();
+        });
+
+        return problem;
+    }
+
+    static double softThreshold(const double x, const double threshold) {
+        return x > threshold ? x - threshold : x < -threshold ? x + threshold : 0.0;
+    }
+
+    /**
+     * Scores w . x + b of all examples.
+     */
+    static void computeScores(const Problem &problem, const double *parameters, double *scores) {
+        std::fill(scores, scores + problem.numExamples, parameters[problem.numFeatures]);
+        for (size_t j = 0; j < problem.numFeatures; j++)
+            if (parameters[j] != 0.0)
+                simd::axpy(parameters[j], problem.column(j), scores, problem.numExamples);
+    }
+
+    /**
+     * Sum of the losses of scores and the penalty of the weights of parameters, the cost times
+     * N. The derivatives of the losses are written to gradients.
+     */
+    template <typename TCostFunction>
+    static double evalObjective(const Problem &problem, const double *scores,
+                                const double *parameters, const double l2, const double l1,
+                                double *losses, double *gradients) {
+        TCostFunction::loss(scores, problem.labels.data(), losses, gradients,
+                            problem.numExamples);
+
+        double objective = std::accumulate(losses, losses + problem.numExamples, 0.0);
+        for (size_t j = 0; j < problem.numFeatures; j++)
+            objective += 0.5 * l2 * parameters[j] * parameters[j] + l1 * std::fabs(parameters[j]);
+        return objective;
+    }
+
+    /**
+     * |x_j . g| for every feature j, where g are the derivatives of the losses at parameters:
+     * the L1 factor above which a zero weight j is optimal.
+     */
+    template <typename TCostFunction, typename TArguments>
+    static std::vector<double> lossCorrelations(const Problem &problem,
+                                                const TArguments &parameters) {
+        AlignedVector<double> scores(problem.numExamples), losses(problem.numExamples),
+            gradients(problem.numExamples);
+        computeScores(problem, parameters.data(), scores.data());
+        TCostFunction::loss(scores.data(), problem.labels.data(), losses.data(), gradients.data(),
+                            problem.numExamples);
+
+        std::vector<double> correlations(problem.numFeatures);
+        for (size_t j = 0; j < problem.numFeatures; j++)
+            correlations[j] =
+                std::fabs(simd::dot(problem.column(j), gradients.data(), problem.numExamples));
+        return correlations;
+    }
+
+    /**
+     * Parameters of the model with zero weights and the optimal bias.
+     */
+    template <typename TCostFunction>
+    typename TCostFunction::argument_type interceptOnly(const Problem &problem,
+                                                        const TCostFunction &costFunction) const {
+        using argument_type = typename TCostFunction::argument_type;
+        return solve<TCostFunction>(problem, costFunction.regularizationFactor(), 0.0,
+                                    zeros<argument_type>(problem.numFeatures + 1), {})
+            .optimalArguments;
+    }
+
+    /**
+     * Minimize the cost over the weights of coordinates and the bias, starting from parameters.
+     * The other weights keep their values.
+     */
+    template <typename TCostFunction, typename TArguments>
+    Result<TArguments> solve(const Problem &problem, const double l2, const double l1,
+                             TArguments parameters,
+                             const std::vector<size_t> &coordinates) const {
+        const size_t n = problem.numExamples, numFeatures = problem.numFeatures;
+        const double threshold = m_hyperParameters.tolerance * static_cast<double>(n);
+        double *w = parameters.data();
+
+        AlignedVector<double> scores(n), losses(n), gradients(n), curvatures(n), residuals(n),
+            direction(n), trialScores(n);
+        std::vector<double> scales(numFeatures);
+        std::vector<size_t> active;
+
+        Result<TArguments> result{parameters, 0.0};
+        result.stopReason = StopReason::MaxIterations;
+
+        computeScores(problem, w, scores.data());
+        double objective = evalObjective<TCostFunction>(problem, scores.data(), w, l2, l1,
+                                                        losses.data(), gradients.data());
+        result.numFunctionEvaluations = result.numGradientEvaluations = 1;
+
+        // Coordinate minimization of the penalized quadratic approximation, with curvatures
+        // as example weights and residuals the remaining change of the scores.
+        double sumOfCurvatures = 0.0;
+        const auto sweep = [&](const std::vector<size_t> &sweepCoordinates) {
+            double change = 0.0;
+            for (const size_t j : sweepCoordinates) {
+                const double scale = scales[j] + l2;
+                if (scale == 0.0)
+                    continue;
+
+                const double *x = problem.column(j);
+                const double correlation =
+                    simd::weightedDot(x, residuals.data(), curvatures.data(), n) +
+                    scales[j] * w[j];
+                const double delta = softThreshold(correlation, l1) / scale - w[j];
+                if (delta == 0.0)
+                    continue;
+
+                simd::axpy(-delta, x, residuals.data(), n);
+                w[j] += delta;
+                change = std::max(change, scale * delta * delta);
+            }
+
+            const double delta =
+                simd::dot(curvatures.data(), residuals.data(), n) / sumOfCurvatures;
+            simd::add(residuals.data(), -delta, residuals.data(), n);
+            w[numFeatures] += delta;
+            return std::max(change, sumOfCurvatures * delta * delta);
+        };
+
+        for (size_t iteration = 0; iteration < m_hyperParameters.maxIterations; iteration++) {
+            TCostFunction::curvature(scores.data(), curvatures.data(), n);
+            for (size_t i = 0; i < n; i++) {
+                curvatures[i] = std::max(curvatures[i], MinCurvature);
+                residuals[i] = -gradients[i] / curvatures[i];
+            }
+            sumOfCurvatures = std::accumulate(curvatures.begin(), curvatures.end(), 0.0);
+            for (const size_t j : coordinates)
+                scales[j] = simd::weightedDot(problem.column(j), problem.column(j),
+                                              curvatures.data(), n);
+            std::copy(residuals.begin(), residuals.end(), direction.begin());
+            const TArguments previous = parameters;
+
+            size_t numSweeps = 0;
+            double firstChange = 0.0;
+            for (;;) {
+                const double change = sweep(coordinates);
+                if (numSweeps++ == 0)
+                    firstChange = change;
+                if (change <= threshold || numSweeps >= m_hyperParameters.maxSweeps)
+                    break;
+
+                active.clear();
+                for (const size_t j : coordinates)
+                    if (w[j] != 0.0)
+                        active.push_back(j);
+                while (numSweeps < m_hyperParameters.maxSweeps) {
+                    numSweeps++;
+                    if (sweep(active) <= threshold)
+                        break;
+                }
+            }
+            result.numIterations += numSweeps;
+
+            if (firstChange <= threshold) {
+                parameters = previous;
+                result.stopReason = StopReason::Converged;
+                break;
+            }
+
+            // Step of the scores, the total change of the residuals.
+            simd::sub(direction.data(), residuals.data(), direction.data(), n);
+
+            const TArguments step = parameters;
+            double stepSize = 1.0, trialObjective = objective;
+            size_t numSteps = 0;
+            for (; numSteps < MaxLineSearchSteps; numSteps++, stepSize *= 0.5) {
+                for (size_t j = 0; j <= numFeatures; j++)
+                    w[j] = previous[j] + stepSize * (step[j] - previous[j]);
+                std::copy(scores.begin(), scores.end(), trialScores.begin());
+                simd::axpy(stepSize, direction.data(), trialScores.data(), n);
+
+                trialObjective = evalObjective<TCostFunction>(problem, trialScores.data(), w, l2,
+                                                              l1, losses.data(), gradients.data());
+                result.numFunctionEvaluations++;
+                result.numGradientEvaluations++;
+                if (trialObjective <= objective + 1E-12 * std::fabs(objective))
+                    break;
+            }
+
+            if (numSteps == MaxLineSearchSteps) {
+                parameters = previous;
+                result.stopReason = StopReason::LineSearchFailed;
+                break;
+            }
+
+            std::swap(scores, trialScores);
+            objective = trialObjective;
+        }
+
+        result.optimalArguments = parameters;
+        result.optimalValue = objective / static_cast<double>(n);
+        return result;
+    }
+
+    HyperParameters m_hyperParameters;
+};
+} // namespace ml
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <melon/FeatureStatistics.h>
+#include <melon/Random.h>
+#include <melon/ThreadPool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Validation scores of one candidate configuration, a regularization factor and the index of
+ * an optimizer among the candidates. The score of a fold is the unregularized mean loss of the
+ * model fitted on the other folds over the examples of the fold; lower is better.
+ */
+struct CrossValidationScore {
+    double regularizationFactor;
+    size_t optimizerIndex;
+    std::vector<double> foldScores;
+
+    double mean() const {
+        return std::accumulate(foldScores.begin(), foldScores.end(), 0.0) /
+               static_cast<double>(foldScores.size());
+    }
+};
+
+/**
+ * Scores of every candidate configuration and the wall time of the whole search.
+ */
+struct CrossValidationReport {
+    std::vector<CrossValidationScore> scores;
+    double wallSeconds = 0.0;
+
+    /**
+     * Candidate with the lowest mean score.
+     */
+    const CrossValidationScore &best() const {
+        assert(!scores.empty());
+        return *std::min_element(scores.begin(), scores.end(),
+                                 [](const CrossValidationScore &a, const CrossValidationScore &b) {
+                                     return a.mean() < b.mean();
+                                 });
+    }
+};
+
+/**
+ * k-fold cross-validation of a regression over a grid of regularization factors and
+ * optimizers. All folds share the caller's dataset: normalization statistics are computed once
+ * over all examples and applied lazily, and every fold selects its examples by index instead of
+ * copying them. Each pair of fold and optimizer is fitted as a separate task on the thread
+ * pool; within a task the regularization factors are visited from largest to smallest, each
+ * fit starting from the optimum of the previous one.
+ */
+template <typename TRegression> class CrossValidation {
+  public:
+    using regression_type = TRegression;
+    using cost_function_type = typename regression_type::cost_function_type;
+    using dataset_view_type = typename regression_type::dataset_view_type;
+    using parameters_type = typename regression_type::parameters_type;
+
+    /**
+     * Cross-validation of the cost function of regression, which must outlive this object.
+     */
+    explicit CrossValidation(regression_type &regression, const size_t numFolds = 5)
+        : m_regression(&regression), m_numFolds(std::max<size_t>(2, numFolds)) {}
+
+    /**
+     * Fit folds and candidates in parallel on threadPool, which may be shared.
+     */
+    CrossValidation &withThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+        return *this;
+    }
+
+    CrossValidation &withNumThreads(const size_t numThreads) {
+        return withThreadPool(numThreads > 1 ? std::make_shared<ThreadPool>(numThreads) : nullptr);
+    }
+
+    /**
+     * Seed of the random assignment of examples to folds and of the initial parameters. Every
+     * pair of fold and optimizer draws its initial parameters from its own stream, so scores do
+     * not depend on the number of threads.
+     */
+    CrossValidation &withSeed(const uint64_t seed) {
+        m_seed = seed;
+        return *this;
+    }
+
+    /**
+     * Scores of every combination of regularization factor and optimizer, any type providing
+     * optimize(costFunction, initialParameters). Scores are listed optimizer by optimizer, with
+     * regularization factors in decreasing order. dataset must hold at least numFolds examples.
+     */
+    template <typename TOptimizer>
+    CrossValidationReport run(const dataset_view_type &dataset,
+                              std::vector<double> regularizationFactors,
+                              const std::vector<TOptimizer> &optimizers) const {
+        const auto start = std::chrono::steady_clock::now();
+        assert(dataset.size() >= m_numFolds);
+
+        std::sort(regularizationFactors.begin(), regularizationFactors.end(),
+                  std::greater<double>());
+        const size_t numFactors = regularizationFactors.size();
+
+        const auto statistics = m_regression->featureStatistics(dataset, m_threadPool.get());
+        cost_function_type prototype = m_regression->costFunction(dataset);
+        prototype.setFeatureScaling(statistics.mean(), statistics.scale());
+        const size_t numParameters =
+            m_regression->numParameters(m_regression->numModelFeatures(dataset.numFeatures()));
+
+        std::vector<std::shared_ptr<const std::vector<size_t>>> training, validation;
+        splitFolds(dataset.size(), training, validation);
+
+        CrossValidationReport report;
+        for (size_t o = 0; o < optimizers.size(); o++)
+            for (const double regularizationFactor : regularizationFactors)
+                report.scores.push_back(
+                    {regularizationFactor, o, std::vector<double>(m_numFolds, 0.0)});
+
+        const auto fitPath = [&](const size_t task) {
+            const size_t fold = task % m_numFolds, o = task / m_numFolds;
+
+            cost_function_type trainingCost = prototype;
+            trainingCost.selectExamples(training[fold]);
+            cost_function_type validationCost = prototype;
+            validationCost.selectExamples(validation[fold]);
+            validationCost.setRegularizationFactor(0.0);
+            validationCost.setL1RegularizationFactor(0.0);
+
+            auto parameters =
+                Random(m_seed, task + 1).uniform<parameters_type>(numParameters, -0.5, 0.5);
+            for (size_t f = 0; f < numFactors; f++) {
+                trainingCost.setRegularizationFactor(regularizationFactors[f]);
+                parameters = optimizers[o].optimize(trainingCost, parameters).optimalArguments;
+                report.scores[o * numFactors + f].foldScores[fold] =
+                    validationCost.eval(parameters);
+            }
+        };
+
+        const size_t numTasks = m_numFolds * optimizers.size();
+        if (m_threadPool) {
+            m_threadPool->parallelFor(numTasks, fitPath);
+        } else {
+            for (size_t task = 0; task < numTasks; task++)
+                fitPath(task);
+        }
+
+        const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        report.wallSeconds = elapsed.count();
+        return report;
+    }
+
+    template <typename TOptimizer>
+    CrossValidationReport run(const dataset_view_type &dataset,
+                              std::vector<double> regularizationFactors,
+                              const TOptimizer &optimizer) const {
+        return run(dataset, std::move(regularizationFactors), std::vector<TOptimizer>{optimizer});
+    }
+
+  private:
+    /**
+     * Shuffle the examples and split them into numFolds folds of almost equal size. Indices are
+     * sorted within every fold and training set, so that gathered rows are read in order.
+     */
+    void splitFolds(const size_t size,
+                    std::vector<std::shared_ptr<const std::vector<size_t>>> &training,
+                    std::vector<std::shared_ptr<const std::vector<size_t>>> &validation) const {
+        std::vector<size_t> order(size);
+        std::iota(order.begin(), order.end(), 0);
+        Random(m_seed).shuffle(order.begin(), order.end());
+
+        for (size_t fold = 0; fold < m_numFolds; fold++) {
+            const size_t begin = fold * size / m_numFolds, end = (fold + 1) * size / m_numFolds;
+
+            std::vector<size_t> held(order.begin() + begin, order.begin() + end);
+            std::vector<size_t> rest(order.begin(), order.begin() + begin);
+            rest.insert(rest.end(), order.begin() + end, order.end());
+            std::sort(held.begin(), held.end());
+            std::sort(rest.begin(), rest.end());
+
+            validation.push_back(std::make_shared<const std::vector<size_t>>(std::move(held)));
+            training.push_back(std::make_shared<const std::vector<size_t>>(std::move(rest)));
+        }
+    }
+
+    regression_type *m_regression;
+    size_t m_numFolds;
+    uint64_t m_seed = Random::DefaultSeed;
+    std::shared_ptr<ThreadPool> m_threadPool;
+};
+} // namespace ml
@@ -0,0 +1,281 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace ml {
+
+/**
+ * Non-owning view over a contiguous block of rows of a dataset: a row-major feature matrix
+ * with a fixed stride and a separate label array, both stored as TScalar. Float storage halves
+ * the memory traffic of the training loops, which still accumulate in double.
+ */
+template <size_t dim, typename TScalar = double> class DatasetView {
+  public:
+    static constexpr size_t ArgumentDim = dim;
+
+    using scalar_type = TScalar;
+
+    DatasetView() = default;
+
+    /**
+     * numFeatures may only differ from dim for Dynamic views.
+     */
+    DatasetView(const TScalar *features, const TScalar *labels, const size_t size,
+                const size_t stride, const size_t numFeatures = dim)
+        : m_features(features), m_labels(labels), m_size(size), m_stride(stride),
+          m_numFeatures(numFeatures) {
+        assert(dim == Dynamic || numFeatures == dim);
+    }
+
+    size_t size() const { return m_size; }
+
+    size_t numFeatures() const { return m_numFeatures; }
+
+    bool empty() const { return m_size == 0; }
+
+    size_t stride() const { return m_stride; }
+
+    const TScalar *row(const size_t i) const { return m_features + i * m_stride; }
+
+    double label(const size_t i) const { return m_labels[i]; }
+
+    const TScalar *features() const { return m_features; }
+
+    const TScalar *labels() const { return m_labels; }
+
+    /**
+     * View over rows [begin, end).
+     */
+    DatasetView slice(const size_t begin, const size_t end) const {
+        assert(begin <= end && end <= m_size);
+        return {row(begin), m_labels + begin, end - begin, m_stride, m_numFeatures};
+    }
+
+  private:
+    const TScalar *m_features{nullptr};
+    const TScalar *m_labels{nullptr};
+    size_t m_size{0};
+    size_t m_stride{0};
+    size_t m_numFeatures{dim == Dynamic ? 0 : dim};
+};
+
+/**
+ * Column-major copy of the features of a dataset. Each column is cache line aligned.
+ */
+template <size_t dim> class FeatureColumns {
+  public:
+    template <typename TScalar>
+    explicit FeatureColumns(const DatasetView<dim, TScalar> &dataset)
+        : m_size(dataset.size()), m_stride(paddedSize<double>(dataset.size())),
+          m_features(dataset.numFeatures() * m_stride, 0.0) {
+        for (size_t i = 0; i < m_size; i++) {
+            const TScalar *x = dataset.row(i);
+            for (size_t j = 0; j < dataset.numFeatures(); j++)
+                m_features[j * m_stride + i] = x[j];
+        }
+    }
+
+    size_t size() const { return m_size; }
+
+    const double *column(const size_t j) const { return m_features.data() + j * m_stride; }
+
+  private:
+    size_t m_size;
+    size_t m_stride;
+    AlignedVector<double> m_features;
+};
+
+/**
+ * Structure-of-arrays training set. Features are stored in a single row-major matrix whose rows
+ * are padded to a whole number of cache lines, labels in a separate array. Examples converted
+ * from doubles are rounded to TScalar.
+ */
+template <size_t dim, typename TScalar = double> class Dataset {
+  public:
+    static constexpr size_t ArgumentDim = dim;
+    static constexpr size_t Stride = paddedSize<TScalar>(dim);
+
+    using scalar_type = TScalar;
+    using argument_type = Vector<dim>;
+    using view_type = DatasetView<dim, TScalar>;
+
+    Dataset() = default;
+
+    explicit Dataset(const size_t size) { resize(size); }
+
+    /**
+     * Same as Dataset(size), for code generic over fixed and Dynamic datasets.
+     */
+    Dataset(const size_t size, [[maybe_unused]] const size_t numFeatures) : Dataset(size) {
+        assert(numFeatures == dim);
+    }
+
+    /**
+     * Adapter from the array-of-structures TrainingSet.
+     */
+    explicit Dataset(const TrainingSet<dim> &trainingSet) {
+        reserve(trainingSet.size());
+        for (const auto &[x, y] : trainingSet)
+            emplace_back(x, y);
+    }
+
+    void reserve(const size_t size) {
+        m_features.reserve(size * Stride);
+        m_labels.reserve(size);
+    }
+
+    void resize(const size_t size) {
+        m_features.resize(size * Stride, TScalar(0));
+        m_labels.resize(size, TScalar(0));
+    }
+
+    /**
+     * Replace the examples with those of dataset, reusing the storage of this dataset.
+     */
+    template <typename TOtherScalar> void assign(const DatasetView<dim, TOtherScalar> &dataset) {
+        resize(dataset.size());
+        for (size_t i = 0; i < dataset.size(); i++) {
+            std::copy(dataset.row(i), dataset.row(i) + dim, row(i));
+            m_labels[i] = static_cast<TScalar>(dataset.label(i));
+        }
+    }
+
+    void emplace_back(const argument_type &x, const double y) {
+        m_features.insert(m_features.end(), x.begin(), x.end());
+        m_features.resize(m_features.size() + Stride - dim, TScalar(0));
+        m_labels.push_back(static_cast<TScalar>(y));
+    }
+
+    size_t size() const { return m_labels.size(); }
+
+    bool empty() const { return m_labels.empty(); }
+
+    static constexpr size_t numFeatures() { return dim; }
+
+    static constexpr size_t stride() { return Stride; }
+
+    TScalar *row(const size_t i) { return m_features.data() + i * Stride; }
+
+    const TScalar *row(const size_t i) const { return m_features.data() + i * Stride; }
+
+    TScalar &label(const size_t i) { return m_labels[i]; }
+
+    double label(const size_t i) const { return m_labels[i]; }
+
+    const TScalar *features() const { return m_features.data(); }
+
+    const TScalar *labels() const { return m_labels.data(); }
+
+    view_type view() const { return {features(), labels(), size(), Stride}; }
+
+    operator view_type() const { return view(); }
+
+    /**
+     * Column-major copy of the feature matrix.
+     */
+    FeatureColumns<dim> columnMajor() const { return FeatureColumns<dim>(view()); }
+
+  private:
+    AlignedVector<TScalar> m_features;
+    AlignedVector<TScalar> m_labels;
+};
+
+/**
+ * Dataset with a number of features chosen at runtime. Rows are padded to a whole number of
+ * cache lines like those of the fixed dimension Dataset.
+ */
+template <typename TScalar> class Dataset<Dynamic, TScalar> {
+  public:
+    static constexpr size_t ArgumentDim = Dynamic;
+
+    using scalar_type = TScalar;
+    using argument_type = DynamicVector;
+    using view_type = DatasetView<Dynamic, TScalar>;
+
+    Dataset() = default;
+
+    Dataset(const size_t size, const size_t numFeatures)
+        : m_numFeatures(numFeatures), m_stride(paddedSize<TScalar>(numFeatures)) {
+        resize(size);
+    }
+
+    /**
+     * Adapter from the array-of-structures TrainingSet, whose examples must all have the same
+     * number of features.
+     */
+    explicit Dataset(const TrainingSet<Dynamic> &trainingSet)
+        : Dataset(0, trainingSet.empty() ? 0 : trainingSet.front().first.size()) {
+        reserve(trainingSet.size());
+        for (const auto &[x, y] : trainingSet)
+            emplace_back(x, y);
+    }
+
+    void reserve(const size_t size) {
+        m_features.reserve(size * m_stride);
+        m_labels.reserve(size);
+    }
+
+    void resize(const size_t size) {
+        m_features.resize(size * m_stride, TScalar(0));
+        m_labels.resize(size, TScalar(0));
+    }
+
+    /**
+     * Replace the examples with those of dataset, reusing the storage of this dataset.
+     */
+    template <typename TOtherScalar>
+    void assign(const DatasetView<Dynamic, TOtherScalar> &dataset) {
+        m_numFeatures = dataset.numFeatures();
+        m_stride = paddedSize<TScalar>(m_numFeatures);
+        m_features.assign(dataset.size() * m_stride, TScalar(0));
+        m_labels.resize(dataset.size());
+        for (size_t i = 0; i < dataset.size(); i++) {
+            std::copy(dataset.row(i), dataset.row(i) + m_numFeatures, row(i));
+            m_labels[i] = static_cast<TScalar>(dataset.label(i));
+        }
+    }
+
+    void emplace_back(const argument_type &x, const double y) {
+        assert(x.size() == m_numFeatures);
+        m_features.insert(m_features.end(), x.begin(), x.end());
+        m_features.resize(m_features.size() + m_stride - m_numFeatures, TScalar(0));
+        m_labels.push_back(static_cast<TScalar>(y));
+    }
+
+    size_t size() const { return m_labels.size(); }
+
+    bool empty() const { return m_labels.empty(); }
+
+    size_t numFeatures() const { return m_numFeatures; }
+
+    size_t stride() const { return m_stride; }
+
+    TScalar *row(const size_t i) { return m_features.data() + i * m_stride; }
+
+    const TScalar *row(const size_t i) const { return m_features.data() + i * m_stride; }
+
+    TScalar &label(const size_t i) { return m_labels[i]; }
+
+    double label(const size_t i) const { return m_labels[i]; }
+
+    const TScalar *features() const { return m_features.data(); }
+
+    const TScalar *labels() const { return m_labels.data(); }
+
+    view_type view() const { return {features(), labels(), size(), m_stride, m_numFeatures}; }
+
+    operator view_type() const { return view(); }
+
+    FeatureColumns<Dynamic> columnMajor() const { return FeatureColumns<Dynamic>(view()); }
+
+  private:
+    size_t m_numFeatures{0};
+    size_t m_stride{0};
+    AlignedVector<TScalar> m_features;
+    AlignedVector<TScalar> m_labels;
+};
+} // namespace ml
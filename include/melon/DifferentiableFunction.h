@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace ml {
+
+/**
+ * Function value and gradient evaluated at the same arguments.
+ */
+template <typename TGradient> struct ValueAndGradient {
+    double value;
+    TGradient gradient;
+};
+
+/**
+ * Why an optimization stopped: its convergence test passed, it ran out of iterations, its line
+ * search found no decrease, an observer asked it to stop, or the linear system of a direct
+ * solver was singular.
+ */
+enum class StopReason { Converged, MaxIterations, LineSearchFailed, Observer, Singular };
+
+/**
+ * Outcome of an optimization. A fused valueAndGradient() call counts as one function and one
+ * gradient evaluation.
+ */
+template <typename TArguments> struct OptimizationResult {
+    TArguments optimalArguments;
+    double optimalValue;
+    size_t numIterations = 0;
+    size_t numFunctionEvaluations = 0;
+    size_t numGradientEvaluations = 0;
+    StopReason stopReason = StopReason::Converged;
+};
+
+/**
+ * Detects differentiable functions that provide a fused valueAndGradient() entry point.
+ */
+template <typename TFunction, typename = void> struct HasValueAndGradient : std::false_type {};
+
+template <typename TFunction>
+struct HasValueAndGradient<
+    TFunction, std::void_t<decltype(std::declval<const TFunction &>().valueAndGradient(
+                   std::declval<const typename TFunction::argument_type &>()))>>
+    : std::true_type {};
+
+/**
+ * Detects twice differentiable functions that provide hessian().
+ */
+template <typename TFunction, typename = void> struct HasHessian : std::false_type {};
+
+template <typename TFunction>
+struct HasHessian<TFunction, std::void_t<decltype(std::declval<const TFunction &>().hessian(
+                                 std::declval<const typename TFunction::argument_type &>()))>>
+    : std::true_type {};
+
+/**
+ * Detects sums over examples that read their examples in chunks of chunkSize().
+ */
+template <typename TFunction, typename = void> struct HasChunkSize : std::false_type {};
+
+template <typename TFunction>
+struct HasChunkSize<TFunction, std::void_t<decltype(std::declval<const TFunction &>().chunkSize())>>
+    : std::true_type {};
+
+/**
+ * Detects sums over sparse examples that perform a plain stochastic gradient step in time
+ * linear in the nonzeros of the batch, on weights stored as weightScale * arguments.
+ */
+template <typename TFunction, typename = void> struct HasSparseStep : std::false_type {};
+
+template <typename TFunction>
+struct HasSparseStep<
+    TFunction, std::void_t<decltype(std::declval<const TFunction &>().sparseStep(
+                   std::declval<typename TFunction::argument_type &>(), std::declval<double &>(),
+                   std::declval<const size_t *>(), size_t(0), 0.0))>> : std::true_type {};
+
+/**
+ * Evaluate value and gradient of function, in a single pass when the function supports it.
+ */
+template <typename TFunction>
+ValueAndGradient<typename TFunction::gradient_type>
+evalWithGradient(const TFunction &function, const typename TFunction::argument_type &x) {
+    if constexpr (HasValueAndGradient<TFunction>::value)
+        return function.valueAndGradient(x);
+    else
+        return {function.eval(x), function.gradient(x)};
+}
+} // namespace ml
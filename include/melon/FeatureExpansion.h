@@ -0,0 +1,174 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/Dataset.h>
+#include <melon/FeatureStatistics.h>
+#include <melon/ThreadPool.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cassert>
+#include <map>
+#include <utility>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Nonlinear features computed from the raw features of an example as it is read: powers of
+ * every feature, pairwise interactions and full polynomials of a given degree. The expanded
+ * features are the raw features followed by the declared monomials, each of which is the
+ * product of two earlier expanded features, a monomial of one degree less and a raw feature,
+ * so every term takes a single multiplication and shares the subproducts of lower degree.
+ * Subproducts that were not declared are added as features of their own.
+ *
+ * Cost functions and regressions on runtime-dimension features apply the expansion to blocks
+ * of examples as they read them, so the expanded dataset is never materialized.
+ */
+class FeatureExpansion {
+  public:
+    /**
+     * Expansion of numInputs raw features, which are passed through unchanged.
+     */
+    explicit FeatureExpansion(const size_t numInputs) : m_numInputs(numInputs) {}
+
+    /**
+     * Add x_j^2, ..., x_j^degree for every raw feature j.
+     */
+    FeatureExpansion &withPowers(const size_t degree) {
+        for (size_t j = 0; j < m_numInputs; j++)
+            for (size_t d = 2; d <= degree; d++)
+                addMonomial(std::vector<size_t>(d, j));
+        return *this;
+    }
+
+    /**
+     * Add x_i * x_j for every pair of distinct raw features i < j.
+     */
+    FeatureExpansion &withInteractions() {
+        for (size_t i = 0; i < m_numInputs; i++)
+            for (size_t j = i + 1; j < m_numInputs; j++)
+                addMonomial({i, j});
+        return *this;
+    }
+
+    /**
+     * Add x_i * x_j.
+     */
+    FeatureExpansion &withInteraction(const size_t i, const size_t j) {
+        assert(i < m_numInputs && j < m_numInputs);
+        addMonomial({std::min(i, j), std::max(i, j)});
+        return *this;
+    }
+
+    /**
+     * Add every monomial of the raw features of degree 2 to degree, all powers and products of
+     * any number of features included.
+     */
+    FeatureExpansion &withPolynomialDegree(const size_t degree) {
+        std::vector<size_t> factors;
+        for (size_t d = 2; d <= degree; d++) {
+            factors.assign(d, 0);
+            addMonomials(factors, 0, 0);
+        }
+        return *this;
+    }
+
+    size_t numInputs() const { return m_numInputs; }
+
+    /**
+     * Number of expanded features, raw features included.
+     */
+    size_t numOutputs() const { return m_numInputs + m_products.size(); }
+
+    /**
+     * Indices of the raw features whose product is expanded feature t, in increasing order.
+     */
+    std::vector<size_t> factors(const size_t t) const {
+        if (t < m_numInputs)
+            return {t};
+
+        auto factors = this->factors(m_products[t - m_numInputs].first);
+        factors.push_back(m_products[t - m_numInputs].second);
+        return factors;
+    }
+
+    /**
+     * Write the numOutputs() expanded features of the numInputs() raw features x to out.
+     */
+    template <typename TScalar> void expand(const TScalar *x, double *out) const {
+        for (size_t j = 0; j < m_numInputs; j++)
+            out[j] = static_cast<double>(x[j]);
+
+        double *terms = out + m_numInputs;
+        for (size_t t = 0; t < m_products.size(); t++)
+            terms[t] = out[m_products[t].first] * out[m_products[t].second];
+    }
+
+  private:
+    /**
+     * Add the monomials of factors.size() factors whose factors from position k on are not
+     * lower than first.
+     */
+    void addMonomials(std::vector<size_t> &factors, const size_t k, const size_t first) {
+        if (k == factors.size()) {
+            addMonomial(factors);
+            return;
+        }
+
+        for (size_t j = first; j < m_numInputs; j++) {
+            factors[k] = j;
+            addMonomials(factors, k + 1, j);
+        }
+    }
+
+    /**
+     * Index of the expanded feature that is the product of the raw features factors, in
+     * increasing order, added with the monomials it is built from unless it exists.
+     */
+    size_t addMonomial(const std::vector<size_t> &factors) {
+        assert(!factors.empty() && std::is_sorted(factors.begin(), factors.end()));
+        if (factors.size() == 1)
+            return factors[0];
+
+        const auto found = m_monomials.find(factors);
+        if (found != m_monomials.end())
+            return found->second;
+
+        const size_t prefix = addMonomial(std::vector<size_t>(factors.begin(), factors.end() - 1));
+        m_products.emplace_back(prefix, factors.back());
+        return m_monomials[factors] = numOutputs() - 1;
+    }
+
+    size_t m_numInputs;
+    std::vector<std::pair<size_t, size_t>> m_products;
+    std::map<std::vector<size_t>, size_t> m_monomials;
+};
+
+/**
+ * Statistics of the expanded features of dataset, computed in a single pass that expands one
+ * example at a time, with shards accumulated in parallel on threadPool when it is not null.
+ */
+template <size_t dim, typename TScalar>
+FeatureStatistics<Dynamic> computeFeatureStatistics(const DatasetView<dim, TScalar> &dataset,
+                                                    const FeatureExpansion &expansion,
+                                                    ThreadPool *threadPool = nullptr) {
+    constexpr size_t MinShardSize = 4096;
+    assert(dataset.numFeatures() == expansion.numInputs());
+
+    return shardedReduce(
+        threadPool, dataset.size(), MinShardSize,
+        [&](const size_t begin, const size_t end) {
+            FeatureStatistics<Dynamic> partial(expansion.numOutputs());
+            AlignedVector<double> expanded(expansion.numOutputs());
+            for (size_t i = begin; i < end; i++) {
+                expansion.expand(dataset.row(i), expanded.data());
+                partial.add(expanded.data());
+            }
+            return partial;
+        },
+        [](FeatureStatistics<Dynamic> &result, const FeatureStatistics<Dynamic> &partial) {
+            result.merge(partial);
+        });
+}
+} // namespace ml
@@ -0,0 +1,120 @@
+#pragma once
+
+#include <melon/Dataset.h>
+#include <melon/ThreadPool.h>
+#include <melon/Types.h>
+
+#include <cassert>
+#include <cmath>
+
+namespace ml {
+
+/**
+ * Per-feature mean and variance accumulated in a single pass with Welford's update. Statistics
+ * of disjoint sets of examples are combined with merge(), so shards can be accumulated in
+ * parallel.
+ */
+template <size_t dim> class FeatureStatistics {
+  public:
+    using argument_type = Vector<dim>;
+
+    explicit FeatureStatistics(const size_t numFeatures = dim == Dynamic ? 0 : dim)
+        : m_mean(zeros<argument_type>(numFeatures)), m_m2(zeros<argument_type>(numFeatures)) {}
+
+    /**
+     * Statistics of count examples with the given per-feature mean and population variance.
+     */
+    FeatureStatistics(const size_t count, const argument_type &mean, const argument_type &variance)
+        : m_count(count), m_mean(mean), m_m2(variance * static_cast<double>(count)) {}
+
+    size_t count() const { return m_count; }
+
+    size_t numFeatures() const { return m_mean.size(); }
+
+    /**
+     * Add the example with numFeatures() features x.
+     */
+    template <typename TScalar> void add(const TScalar *x) {
+        m_count++;
+        const double weight = 1.0 / static_cast<double>(m_count);
+        for (size_t j = 0; j < numFeatures(); j++) {
+            const double delta = x[j] - m_mean[j];
+            m_mean[j] += delta * weight;
+            m_m2[j] += delta * (x[j] - m_mean[j]);
+        }
+    }
+
+    /**
+     * Add the examples of other (Chan et al. pairwise update).
+     */
+    void merge(const FeatureStatistics &other) {
+        if (other.m_count == 0)
+            return;
+        if (m_count == 0) {
+            *this = other;
+            return;
+        }
+        assert(numFeatures() == other.numFeatures());
+
+        const double n = static_cast<double>(m_count), m = static_cast<double>(other.m_count);
+        const double total = n + m;
+        for (size_t j = 0; j < numFeatures(); j++) {
+            const double delta = other.m_mean[j] - m_mean[j];
+            m_mean[j] += delta * (m / total);
+            m_m2[j] += other.m_m2[j] + delta * delta * (n * m / total);
+        }
+        m_count += other.m_count;
+    }
+
+    const argument_type &mean() const { return m_mean; }
+
+    /**
+     * Population variance of every feature.
+     */
+    argument_type variance() const {
+        return m_count == 0 ? m_m2 : m_m2 / static_cast<double>(m_count);
+    }
+
+    /**
+     * Population standard deviation of every feature.
+     */
+    argument_type sdev() const {
+        return ml::apply(variance(), [](const double x) { return std::sqrt(x); });
+    }
+
+    /**
+     * Divisors of feature normalization: the standard deviation of every feature, or 1 for
+     * constant features, which are only centered.
+     */
+    argument_type scale() const {
+        return ml::apply(sdev(), [](const double sdev) { return sdev > 0.0 ? sdev : 1.0; });
+    }
+
+  private:
+    size_t m_count{0};
+    argument_type m_mean;
+    argument_type m_m2;
+};
+
+/**
+ * Statistics of the features of dataset, with shards accumulated in parallel on threadPool
+ * when it is not null.
+ */
+template <size_t dim, typename TScalar>
+FeatureStatistics<dim> computeFeatureStatistics(const DatasetView<dim, TScalar> &dataset,
+                                                ThreadPool *threadPool = nullptr) {
+    constexpr size_t MinShardSize = 4096;
+
+    return shardedReduce(
+        threadPool, dataset.size(), MinShardSize,
+        [&](const size_t begin, const size_t end) {
+            FeatureStatistics<dim> partial(dataset.numFeatures());
+            for (size_t i = begin; i < end; i++)
+                partial.add(dataset.row(i));
+            return partial;
+        },
+        [](FeatureStatistics<dim> &result, const FeatureStatistics<dim> &partial) {
+            result.merge(partial);
+        });
+}
+} // namespace ml
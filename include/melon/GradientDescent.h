@@ -1,8 +1,11 @@
 #pragma once
 
+#include <melon/DifferentiableFunction.h>
+#include <melon/OptimizationObserver.h>
 #include <melon/Types.h>
 
 #include <cmath>
+#include <limits>
 
 namespace ml {
 
@@ -19,10 +22,7 @@ class GradientDescent {
         double reductionFactor = 0.8;     // (0, 1)
     };
 
-    template <typename TArguments> struct Result {
-        TArguments optimalArguments;
-        double optimalValue;
-    };
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
 
     GradientDescent &withHyperParameters(const HyperParameters hyperParameters) {
         m_hyperParameters = hyperParameters;
@@ -33,50 +33,108 @@ class GradientDescent {
     Result<typename TDifferentiableFunction::argument_type>
     optimize(const TDifferentiableFunction &function,
              const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        NullObserver observer;
+        return optimize(function, initialArguments, observer);
+    }
+
+    /**
+     * Optimize, reporting every iteration and evaluation to observer.
+     */
+    template <typename TDifferentiableFunction, typename TObserver>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments,
+             TObserver &observer) const {
         using argument_type = typename TDifferentiableFunction::argument_type;
+        const auto &observedFunction = observe(function, observer);
 
-        argument_type arguments = initialArguments;
+        Result<argument_type> result{initialArguments, observedFunction.eval(initialArguments)};
+        result.numFunctionEvaluations = 1;
         auto relativeError = std::numeric_limits<double>::max();
-        auto prevValue = function.eval(arguments);
-        size_t numIterations = 0;
 
         do {
-            const auto result = backtrackingLineSearch(function, arguments);
-            arguments = result.optimalArguments;
-            relativeError = (prevValue - result.optimalValue) / prevValue;
-            prevValue = result.optimalValue;
-            numIterations++;
-        } while (relativeError > m_hyperParameters.relativeErrorTolerance &&
-                 numIterations < m_hyperParameters.maxIter);
-
-        return {arguments, prevValue};
+            const auto [step, gradientNorm, stepSize] =
+                lineSearch(observedFunction, result.optimalArguments);
+            relativeError = (result.optimalValue - step.optimalValue) / result.optimalValue;
+            result.optimalArguments = step.optimalArguments;
+            result.optimalValue = step.optimalValue;
+            result.numFunctionEvaluations += step.numFunctionEvaluations;
+            result.numGradientEvaluations += step.numGradientEvaluations;
+            result.numIterations++;
+
+            // A step of 0 along a nonzero gradient means no step decreased the function.
+            if (stepSize == 0.0 && gradientNorm > 0.0)
+                result.stopReason = StopReason::LineSearchFailed;
+
+            if constexpr (TObserver::Enabled) {
+                if (!observer.onIteration({result.numIterations, result.optimalValue,
+                                           gradientNorm, stepSize,
+                                           step.numFunctionEvaluations - 1})) {
+                    result.stopReason = StopReason::Observer;
+                    return result;
+                }
+            }
+        } while (result.stopReason != StopReason::LineSearchFailed &&
+                 relativeError > m_hyperParameters.relativeErrorTolerance &&
+                 result.numIterations < m_hyperParameters.maxIter);
+
+        if (result.stopReason != StopReason::LineSearchFailed &&
+            relativeError > m_hyperParameters.relativeErrorTolerance)
+            result.stopReason = StopReason::MaxIterations;
+
+        return result;
     }
 
+    /**
+     * Armijo backtracking along the negative gradient. Value and gradient at the starting point
+     * are computed in a single pass when the function provides valueAndGradient().
+     */
     template <typename TDifferentiableFunction>
     Result<typename TDifferentiableFunction::argument_type>
     backtrackingLineSearch(const TDifferentiableFunction &function,
                            const typename TDifferentiableFunction::argument_type &arguments) const {
-        const auto gradient = function.gradient(arguments);
+        return lineSearch(function, arguments).result;
+    }
+
+  private:
+    template <typename TArguments> struct Step {
+        OptimizationResult<TArguments> result;
+        double gradientNorm; // at the starting point
+        double stepSize;     // 0 when no step decreased the function
+    };
+
+    template <typename TDifferentiableFunction>
+    Step<typename TDifferentiableFunction::argument_type>
+    lineSearch(const TDifferentiableFunction &function,
+               const typename TDifferentiableFunction::argument_type &arguments) const {
+        const auto [value, gradient] = evalWithGradient(function, arguments);
         const double localSlope = -sqLength(gradient);
         const double t = localSlope * m_hyperParameters.searchControlFactor;
-        auto candidateArguments = arguments;
-        auto candidateValue = function.eval(candidateArguments);
+        using argument_type = typename TDifferentiableFunction::argument_type;
+
+        Result<argument_type> result{arguments, value, 0, 1, 1};
         double difference = std::numeric_limits<double>::lowest();
         double learningRate = 2.0;
 
-        while (difference < learningRate * t) {
+        while (difference < -learningRate * t &&
+               learningRate > std::numeric_limits<double>::epsilon()) {
             learningRate *= m_hyperParameters.reductionFactor;
-            candidateArguments = arguments - learningRate * gradient;
+            result.optimalArguments = arguments - learningRate * gradient;
+            result.optimalValue = function.eval(result.optimalArguments);
+            result.numFunctionEvaluations++;
+            difference = value - result.optimalValue;
+        }
 
-            const double currValue = function.eval(candidateArguments);
-            difference = candidateValue - currValue;
-            candidateValue = currValue;
+        const double gradientNorm = std::sqrt(-localSlope);
+        if (difference < 0.0) {
+            result.optimalArguments = arguments;
+            result.optimalValue = value;
+            return {result, gradientNorm, 0.0};
         }
 
-        return {candidateArguments, candidateValue};
+        return {result, gradientNorm, learningRate * gradientNorm};
     }
 
-  private:
     HyperParameters m_hyperParameters;
 };
 } // namespace ml
\ No newline at end of file
@@ -0,0 +1,301 @@
+#pragma once
+
+#include <melon/DifferentiableFunction.h>
+#include <melon/OptimizationObserver.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Limited-memory BFGS quasi-Newton optimization with a strong Wolfe line search.
+ */
+class LBFGS {
+  public:
+    struct HyperParameters {
+        size_t historySize = 10;
+        size_t maxIter = 1000;
+        double gradientTolerance = 1E-10;      // stop when |gradient| falls below
+        double relativeErrorTolerance = 1E-12; // stop when decrease / max(|value|, 1) falls below
+        double sufficientDecrease = 1E-4;      // Armijo constant, (0, curvature)
+        double curvature = 0.9;                // strong Wolfe constant, (sufficientDecrease, 1)
+        size_t maxLineSearchEvaluations = 25;
+    };
+
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
+
+    LBFGS &withHyperParameters(const HyperParameters hyperParameters) {
+        m_hyperParameters = hyperParameters;
+        return *this;
+    }
+
+    template <typename TDifferentiableFunction>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        NullObserver observer;
+        return optimize(function, initialArguments, observer);
+    }
+
+    /**
+     * Optimize, reporting every iteration and evaluation to observer.
+     */
+    template <typename TDifferentiableFunction, typename TObserver>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments,
+             TObserver &observer) const {
+        using argument_type = typename TDifferentiableFunction::argument_type;
+        const auto &observedFunction = observe(function, observer);
+
+        Point<argument_type> current = evalAt(observedFunction, initialArguments, 0.0);
+
+        Result<argument_type> result{current.arguments, current.value, 0, 1, 1};
+        History<argument_type> history(std::max<size_t>(1, m_hyperParameters.historySize));
+        result.stopReason = StopReason::MaxIterations;
+
+        while (result.numIterations < m_hyperParameters.maxIter) {
+            const double gradientNorm = std::sqrt(sqLength(current.gradient));
+            if (gradientNorm <= m_hyperParameters.gradientTolerance) {
+                result.stopReason = StopReason::Converged;
+                break;
+            }
+
+            argument_type direction = history.apply(current.gradient);
+            double slope = dot(current.gradient, direction);
+            if (!(slope < 0.0)) {
+                history.clear();
+                direction = -1.0 * current.gradient;
+                slope = -sqLength(current.gradient);
+            }
+
+            const double initialStep =
+                result.numIterations == 0 ? std::min(1.0, 1.0 / std::sqrt(-slope)) : 1.0;
+            current.slope = slope;
+
+            size_t numEvaluations = 0;
+            const auto next =
+                lineSearch(observedFunction, current, direction, initialStep, numEvaluations);
+            result.numFunctionEvaluations += numEvaluations;
+            result.numGradientEvaluations += numEvaluations;
+            result.numIterations++;
+
+            if (!next.has_value()) {
+                result.stopReason = StopReason::LineSearchFailed;
+                if constexpr (TObserver::Enabled)
+                    observer.onIteration({result.numIterations, current.value, gradientNorm, 0.0,
+                                          numEvaluations});
+                break;
+            }
+
+            history.push(next->arguments - current.arguments, next->gradient - current.gradient);
+
+            const double decrease = current.value - next->value;
+            current = *next;
+            result.optimalArguments = current.arguments;
+            result.optimalValue = current.value;
+
+            if constexpr (TObserver::Enabled) {
+                const double stepSize = current.step * std::sqrt(sqLength(direction));
+                if (!observer.onIteration({result.numIterations, current.value, gradientNorm,
+                                           stepSize, numEvaluations})) {
+                    result.stopReason = StopReason::Observer;
+                    break;
+                }
+            }
+
+            if (decrease <= m_hyperParameters.relativeErrorTolerance *
+                                std::max(1.0, std::fabs(current.value))) {
+                result.stopReason = StopReason::Converged;
+                break;
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    template <typename TArguments> struct Point {
+        TArguments arguments;
+        double value;
+        TArguments gradient;
+        double step;  // distance along the search direction
+        double slope; // directional derivative along the search direction
+    };
+
+    template <typename TFunction, typename TArguments>
+    static Point<TArguments> evalAt(const TFunction &function, const TArguments &arguments,
+                                    const double step) {
+        auto evaluation = evalWithGradient(function, arguments);
+        return {arguments, evaluation.value, std::move(evaluation.gradient), step, 0.0};
+    }
+
+    /**
+     * Ring buffer of the most recent curvature pairs (s, y), applied with the two-loop
+     * recursion.
+     */
+    template <typename TArguments> class History {
+      public:
+        explicit History(const size_t capacity) : m_capacity(capacity) {}
+
+        void clear() {
+            m_s.clear();
+            m_y.clear();
+            m_rho.clear();
+            m_oldest = 0;
+        }
+
+        void push(const TArguments &s, const TArguments &y) {
+            const double sy = dot(s, y);
+            if (!(sy > 1E-12 * sqLength(y)))
+                return;
+
+            if (m_s.size() < m_capacity) {
+                m_s.push_back(s);
+                m_y.push_back(y);
+                m_rho.push_back(1.0 / sy);
+            } else {
+                m_s[m_oldest] = s;
+                m_y[m_oldest] = y;
+                m_rho[m_oldest] = 1.0 / sy;
+                m_oldest = (m_oldest + 1) % m_capacity;
+            }
+        }
+
+        /**
+         * Descent direction -H g for the inverse Hessian approximation H.
+         */
+        TArguments apply(const TArguments &gradient) const {
+            const size_t size = m_s.size();
+            std::vector<double> alpha(size);
+            TArguments q = gradient;
+
+            for (size_t k = 0; k < size; k++) {
+                const size_t i = index(size - 1 - k);
+                alpha[i] = m_rho[i] * dot(m_s[i], q);
+                q = q - alpha[i] * m_y[i];
+            }
+
+            if (size > 0) {
+                const size_t newest = index(size - 1);
+                q = q * (1.0 / (m_rho[newest] * sqLength(m_y[newest])));
+            }
+
+            for (size_t k = 0; k < size; k++) {
+                const size_t i = index(k);
+                const double beta = m_rho[i] * dot(m_y[i], q);
+                q = q + (alpha[i] - beta) * m_s[i];
+            }
+
+            return -1.0 * q;
+        }
+
+      private:
+        size_t index(const size_t age) const { return (m_oldest + age) % m_s.size(); }
+
+        size_t m_capacity;
+        size_t m_oldest{0};
+        std::vector<TArguments> m_s, m_y;
+        std::vector<double> m_rho;
+    };
+
+    /**
+     * Find a step satisfying the strong Wolfe conditions by bracketing followed by zooming with
+     * safeguarded cubic interpolation (Nocedal and Wright, algorithms 3.5 and 3.6). Returns no
+     * point when the evaluation budget runs out without sufficient decrease.
+     */
+    template <typename TFunction, typename TArguments>
+    std::optional<Point<TArguments>> lineSearch(const TFunction &function,
+                                                const Point<TArguments> &start,
+                                                const TArguments &direction, double step,
+                                                size_t &numEvaluations) const {
+        const double c1 = m_hyperParameters.sufficientDecrease;
+        const double c2 = m_hyperParameters.curvature;
+        const auto evalAlong = [&](const double step) {
+            auto point = evalAt(function, TArguments(start.arguments + step * direction), step);
+            point.slope = dot(point.gradient, direction);
+            numEvaluations++;
+            return point;
+        };
+        const auto sufficientDecrease = [&](const Point<TArguments> &point) {
+            return point.value <= start.value + c1 * point.step * start.slope;
+        };
+        const auto curvature = [&](const Point<TArguments> &point) {
+            return std::fabs(point.slope) <= -c2 * start.slope;
+        };
+
+        Point<TArguments> previous = start;
+        previous.step = 0.0;
+        std::optional<Point<TArguments>> lo, hi;
+
+        while (numEvaluations < m_hyperParameters.maxLineSearchEvaluations) {
+            const auto point = evalAlong(step);
+            if (!sufficientDecrease(point) ||
+                (previous.step > 0.0 && point.value >= previous.value)) {
+                lo = previous;
+                hi = point;
+                break;
+            }
+            if (curvature(point))
+                return point;
+            if (point.slope >= 0.0) {
+                lo = point;
+                hi = previous;
+                break;
+            }
+
+            previous = point;
+            step *= 2.0;
+        }
+
+        while (lo.has_value() && numEvaluations < m_hyperParameters.maxLineSearchEvaluations) {
+            const auto point = evalAlong(interpolate(*lo, *hi));
+            if (!sufficientDecrease(point) || point.value >= lo->value) {
+                hi = point;
+            } else {
+                if (curvature(point))
+                    return point;
+                if (point.slope * (hi->step - lo->step) >= 0.0)
+                    hi = lo;
+                lo = point;
+            }
+        }
+
+        if (lo.has_value() && lo->step > 0.0)
+            return lo;
+        if (previous.step > 0.0)
+            return previous;
+
+        return std::nullopt;
+    }
+
+    /**
+     * Minimizer of the cubic interpolating value and slope at lo and hi, kept away from the
+     * interval ends; bisection when the cubic has no minimizer there.
+     */
+    template <typename TArguments>
+    static double interpolate(const Point<TArguments> &lo, const Point<TArguments> &hi) {
+        const double a = std::min(lo.step, hi.step), b = std::max(lo.step, hi.step);
+        const double width = b - a;
+
+        const double d1 = lo.slope + hi.slope - 3.0 * (lo.value - hi.value) / (lo.step - hi.step);
+        const double discriminant = d1 * d1 - lo.slope * hi.slope;
+        if (discriminant >= 0.0) {
+            const double d2 = std::copysign(std::sqrt(discriminant), hi.step - lo.step);
+            const double t = hi.step - (hi.step - lo.step) * (hi.slope + d2 - d1) /
+                                           (hi.slope - lo.slope + 2.0 * d2);
+            if (std::isfinite(t) && t >= a + 0.1 * width && t <= b - 0.1 * width)
+                return t;
+        }
+
+        return 0.5 * (a + b);
+    }
+
+  private:
+    HyperParameters m_hyperParameters;
+};
+} // namespace ml
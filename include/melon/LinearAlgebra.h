@@ -0,0 +1,185 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/Simd.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace ml {
+
+/**
+ * Dense row-major square matrix.
+ */
+class SquareMatrix {
+  public:
+    SquareMatrix() : SquareMatrix(0) {}
+
+    explicit SquareMatrix(const size_t n) : m_size(n), m_data(n * n, 0.0) {}
+
+    size_t size() const { return m_size; }
+
+    double &operator()(const size_t i, const size_t j) { return m_data[i * m_size + j]; }
+
+    double operator()(const size_t i, const size_t j) const { return m_data[i * m_size + j]; }
+
+    double *row(const size_t i) { return m_data.data() + i * m_size; }
+
+    const double *row(const size_t i) const { return m_data.data() + i * m_size; }
+
+    SquareMatrix &operator+=(const SquareMatrix &other) {
+        simd::add(m_data.data(), other.m_data.data(), m_data.data(), m_data.size());
+        return *this;
+    }
+
+    SquareMatrix &operator*=(const double s) {
+        simd::mul(m_data.data(), s, m_data.data(), m_data.size());
+        return *this;
+    }
+
+  private:
+    size_t m_size;
+    AlignedVector<double> m_data;
+};
+
+/**
+ * Add the sum over rows r of weights[r] * [x_r, 1] [x_r, 1]^T to the lower triangle of gram,
+ * where x_r are numRows rows of numFeatures values stride elements apart and gram has size
+ * numFeatures + 1. Null weights count every row once. Rows are processed in blocks so that a
+ * row of gram stays in cache while a block is accumulated into it.
+ */
+template <typename TScalar>
+void addWeightedGram(const TScalar *rows, const size_t numRows, const size_t stride,
+                     const size_t numFeatures, const double *weights, SquareMatrix &gram) {
+    constexpr size_t BlockSize = 64;
+    const size_t n = numFeatures + 1;
+    AlignedVector<double> block(BlockSize * n);
+
+    for (size_t b = 0; b < numRows; b += BlockSize) {
+        const size_t count = std::min(BlockSize, numRows - b);
+        for (size_t r = 0; r < count; r++) {
+            const TScalar *x = rows + (b + r) * stride;
+            std::copy(x, x + numFeatures, block.data() + r * n);
+            block[r * n + numFeatures] = 1.0;
+        }
+
+        for (size_t i = 0; i < n; i++) {
+            double *gramRow = gram.row(i);
+            for (size_t r = 0; r < count; r++) {
+                const double *x = block.data() + r * n;
+                const double weight = weights == nullptr ? 1.0 : weights[b + r];
+                simd::axpy(weight * x[i], x, gramRow, i + 1);
+            }
+        }
+    }
+}
+
+/**
+ * In-place Cholesky decomposition a = L L^T of a symmetric positive definite matrix; only the
+ * lower triangle of a is read and L overwrites it. Returns false when a is not numerically
+ * positive definite, that is when a pivot falls below minPivotRatio times the largest diagonal
+ * element.
+ */
+inline bool choleskyDecompose(SquareMatrix &a, const double minPivotRatio = 1E-12) {
+    const size_t n = a.size();
+    double maxDiagonal = 0.0;
+    for (size_t i = 0; i < n; i++)
+        maxDiagonal = std::max(maxDiagonal, a(i, i));
+
+    for (size_t j = 0; j < n; j++) {
+        const double pivot = a(j, j) - simd::sumOfSquares(a.row(j), j);
+        if (!(pivot > minPivotRatio * maxDiagonal))
+            return false;
+
+        const double ljj = std::sqrt(pivot);
+        a(j, j) = ljj;
+        for (size_t i = j + 1; i < n; i++)
+            a(i, j) = (a(i, j) - simd::dot(a.row(i), a.row(j), j)) / ljj;
+    }
+
+    return true;
+}
+
+/**
+ * Solve L L^T x = b given the Cholesky factor L from choleskyDecompose. b is overwritten with x.
+ */
+inline void choleskySolve(const SquareMatrix &l, double *b) {
+    const size_t n = l.size();
+
+    for (size_t i = 0; i < n; i++) {
+        double sum = b[i];
+        for (size_t k = 0; k < i; k++)
+            sum -= l(i, k) * b[k];
+        b[i] = sum / l(i, i);
+    }
+
+    for (size_t i = n; i-- > 0;) {
+        double sum = b[i];
+        for (size_t k = i + 1; k < n; k++)
+            sum -= l(k, i) * b[k];
+        b[i] = sum / l(i, i);
+    }
+}
+
+/**
+ * Least squares min |A x - b| by QR decomposition of A, with A and b streamed one row at a time.
+ * Each row is rotated into the upper triangular factor R with Givens rotations, so A is never
+ * stored and its condition number is not squared as it is by the normal equations.
+ */
+class GivensLeastSquares {
+  public:
+    explicit GivensLeastSquares(const size_t n) : m_r(n), m_qtb(n, 0.0), m_row(n, 0.0) {}
+
+    size_t size() const { return m_r.size(); }
+
+    void addRow(const double *a, double b) {
+        const size_t n = size();
+        std::copy(a, a + n, m_row.begin());
+
+        for (size_t k = 0; k < n; k++) {
+            if (m_row[k] == 0.0)
+                continue;
+
+            double *r = m_r.row(k);
+            const double radius = std::hypot(r[k], m_row[k]);
+            const double c = r[k] / radius, s = m_row[k] / radius;
+
+            r[k] = radius;
+            m_row[k] = 0.0;
+            for (size_t j = k + 1; j < n; j++) {
+                const double rj = r[j];
+                r[j] = c * rj + s * m_row[j];
+                m_row[j] = c * m_row[j] - s * rj;
+            }
+
+            const double qtbk = m_qtb[k];
+            m_qtb[k] = c * qtbk + s * b;
+            b = c * b - s * qtbk;
+        }
+    }
+
+    /**
+     * Back substitution R x = Q^T b. Returns false when R is singular.
+     */
+    bool solve(double *x) const {
+        const size_t n = size();
+        for (size_t i = n; i-- > 0;) {
+            if (m_r(i, i) == 0.0)
+                return false;
+
+            double sum = m_qtb[i];
+            for (size_t j = i + 1; j < n; j++)
+                sum -= m_r(i, j) * x[j];
+            x[i] = sum / m_r(i, i);
+        }
+
+        return true;
+    }
+
+  private:
+    SquareMatrix m_r;
+    AlignedVector<double> m_qtb;
+    AlignedVector<double> m_row;
+};
+} // namespace ml
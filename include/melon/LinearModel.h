@@ -1,14 +1,13 @@
 #pragma once
 
+#include <melon/Simd.h>
 #include <melon/Types.h>
 
-#include <numeric>
-
 namespace ml {
 template <size_t dim> class LinearModel {
   public:
     static constexpr size_t ArgumentDim = dim;
-    static constexpr size_t NumParameters = ArgumentDim + 1;
+    static constexpr size_t NumParameters = augmentedDim(ArgumentDim);
 
     using argument_type = Vector<ArgumentDim>;
     using parameters_type = Vector<NumParameters>;
@@ -21,8 +20,39 @@ template <size_t dim> class LinearModel {
 
     const parameters_type &parameters() const { return m_parameters; }
 
-    double eval(const argument_type &x) const {
-        return std::inner_product(x.begin(), x.end(), m_parameters.begin(), m_parameters.back());
+    /**
+     * Number of features, ArgumentDim unless the model is Dynamic.
+     */
+    size_t numFeatures() const { return m_parameters.size() - 1; }
+
+    /**
+     * Prediction for the linear score w . x + b.
+     */
+    static double link(const double score) { return score; }
+
+    double eval(const argument_type &x) const { return eval(x.data()); }
+
+    /**
+     * Evaluate the model on numFeatures() contiguous features, doubles or floats.
+     */
+    template <typename TScalar> double eval(const TScalar *x) const {
+        return simd::dot(x, m_parameters.data(), numFeatures()) + m_parameters.back();
+    }
+
+    /**
+     * Evaluate the model on sparse features, in time linear in their number of nonzeros.
+     */
+    double eval(const SparseVectorView &x) const {
+        return dot(x, m_parameters.data()) + m_parameters.back();
+    }
+
+    /**
+     * Evaluate the model on n rows of features starting at x, stride elements apart.
+     */
+    template <typename TScalar>
+    void evalBatch(const TScalar *x, const size_t n, const size_t stride, double *out) const {
+        simd::gemv(x, n, numFeatures(), stride, m_parameters.data(), out);
+        simd::add(out, m_parameters.back(), out, n);
     }
 
   private:
@@ -3,54 +3,83 @@
 #include <melon/LinearModel.h>
 #include <melon/Regression.h>
 
+#include <algorithm>
+
 namespace ml {
 
-template <size_t dim> class LinearRegressionCostFunction : public CostFunction<LinearModel<dim>> {
+template <size_t dim, typename TScalar = double>
+class LinearRegressionCostFunction : public CostFunction<LinearModel<dim>, TScalar> {
   public:
     using model_type = LinearModel<dim>;
     using argument_type = typename model_type::parameters_type;
     using gradient_type = argument_type;
     using training_set_type = TrainingSet<dim>;
+    using dataset_view_type = DatasetView<dim, TScalar>;
+    using source_type = ChunkedDatasetSource<dim, TScalar>;
 
   public:
     LinearRegressionCostFunction(const training_set_type &trainingSet)
-        : CostFunction<model_type>(trainingSet) {}
+        : CostFunction<model_type, TScalar>(trainingSet) {}
+
+    LinearRegressionCostFunction(const dataset_view_type &dataset)
+        : CostFunction<model_type, TScalar>(dataset) {}
 
-    double eval(const argument_type &input) const {
-        const model_type model(input);
+    LinearRegressionCostFunction(std::shared_ptr<const source_type> source)
+        : CostFunction<model_type, TScalar>(std::move(source)) {}
 
-        double cost = 0.0;
-        for (const auto &[x, y] : this->m_trainingSet) {
-            const double diff = model.eval(x) - y;
-            cost += (diff * diff);
-        }
+    double eval(const argument_type &input) const { return this->evalLoss(input, loss); }
 
-        double regularizationTerm = 0.0;
-        for(size_t i = 0; i < model.parameters().size() - 1; i++) {
-            const auto param = model.parameters()[i];
-            regularizationTerm += (param * param);
-        }
+    gradient_type gradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, loss).gradient;
+    }
 
-        regularizationTerm *= this->m_regularizationFactor;
+    ValueAndGradient<gradient_type> valueAndGradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, loss);
+    }
 
-        const double numExamples = static_cast<double>(this->m_trainingSet.size());
-        return (0.5 * cost + regularizationTerm) / numExamples;
+    /**
+     * (X^T X + lambda I') / N, independent of input. Only the lower triangle is filled.
+     */
+    SquareMatrix hessian(const argument_type &input) const {
+        return this->evalHessian(input, [](double) { return 1.0; });
     }
+
+    /**
+     * Squared error of the predictions, the linear scores, for n examples and its derivative
+     * with respect to the scores.
+     */
+    static constexpr auto loss = [](const double *scores, const auto *labels, double *losses,
+                                    double *residuals, const size_t n) {
+        simd::squaredLoss(scores, labels, losses, residuals, n);
+    };
+
+    /**
+     * Second derivative of the squared error with respect to the scores, for n examples.
+     */
+    static constexpr auto curvature = [](const double *, double *curvatures, const size_t n) {
+        std::fill(curvatures, curvatures + n, 1.0);
+    };
 };
 
 /**
    Linear model regression.
  */
-template <size_t dim>
-class LinearRegression : public Regression<LinearModel<dim>, LinearRegressionCostFunction<dim>> {
+template <size_t dim, typename TScalar = double>
+class LinearRegression
+    : public Regression<LinearModel<dim>, LinearRegressionCostFunction<dim, TScalar>> {
   public:
-    using cost_function_type = LinearRegressionCostFunction<dim>;
+    using cost_function_type = LinearRegressionCostFunction<dim, TScalar>;
     using training_set_type = typename cost_function_type::training_set_type;
+    using dataset_view_type = typename cost_function_type::dataset_view_type;
+    using source_type = typename cost_function_type::source_type;
 
   private:
-    virtual LinearRegressionCostFunction<dim>
-    getCostFunction(const training_set_type &trainingSet) {
-        return LinearRegressionCostFunction<dim>(trainingSet);
+    virtual cost_function_type getCostFunction(const dataset_view_type &dataset) {
+        return cost_function_type(dataset);
+    }
+
+    virtual cost_function_type getCostFunction(std::shared_ptr<const source_type> source) {
+        return cost_function_type(std::move(source));
     }
 };
 
@@ -1,14 +1,13 @@
 #pragma once
 
 #include <melon/LinearModel.h>
-
-#include <cmath>
+#include <melon/Simd.h>
 
 namespace ml {
 template <size_t dim> class LogisticModel {
   public:
     static constexpr size_t ArgumentDim = dim;
-    static constexpr size_t NumParameters = ArgumentDim + 1;
+    static constexpr size_t NumParameters = augmentedDim(ArgumentDim);
 
     using argument_type = Vector<ArgumentDim>;
     using parameters_type = Vector<NumParameters>;
@@ -23,9 +22,34 @@ template <size_t dim> class LogisticModel {
 
     const parameters_type &parameters() const { return m_linearModel.parameters(); }
 
-    double eval(const argument_type &x) const {
-        const double z = m_linearModel.eval(x);
-        return 1.0 / (1.0 + std::exp(-z));
+    size_t numFeatures() const { return m_linearModel.numFeatures(); }
+
+    /**
+     * Prediction for the linear score w . x + b.
+     */
+    static double link(const double score) { return simd::sigmoid(score); }
+
+    double eval(const argument_type &x) const { return eval(x.data()); }
+
+    /**
+     * Evaluate the model on numFeatures() contiguous features, doubles or floats.
+     */
+    template <typename TScalar> double eval(const TScalar *x) const {
+        return simd::sigmoid(m_linearModel.eval(x));
+    }
+
+    /**
+     * Evaluate the model on sparse features, in time linear in their number of nonzeros.
+     */
+    double eval(const SparseVectorView &x) const { return simd::sigmoid(m_linearModel.eval(x)); }
+
+    /**
+     * Evaluate the model on n rows of features starting at x, stride elements apart.
+     */
+    template <typename TScalar>
+    void evalBatch(const TScalar *x, const size_t n, const size_t stride, double *out) const {
+        m_linearModel.evalBatch(x, n, stride, out);
+        simd::sigmoid(out, out, n);
     }
 
   private:
@@ -3,60 +3,84 @@
 #include <melon/LogisticModel.h>
 #include <melon/Regression.h>
 
-#include <cmath>
-
 namespace ml {
-template <size_t dim>
-class LogisticRegressionCostFunction : public CostFunction<LogisticModel<dim>> {
+template <size_t dim, typename TScalar = double>
+class LogisticRegressionCostFunction : public CostFunction<LogisticModel<dim>, TScalar> {
   public:
     using model_type = LogisticModel<dim>;
     using argument_type = typename model_type::parameters_type;
     using gradient_type = argument_type;
     using training_set_type = TrainingSet<dim>;
+    using dataset_view_type = DatasetView<dim, TScalar>;
+    using source_type = ChunkedDatasetSource<dim, TScalar>;
 
   public:
     LogisticRegressionCostFunction(const training_set_type &trainingSet)
-        : CostFunction<model_type>(trainingSet) {}
-
-    double eval(const argument_type &input) const {
-        const model_type model(input);
-
-        double cost = 0.0;
-        for (const auto &[x, y] : this->m_trainingSet) {
-            const double prediction = model.eval(x);
-            if (y > 1E-8)
-                cost += (y * std::log(prediction));
-            else if (y < 1.0 - 1E-8)
-                cost += ((1.0 - y) * std::log(1.0 - prediction));
-        }
-
-        double regularizationTerm = 0.0;
-        for(size_t i = 0; i < model.parameters().size() - 1; i++) {
-            const auto param = model.parameters()[i];
-            regularizationTerm += (param * param);
-        }
-
-        regularizationTerm *= (0.5 * this->m_regularizationFactor);
-
-        const double numExamples = static_cast<double>(this->m_trainingSet.size());
-        return (-cost + regularizationTerm) / numExamples;
+        : CostFunction<model_type, TScalar>(trainingSet) {}
+
+    LogisticRegressionCostFunction(const dataset_view_type &dataset)
+        : CostFunction<model_type, TScalar>(dataset) {}
+
+    LogisticRegressionCostFunction(std::shared_ptr<const source_type> source)
+        : CostFunction<model_type, TScalar>(std::move(source)) {}
+
+    double eval(const argument_type &input) const { return this->evalLoss(input, loss); }
+
+    gradient_type gradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, loss).gradient;
+    }
+
+    ValueAndGradient<gradient_type> valueAndGradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, loss);
     }
+
+    /**
+     * (X^T W X + lambda I') / N with W = diag(p (1 - p)). Only the lower triangle is filled.
+     */
+    SquareMatrix hessian(const argument_type &input) const {
+        return this->evalHessian(input, [](const double p) { return p * (1.0 - p); });
+    }
+
+    /**
+     * Cross entropy of the logistic predictions for n examples, computed from their linear
+     * scores, and its derivative sigmoid(score) - y with respect to the scores.
+     */
+    static constexpr auto loss = [](const double *scores, const auto *labels, double *losses,
+                                    double *residuals, const size_t n) {
+        simd::logisticLoss(scores, labels, losses, residuals, n);
+    };
+
+    /**
+     * Second derivative p (1 - p) of the cross entropy with respect to the scores, for n
+     * examples.
+     */
+    static constexpr auto curvature = [](const double *scores, double *curvatures,
+                                         const size_t n) {
+        simd::sigmoid(scores, curvatures, n);
+        for (size_t i = 0; i < n; i++)
+            curvatures[i] *= 1.0 - curvatures[i];
+    };
 };
 
 /**
    Logistic model regression.
  */
-template <size_t dim>
+template <size_t dim, typename TScalar = double>
 class LogisticRegression
-    : public Regression<LogisticModel<dim>, LogisticRegressionCostFunction<dim>> {
+    : public Regression<LogisticModel<dim>, LogisticRegressionCostFunction<dim, TScalar>> {
   public:
-    using cost_function_type = LogisticRegressionCostFunction<dim>;
+    using cost_function_type = LogisticRegressionCostFunction<dim, TScalar>;
     using training_set_type = typename cost_function_type::training_set_type;
+    using dataset_view_type = typename cost_function_type::dataset_view_type;
+    using source_type = typename cost_function_type::source_type;
 
   private:
-    virtual LogisticRegressionCostFunction<dim>
-    getCostFunction(const training_set_type &trainingSet) {
-        return LogisticRegressionCostFunction<dim>(trainingSet);
+    virtual cost_function_type getCostFunction(const dataset_view_type &dataset) {
+        return cost_function_type(dataset);
+    }
+
+    virtual cost_function_type getCostFunction(std::shared_ptr<const source_type> source) {
+        return cost_function_type(std::move(source));
     }
 };
 } // namespace ml
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/FeatureStatistics.h>
+#include <melon/LinearModel.h>
+#include <melon/LogisticModel.h>
+#include <melon/Simd.h>
+#include <melon/SoftmaxModel.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ml {
+
+/**
+ * Family of a model stored in a model file, which sets how scores are turned into predictions.
+ */
+enum class ModelKind : uint32_t { Linear = 1, Logistic = 2, Softmax = 3 };
+
+template <typename TModel> struct ModelKindOf;
+
+template <size_t dim> struct ModelKindOf<LinearModel<dim>> {
+    static constexpr ModelKind value = ModelKind::Linear;
+};
+
+template <size_t dim> struct ModelKindOf<LogisticModel<dim>> {
+    static constexpr ModelKind value = ModelKind::Logistic;
+};
+
+template <size_t dim> struct ModelKindOf<SoftmaxModel<dim>> {
+    static constexpr ModelKind value = ModelKind::Softmax;
+};
+
+/**
+ * Header of a model file. All fields and values of a model file are little-endian, whatever the
+ * machine that wrote it. The header is followed by numParameters parameters, numClasses rows of
+ * numFeatures weights and a bias, then, unless the file is folded, by the mean and by the
+ * population variance of every feature over the count examples the model was fitted on, of which
+ * the first refitOffset rows make up the dataset a later refit() extends. Each block starts on a
+ * cache line boundary.
+ *
+ * Parameters of a folded file apply to raw features: normalization is folded into them, and
+ * the file holds no statistics. Parameters of other files apply to normalized features.
+ */
+struct ModelFileHeader {
+    static constexpr char Magic[8] = {'M', 'E', 'L', 'O', 'N', 'M', 'D', 'L'};
+    static constexpr uint32_t Version = 2;
+    static constexpr uint32_t Folded = 1;
+
+    char magic[8];
+    uint32_t version;
+    ModelKind kind;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t numFeatures;
+    uint64_t numClasses;
+    uint64_t numParameters;
+    uint64_t count;
+    uint64_t refitOffset;
+
+    bool folded() const { return (flags & Folded) != 0; }
+
+    size_t parametersOffset() const { return sizeof(ModelFileHeader); }
+
+    size_t meansOffset() const {
+        return parametersOffset() + paddedSize<double>(numParameters) * sizeof(double);
+    }
+
+    size_t variancesOffset() const {
+        return meansOffset() + paddedSize<double>(numFeatures) * sizeof(double);
+    }
+
+    size_t fileSize() const {
+        return folded() ? meansOffset()
+                        : variancesOffset() + paddedSize<double>(numFeatures) * sizeof(double);
+    }
+
+    /**
+     * Whether numParameters is numClasses rows of numFeatures weights and a bias, and the
+     * blocks fit in size bytes. Counts are bounded by size before they are multiplied, so a
+     * header cannot wrap the computed file size around.
+     */
+    bool fitsIn(const size_t size) const {
+        const size_t maxValues = size / sizeof(double);
+        if (numFeatures >= maxValues || numClasses == 0 || numClasses > maxValues ||
+            numParameters > maxValues)
+            return false;
+
+        return numParameters % numClasses == 0 && numParameters / numClasses == numFeatures + 1 &&
+               fileSize() <= size;
+    }
+};
+
+static_assert(sizeof(ModelFileHeader) == CacheLineSize);
+
+namespace detail {
+
+constexpr bool LittleEndianHost = __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__;
+
+/**
+ * value converted between host and little-endian byte order, in either direction.
+ */
+template <typename T> T littleEndian(const T value) {
+    if constexpr (LittleEndianHost) {
+        return value;
+    } else {
+        unsigned char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        std::reverse(bytes, bytes + sizeof(T));
+        T swapped;
+        std::memcpy(&swapped, bytes, sizeof(T));
+        return swapped;
+    }
+}
+
+inline ModelFileHeader littleEndian(ModelFileHeader header) {
+    header.version = littleEndian(header.version);
+    header.kind = static_cast<ModelKind>(littleEndian(static_cast<uint32_t>(header.kind)));
+    header.flags = littleEndian(header.flags);
+    header.numFeatures = littleEndian(header.numFeatures);
+    header.numClasses = littleEndian(header.numClasses);
+    header.numParameters = littleEndian(header.numParameters);
+    header.count = littleEndian(header.count);
+    header.refitOffset = littleEndian(header.refitOffset);
+    return header;
+}
+
+/**
+ * Write n values in little-endian order, followed by zeros up to a cache line boundary.
+ */
+inline void writeLittleEndian(std::ofstream &file, const double *values, const size_t n) {
+    double buffer[CacheLineSize / sizeof(double)];
+    const size_t perLine = CacheLineSize / sizeof(double);
+    for (size_t begin = 0; begin < paddedSize<double>(n); begin += perLine) {
+        for (size_t i = 0; i < perLine; i++)
+            buffer[i] = begin + i < n ? littleEndian(values[begin + i]) : 0.0;
+        file.write(reinterpret_cast<const char *>(buffer), sizeof(buffer));
+    }
+}
+} // namespace detail
+
+/**
+ * Save the fitted regression to path, in the model file format. With foldNormalization the
+ * file holds the parameters of the scoring model, ready to be served, but not the statistics
+ * needed to resume training. The file is written next to path and renamed over it, so readers
+ * see either the previous file or the new one, never a partial write. Model files do not
+ * record feature expansions, so regressions fitted with one cannot be saved.
+ */
+template <typename TRegression>
+void saveModel(const std::string &path, const TRegression &regression,
+               const bool foldNormalization = true) {
+    using model_type = typename TRegression::model_type;
+
+    if (regression.featureExpansion())
+        throw std::logic_error("model files do not record feature expansions");
+
+    const auto &statistics = regression.statistics();
+    const auto &parameters =
+        (foldNormalization ? regression.scoringModel() : regression.model()).parameters();
+
+    ModelFileHeader header{};
+    std::copy(std::begin(ModelFileHeader::Magic), std::end(ModelFileHeader::Magic), header.magic);
+    header.version = ModelFileHeader::Version;
+    header.kind = ModelKindOf<model_type>::value;
+    header.flags = foldNormalization ? ModelFileHeader::Folded : 0;
+    header.numFeatures = statistics.numFeatures();
+    header.numParameters = parameters.size();
+    header.numClasses = parameters.size() / (statistics.numFeatures() + 1);
+    header.count = foldNormalization ? 0 : statistics.count();
+    header.refitOffset = foldNormalization ? 0 : regression.refitOffset();
+
+    const std::string temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error("cannot open " + temporaryPath + " for writing");
+
+        const auto littleEndianHeader = detail::littleEndian(header);
+        file.write(reinterpret_cast<const char *>(&littleEndianHeader), sizeof(header));
+        detail::writeLittleEndian(file, parameters.data(), parameters.size());
+        if (!foldNormalization) {
+            detail::writeLittleEndian(file, statistics.mean().data(), statistics.numFeatures());
+            detail::writeLittleEndian(file, statistics.variance().data(),
+                                      statistics.numFeatures());
+        }
+
+        if (!file.flush())
+            throw std::runtime_error("failed writing " + temporaryPath);
+    }
+
+    if (std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+        throw std::runtime_error("cannot rename " + temporaryPath + " to " + path);
+}
+
+/**
+ * Read-only memory mapping of a model file, which scores raw features without a Regression.
+ * Opening a file only maps it and validates its header: the parameters of a folded file are
+ * used in place, so loading takes the same time whatever the size of the model. Files that are
+ * not folded have their normalization folded into a copy of the parameters once, on opening.
+ */
+class MappedModel {
+  public:
+    explicit MappedModel(const std::string &path) {
+        const int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw std::runtime_error("cannot open " + path);
+
+        struct stat status;
+        if (::fstat(fd, &status) != 0 ||
+            static_cast<size_t>(status.st_size) < sizeof(ModelFileHeader)) {
+            ::close(fd);
+            throw std::runtime_error(path + " is not a model file");
+        }
+
+        m_size = static_cast<size_t>(status.st_size);
+        m_data = ::mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (m_data == MAP_FAILED)
+            throw std::runtime_error("cannot map " + path);
+
+        std::memcpy(&m_header, m_data, sizeof(m_header));
+        m_header = detail::littleEndian(m_header);
+        if (!valid()) {
+            ::munmap(m_data, m_size);
+            throw std::runtime_error(path + " is not a model file of a supported version");
+        }
+
+        m_parameters = values(m_header.parametersOffset(), m_header.numParameters);
+        if (!folded()) {
+            m_means = values(m_header.meansOffset(), numFeatures());
+            m_variances = values(m_header.variancesOffset(), numFeatures());
+        }
+        m_scoring = folded() ? m_parameters : foldedParameters();
+    }
+
+    MappedModel(const MappedModel &) = delete;
+
+    MappedModel &operator=(const MappedModel &) = delete;
+
+    ~MappedModel() { ::munmap(m_data, m_size); }
+
+    ModelKind kind() const { return m_header.kind; }
+
+    size_t numFeatures() const { return m_header.numFeatures; }
+
+    size_t numClasses() const { return m_header.numClasses; }
+
+    size_t numParameters() const { return m_header.numParameters; }
+
+    bool folded() const { return m_header.folded(); }
+
+    /**
+     * Number of examples the statistics were computed on; 0 for folded files.
+     */
+    size_t count() const { return m_header.count; }
+
+    /**
+     * Rows of the dataset of the last fit() or refit() among count(); 0 for folded files.
+     */
+    size_t refitOffset() const { return m_header.refitOffset; }
+
+    /**
+     * Parameters as stored, normalized unless folded().
+     */
+    const double *parameters() const { return m_parameters; }
+
+    /**
+     * Feature means, or nullptr for folded files.
+     */
+    const double *means() const { return m_means; }
+
+    /**
+     * Population variances of the features, or nullptr for folded files.
+     */
+    const double *variances() const { return m_variances; }
+
+    /**
+     * Prediction for numFeatures() contiguous raw features, as Regression::predict().
+     */
+    template <typename TScalar> double predict(const TScalar *x) const {
+        const size_t rowSize = numFeatures() + 1;
+        if (kind() == ModelKind::Softmax) {
+            size_t best = 0;
+            double bestLogit = 0.0;
+            for (size_t c = 0; c < numClasses(); c++) {
+                const double *w = m_scoring + c * rowSize;
+                const double logit = simd::dot(x, w, numFeatures()) + w[numFeatures()];
+                if (c == 0 || logit > bestLogit) {
+                    best = c;
+                    bestLogit = logit;
+                }
+            }
+            return static_cast<double>(best);
+        }
+
+        const double score = simd::dot(x, m_scoring, numFeatures()) + m_scoring[numFeatures()];
+        return kind() == ModelKind::Logistic ? simd::sigmoid(score) : score;
+    }
+
+    /**
+     * Predictions for numRows rows of raw features starting at features, stride elements apart,
+     * as Regression::predictBatch(): one value per row, or numClasses() probabilities per row
+     * for softmax models.
+     */
+    template <typename TScalar>
+    void predictBatch(const TScalar *features, const size_t numRows, const size_t stride,
+                      double *out) const {
+        const size_t rowSize = numFeatures() + 1;
+        if (kind() == ModelKind::Softmax) {
+            simd::gemm(features, numRows, numFeatures(), stride, m_scoring, numClasses(), rowSize,
+                       out);
+            for (size_t r = 0; r < numRows; r++)
+                for (size_t c = 0; c < numClasses(); c++)
+                    out[r * numClasses() + c] += m_scoring[c * rowSize + numFeatures()];
+            simd::softmax(out, numRows, numClasses());
+            return;
+        }
+
+        simd::gemv(features, numRows, numFeatures(), stride, m_scoring, out);
+        simd::add(out, m_scoring[numFeatures()], out, numRows);
+        if (kind() == ModelKind::Logistic)
+            simd::sigmoid(out, out, numRows);
+    }
+
+  private:
+    bool valid() const {
+        const bool knownKind = m_header.kind == ModelKind::Linear ||
+                               m_header.kind == ModelKind::Logistic ||
+                               m_header.kind == ModelKind::Softmax;
+        const bool oneClass = m_header.kind != ModelKind::Softmax;
+        return std::equal(std::begin(m_header.magic), std::end(m_header.magic),
+                          std::begin(ModelFileHeader::Magic)) &&
+               m_header.version == ModelFileHeader::Version && knownKind &&
+               (!oneClass || m_header.numClasses == 1) && m_header.refitOffset <= m_header.count &&
+               m_header.fitsIn(m_size);
+    }
+
+    /**
+     * n doubles at offset in the file: the mapping itself on little-endian hosts, a converted
+     * copy on others.
+     */
+    const double *values(const size_t offset, const size_t n) {
+        const auto *stored =
+            reinterpret_cast<const double *>(static_cast<const char *>(m_data) + offset);
+        if constexpr (detail::LittleEndianHost) {
+            return stored;
+        } else {
+            m_converted.emplace_back(n);
+            std::transform(stored, stored + n, m_converted.back().begin(),
+                           [](const double x) { return detail::littleEndian(x); });
+            return m_converted.back().data();
+        }
+    }
+
+    /**
+     * Parameters with normalization folded in, as Regression::foldNormalization().
+     */
+    const double *foldedParameters() {
+        const size_t d = numFeatures();
+        m_folded.assign(m_parameters, m_parameters + numParameters());
+        for (size_t row = 0; row < numParameters(); row += d + 1) {
+            double *w = m_folded.data() + row;
+            for (size_t j = 0; j < d; j++) {
+                const double sdev = std::sqrt(m_variances[j]);
+                w[j] /= sdev > 0.0 ? sdev : 1.0;
+                w[d] -= w[j] * m_means[j];
+            }
+        }
+        return m_folded.data();
+    }
+
+    void *m_data{nullptr};
+    size_t m_size{0};
+    ModelFileHeader m_header;
+    const double *m_parameters{nullptr};
+    const double *m_means{nullptr};
+    const double *m_variances{nullptr};
+    const double *m_scoring{nullptr};
+    AlignedVector<double> m_folded;
+    std::vector<AlignedVector<double>> m_converted;
+};
+
+/**
+ * Restore regression from a model file saved from a regression of the same type. Training can
+ * continue with refit() or partialFit(); after loading a folded file, which holds no
+ * statistics, they start accumulating statistics afresh. regression must not have a feature
+ * expansion, which model files do not record.
+ */
+template <typename TRegression> void loadModel(const std::string &path, TRegression &regression) {
+    using model_type = typename TRegression::model_type;
+    using parameters_type = typename TRegression::parameters_type;
+    constexpr size_t dim = model_type::ArgumentDim;
+
+    if (regression.featureExpansion())
+        throw std::logic_error("model files do not record feature expansions");
+
+    const MappedModel model(path);
+    if (model.kind() != ModelKindOf<model_type>::value ||
+        (dim != Dynamic && model.numFeatures() != dim) ||
+        regression.numParameters(model.numFeatures()) != model.numParameters())
+        throw std::runtime_error(path + " does not hold a model of this regression");
+
+    const auto copy = [](const double *values, const size_t n, auto result) {
+        std::copy(values, values + n, result.begin());
+        return result;
+    };
+
+    const size_t d = model.numFeatures();
+    FeatureStatistics<dim> statistics(d);
+    if (!model.folded())
+        statistics = FeatureStatistics<dim>(model.count(),
+                                            copy(model.means(), d, zeros<Vector<dim>>(d)),
+                                            copy(model.variances(), d, zeros<Vector<dim>>(d)));
+
+    regression.setState(statistics, model.refitOffset(),
+                        copy(model.parameters(), model.numParameters(),
+                             zeros<parameters_type>(model.numParameters())));
+}
+
+/**
+ * Model file that serving threads read while another thread replaces it. current() returns a
+ * snapshot that stays mapped for as long as the caller holds it, however many times the model
+ * is replaced meanwhile.
+ */
+class HotSwappableModel {
+  public:
+    HotSwappableModel() = default;
+
+    explicit HotSwappableModel(const std::string &path) { load(path); }
+
+    std::shared_ptr<const MappedModel> current() const { return std::atomic_load(&m_model); }
+
+    /**
+     * Map the model file at path and publish it once it is validated; on error the current
+     * model stays in place.
+     */
+    void load(const std::string &path) { swap(std::make_shared<const MappedModel>(path)); }
+
+    void swap(std::shared_ptr<const MappedModel> model) {
+        std::atomic_store(&m_model, std::move(model));
+    }
+
+  private:
+    std::shared_ptr<const MappedModel> m_model;
+};
+} // namespace ml
@@ -0,0 +1,161 @@
+#pragma once
+
+#include <melon/DifferentiableFunction.h>
+#include <melon/LinearAlgebra.h>
+#include <melon/OptimizationObserver.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ml {
+
+/**
+ * Damped Newton's method for twice differentiable functions that provide hessian() as a
+ * SquareMatrix. On the logistic regression cost function this is iteratively reweighted least
+ * squares: each step solves a weighted least squares problem with weights p (1 - p).
+ */
+class NewtonMethod {
+  public:
+    struct HyperParameters {
+        size_t maxIter = 100;
+        double gradientTolerance = 1E-10;      // stop when |gradient| falls below
+        double relativeErrorTolerance = 1E-12; // stop when decrease / max(|value|, 1) falls below
+        double sufficientDecrease = 1E-4;      // Armijo constant for backtracking
+        double reductionFactor = 0.5;          // backtracking step reduction, (0, 1)
+        size_t maxLineSearchEvaluations = 30;
+    };
+
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
+
+    NewtonMethod &withHyperParameters(const HyperParameters hyperParameters) {
+        m_hyperParameters = hyperParameters;
+        return *this;
+    }
+
+    template <typename TDifferentiableFunction>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        NullObserver observer;
+        return optimize(function, initialArguments, observer);
+    }
+
+    /**
+     * Optimize, reporting every iteration and evaluation to observer. Hessian evaluations are
+     * reported as gradient evaluations.
+     */
+    template <typename TDifferentiableFunction, typename TObserver>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments,
+             TObserver &observer) const {
+        static_assert(HasHessian<TDifferentiableFunction>::value,
+                      "NewtonMethod requires a function that provides hessian()");
+        using argument_type = typename TDifferentiableFunction::argument_type;
+        const auto &observedFunction = observe(function, observer);
+
+        Result<argument_type> result{initialArguments, 0.0, 0, 0, 0};
+        argument_type &arguments = result.optimalArguments;
+        result.stopReason = StopReason::MaxIterations;
+
+        while (result.numIterations < m_hyperParameters.maxIter) {
+            const auto evaluation = evalWithGradient(observedFunction, arguments);
+            result.optimalValue = evaluation.value;
+            result.numFunctionEvaluations++;
+            result.numGradientEvaluations++;
+
+            const double gradientNorm = std::sqrt(sqLength(evaluation.gradient));
+            if (gradientNorm <= m_hyperParameters.gradientTolerance) {
+                result.stopReason = StopReason::Converged;
+                break;
+            }
+
+            argument_type direction = -1.0 * evaluation.gradient;
+            solveNewtonSystem(observedFunction.hessian(arguments), direction.data());
+
+            double slope = dot(evaluation.gradient, direction);
+            if (!(slope < 0.0)) {
+                direction = -1.0 * evaluation.gradient;
+                slope = -sqLength(evaluation.gradient);
+            }
+
+            result.numIterations++;
+
+            double step = 1.0, value = evaluation.value;
+            bool decreased = false;
+            size_t numEvaluations = 0;
+            for (size_t i = 0; i < m_hyperParameters.maxLineSearchEvaluations; i++) {
+                value = observedFunction.eval(arguments + step * direction);
+                result.numFunctionEvaluations++;
+                numEvaluations++;
+                const double target =
+                    evaluation.value + m_hyperParameters.sufficientDecrease * step * slope;
+                if (value <= target) {
+                    decreased = true;
+                    break;
+                }
+                step *= m_hyperParameters.reductionFactor;
+            }
+
+            if (!decreased) {
+                result.stopReason = StopReason::LineSearchFailed;
+                if constexpr (TObserver::Enabled)
+                    observer.onIteration({result.numIterations, evaluation.value, gradientNorm,
+                                          0.0, numEvaluations});
+                break;
+            }
+
+            arguments = arguments + step * direction;
+            result.optimalValue = value;
+
+            if constexpr (TObserver::Enabled) {
+                const double stepSize = step * std::sqrt(sqLength(direction));
+                if (!observer.onIteration(
+                        {result.numIterations, value, gradientNorm, stepSize, numEvaluations})) {
+                    result.stopReason = StopReason::Observer;
+                    break;
+                }
+            }
+
+            if (evaluation.value - value <= m_hyperParameters.relativeErrorTolerance *
+                                                std::max(1.0, std::fabs(value))) {
+                result.stopReason = StopReason::Converged;
+                break;
+            }
+        }
+
+        return result;
+    }
+
+  private:
+    /**
+     * Overwrite b with the solution of hessian x = b. A Hessian that is not numerically positive
+     * definite gets a growing multiple of the identity added to its diagonal until it is; b is
+     * left unchanged, a gradient step, if no damping helps.
+     */
+    static void solveNewtonSystem(const SquareMatrix &hessian, double *b) {
+        const size_t n = hessian.size();
+        double maxDiagonal = 0.0;
+        for (size_t i = 0; i < n; i++)
+            maxDiagonal = std::max(maxDiagonal, std::fabs(hessian(i, i)));
+
+        double damping = 0.0;
+        while (std::isfinite(damping)) {
+            SquareMatrix factor = hessian;
+            for (size_t i = 0; i < n; i++)
+                factor(i, i) += damping;
+
+            if (choleskyDecompose(factor)) {
+                choleskySolve(factor, b);
+                return;
+            }
+
+            damping = damping == 0.0 ? 1E-10 * std::max(1.0, maxDiagonal) : 10.0 * damping;
+        }
+    }
+
+  private:
+    HyperParameters m_hyperParameters;
+};
+} // namespace ml
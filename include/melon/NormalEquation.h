@@ -0,0 +1,143 @@
+#pragma once
+
+#include <melon/DifferentiableFunction.h>
+#include <melon/LinearAlgebra.h>
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace ml {
+
+/**
+ * Direct solver for ridge-regularized least squares, the problem defined by
+ * LinearRegressionCostFunction. Solves (X^T X + lambda I') theta = X^T y, where X is the
+ * dataset with a column of ones for the bias and I' leaves the bias unregularized.
+ *
+ * Works on cost functions that provide reduceExamples(), forEachBlock() and
+ * regularizationFactor(), so any feature scaling of the cost function applies. The L1 penalty
+ * has no closed form: cost functions with a positive l1RegularizationFactor() are rejected, and
+ * are solved with CoordinateDescent instead.
+ */
+class NormalEquation {
+  public:
+    /**
+     * Cholesky factorizes the Gram matrix built in a single blocked pass over the data. QR
+     * rotates every example into a triangular factor in a second pass, which avoids squaring
+     * the condition number of the data. Automatic tries Cholesky first and falls back to QR
+     * when the Gram matrix is numerically singular. When no method solves the system,
+     * optimize() returns initialArguments with StopReason::Singular.
+     */
+    enum class Method { Automatic, Cholesky, QR };
+
+    struct HyperParameters {
+        Method method = Method::Automatic;
+        double minPivotRatio = 1E-10; // Cholesky pivots below this ratio select QR
+    };
+
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
+
+    NormalEquation &withHyperParameters(const HyperParameters hyperParameters) {
+        m_hyperParameters = hyperParameters;
+        return *this;
+    }
+
+    template <typename TCostFunction>
+    Result<typename TCostFunction::argument_type>
+    optimize(const TCostFunction &costFunction,
+             const typename TCostFunction::argument_type &initialArguments) const {
+        if (costFunction.l1RegularizationFactor() > 0.0)
+            throw std::logic_error("the normal equation cannot solve an L1 penalty");
+
+        auto parameters = initialArguments;
+        bool solved = false;
+
+        const size_t numFeatures = parameters.size() - 1;
+
+        if (m_hyperParameters.method != Method::QR)
+            solved = solveCholesky(costFunction, numFeatures, parameters.data());
+
+        if (!solved && m_hyperParameters.method != Method::Cholesky)
+            solved = solveQR(costFunction, numFeatures, parameters.data());
+
+        if (!solved)
+            return {initialArguments, costFunction.eval(initialArguments), 1, 1, 0,
+                    StopReason::Singular};
+
+        return {parameters, costFunction.eval(parameters), 1, 1, 0};
+    }
+
+  private:
+    struct NormalEquationTerms {
+        SquareMatrix gram;
+        AlignedVector<double> xty;
+    };
+
+    template <typename TCostFunction>
+    bool solveCholesky(const TCostFunction &costFunction, const size_t numFeatures,
+                       double *parameters) const {
+        const size_t n = numFeatures + 1;
+
+        auto terms = costFunction.reduceExamples(
+            [&](const auto &dataset, const size_t begin, const size_t end) {
+                NormalEquationTerms partial{SquareMatrix(n), AlignedVector<double>(n, 0.0)};
+                costFunction.forEachBlock(dataset, begin, end, [&](const auto &block) {
+                    addWeightedGram(block.row(0), block.size(), block.stride(), numFeatures,
+                                    nullptr, partial.gram);
+
+                    for (size_t i = 0; i < block.size(); i++) {
+                        simd::axpy(block.label(i), block.row(i), partial.xty.data(), numFeatures);
+                        partial.xty[numFeatures] += block.label(i);
+                    }
+                });
+
+                return partial;
+            },
+            [](NormalEquationTerms &result, const NormalEquationTerms &partial) {
+                result.gram += partial.gram;
+                simd::add(result.xty.data(), partial.xty.data(), result.xty.data(),
+                          result.xty.size());
+            });
+
+        for (size_t i = 0; i < numFeatures; i++)
+            terms.gram(i, i) += costFunction.regularizationFactor();
+
+        if (!choleskyDecompose(terms.gram, m_hyperParameters.minPivotRatio))
+            return false;
+
+        choleskySolve(terms.gram, terms.xty.data());
+        std::copy(terms.xty.begin(), terms.xty.end(), parameters);
+
+        return true;
+    }
+
+    template <typename TCostFunction>
+    bool solveQR(const TCostFunction &costFunction, const size_t numFeatures,
+                 double *parameters) const {
+        const size_t n = numFeatures + 1;
+
+        GivensLeastSquares leastSquares(n);
+        AlignedVector<double> row(n, 0.0);
+
+        costFunction.forEachBlock([&](const auto &block) {
+            for (size_t i = 0; i < block.size(); i++) {
+                std::copy(block.row(i), block.row(i) + numFeatures, row.begin());
+                row[numFeatures] = 1.0;
+                leastSquares.addRow(row.data(), block.label(i));
+            }
+        });
+
+        const double penalty = std::sqrt(costFunction.regularizationFactor());
+        for (size_t i = 0; i < numFeatures; i++) {
+            std::fill(row.begin(), row.end(), 0.0);
+            row[i] = penalty;
+            leastSquares.addRow(row.data(), 0.0);
+        }
+
+        return leastSquares.solve(parameters);
+    }
+
+  private:
+    HyperParameters m_hyperParameters;
+};
+} // namespace ml
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ml {
+
+/**
+ * State of an optimizer at the end of an iteration.
+ */
+struct IterationInfo {
+    size_t iteration;             // 1 for the first iteration
+    double value;                 // at the end of the iteration
+    double gradientNorm;          // at the arguments the iteration started from
+    double stepSize;              // length of the step taken, 0 if rejected
+    size_t lineSearchEvaluations; // function evaluations of the line search
+};
+
+/**
+ * Observers are the compile-time policy through which optimizers report their progress. An
+ * observer provides a static constexpr bool Enabled; when it is false, as for NullObserver, the
+ * optimizer makes no call to it and evaluates the function directly, so the instrumented code
+ * compiles to the same code as before. Enabled observers provide:
+ *
+ *   void onEval(double seconds);      // after every eval()
+ *   void onGradient(double seconds);  // after every gradient(), valueAndGradient(), hessian(),
+ *                                     // batchGradient() or sparseStep()
+ *   bool onIteration(const IterationInfo &info); // false stops the optimizer
+ */
+struct NullObserver {
+    static constexpr bool Enabled = false;
+
+    void onEval(double) {}
+
+    void onGradient(double) {}
+
+    bool onIteration(const IterationInfo &) { return true; }
+};
+
+/**
+ * Trace of a run: one entry per iteration, and the number and wall time of evaluations of the
+ * function and of its derivatives.
+ */
+struct OptimizationStats {
+    std::vector<IterationInfo> iterations;
+    size_t numEvals = 0;
+    size_t numGradients = 0;
+    double evalSeconds = 0.0;
+    double gradientSeconds = 0.0;
+    bool stoppedEarly = false;
+};
+
+/**
+ * Observer that records OptimizationStats, and stops the optimizer early when callback returns
+ * false. One StatsObserver accumulates the stats of every run it observes.
+ */
+class StatsObserver {
+  public:
+    static constexpr bool Enabled = true;
+
+    StatsObserver() = default;
+
+    explicit StatsObserver(std::function<bool(const IterationInfo &)> callback)
+        : m_callback(std::move(callback)) {}
+
+    void onEval(const double seconds) {
+        m_stats.numEvals++;
+        m_stats.evalSeconds += seconds;
+    }
+
+    void onGradient(const double seconds) {
+        m_stats.numGradients++;
+        m_stats.gradientSeconds += seconds;
+    }
+
+    bool onIteration(const IterationInfo &info) {
+        m_stats.iterations.push_back(info);
+        if (m_callback && !m_callback(info)) {
+            m_stats.stoppedEarly = true;
+            return false;
+        }
+        return true;
+    }
+
+    const OptimizationStats &stats() const { return m_stats; }
+
+  private:
+    std::function<bool(const IterationInfo &)> m_callback;
+    OptimizationStats m_stats;
+};
+
+/**
+ * Differentiable function that forwards to function and reports the wall time of every call to
+ * observer. Members that function does not provide are not provided either, so that optimizers
+ * detect the same capabilities.
+ */
+template <typename TFunction, typename TObserver> class ObservedFunction {
+  public:
+    using argument_type = typename TFunction::argument_type;
+    using gradient_type = typename TFunction::gradient_type;
+
+    ObservedFunction(const TFunction &function, TObserver &observer)
+        : m_function(&function), m_observer(&observer) {}
+
+    double eval(const argument_type &x) const {
+        return timed([&] { return m_function->eval(x); }, &TObserver::onEval);
+    }
+
+    gradient_type gradient(const argument_type &x) const {
+        return timed([&] { return m_function->gradient(x); }, &TObserver::onGradient);
+    }
+
+    template <typename F = TFunction>
+    auto valueAndGradient(const argument_type &x) const
+        -> decltype(std::declval<const F &>().valueAndGradient(x)) {
+        return timed([&] { return m_function->valueAndGradient(x); }, &TObserver::onGradient);
+    }
+
+    template <typename F = TFunction>
+    auto hessian(const argument_type &x) const -> decltype(std::declval<const F &>().hessian(x)) {
+        return timed([&] { return m_function->hessian(x); }, &TObserver::onGradient);
+    }
+
+    template <typename F = TFunction>
+    auto numExamples() const -> decltype(std::declval<const F &>().numExamples()) {
+        return m_function->numExamples();
+    }
+
+    template <typename F = TFunction>
+    auto chunkSize() const -> decltype(std::declval<const F &>().chunkSize()) {
+        return m_function->chunkSize();
+    }
+
+    template <typename F = TFunction>
+    auto batchGradient(const argument_type &x, const size_t *batch, const size_t batchSize) const
+        -> decltype(std::declval<const F &>().batchGradient(x, batch, batchSize)) {
+        return timed([&] { return m_function->batchGradient(x, batch, batchSize); },
+                     &TObserver::onGradient);
+    }
+
+    template <typename F = TFunction>
+    auto sparseStep(argument_type &arguments, double &weightScale, const size_t *batch,
+                    const size_t batchSize, const double learningRate) const
+        -> decltype(std::declval<const F &>().sparseStep(arguments, weightScale, batch,
+                                                          batchSize, learningRate)) {
+        const auto step = [&] {
+            m_function->sparseStep(arguments, weightScale, batch, batchSize, learningRate);
+        };
+        timed(step, &TObserver::onGradient);
+    }
+
+    template <typename F = TFunction>
+    auto applyWeightScale(argument_type &arguments, double &weightScale) const
+        -> decltype(std::declval<const F &>().applyWeightScale(arguments, weightScale)) {
+        m_function->applyWeightScale(arguments, weightScale);
+    }
+
+  private:
+    template <typename TCall>
+    auto timed(TCall &&call, void (TObserver::*report)(double)) const {
+        const auto start = std::chrono::steady_clock::now();
+        const auto reportElapsed = [&] {
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            (m_observer->*report)(elapsed.count());
+        };
+
+        if constexpr (std::is_void_v<decltype(call())>) {
+            call();
+            reportElapsed();
+        } else {
+            auto result = call();
+            reportElapsed();
+            return result;
+        }
+    }
+
+    const TFunction *m_function;
+    TObserver *m_observer;
+};
+
+/**
+ * function itself when observer is disabled, otherwise function wrapped to report its calls.
+ */
+template <typename TFunction, typename TObserver>
+decltype(auto) observe(const TFunction &function, TObserver &observer) {
+    if constexpr (TObserver::Enabled)
+        return ObservedFunction<TFunction, TObserver>(function, observer);
+    else
+        return (function);
+}
+
+/**
+ * Detects optimizers that take an observer as third argument of optimize().
+ */
+template <typename TOptimizer, typename TFunction, typename TObserver, typename = void>
+struct AcceptsObserver : std::false_type {};
+
+template <typename TOptimizer, typename TFunction, typename TObserver>
+struct AcceptsObserver<TOptimizer, TFunction, TObserver,
+                       std::void_t<decltype(std::declval<const TOptimizer &>().optimize(
+                           std::declval<const TFunction &>(),
+                           std::declval<const typename TFunction::argument_type &>(),
+                           std::declval<TObserver &>()))>> : std::true_type {};
+
+/**
+ * Optimizer that runs optimizer with observer, for callers that take any optimizer, such as
+ * Regression::fit(). optimizer must take an observer: GradientDescent, StochasticGradientDescent,
+ * LBFGS and NewtonMethod do; the direct solvers, CoordinateDescent and NormalEquation, do not.
+ * observer must outlive the returned object.
+ */
+template <typename TOptimizer, typename TObserver> class ObservedOptimizer {
+  public:
+    ObservedOptimizer(TOptimizer optimizer, TObserver &observer)
+        : m_optimizer(std::move(optimizer)), m_observer(&observer) {}
+
+    template <typename TDifferentiableFunction>
+    auto optimize(const TDifferentiableFunction &function,
+                  const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        static_assert(AcceptsObserver<TOptimizer, TDifferentiableFunction, TObserver>::value,
+                      "only GradientDescent, StochasticGradientDescent, LBFGS and NewtonMethod "
+                      "take an observer");
+        return m_optimizer.optimize(function, initialArguments, *m_observer);
+    }
+
+  private:
+    TOptimizer m_optimizer;
+    TObserver *m_observer;
+};
+
+template <typename TOptimizer, typename TObserver>
+ObservedOptimizer<TOptimizer, TObserver> observed(TOptimizer optimizer, TObserver &observer) {
+    return {std::move(optimizer), observer};
+}
+} // namespace ml
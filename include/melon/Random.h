@@ -1,29 +1,279 @@
 #pragma once
 
+#include <melon/AlignedAllocator.h>
 #include <melon/Types.h>
 
-#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
 
 namespace ml {
+
+/**
+ * xoshiro256++ (Blackman and Vigna): 256 bits of state, period 2^256 - 1. jump() advances the
+ * generator by 2^128 steps and longJump() by 2^192, so generators derived from a single seed by
+ * jumps produce non-overlapping sequences.
+ */
+class Xoshiro256 {
+  public:
+    using result_type = uint64_t;
+
+    /**
+     * Generator whose state is expanded from seed by splitmix64, so that similar seeds give
+     * unrelated states.
+     */
+    explicit Xoshiro256(uint64_t seed) {
+        for (auto &word : m_state) {
+            seed += 0x9e3779b97f4a7c15;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+            z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    /**
+     * Generator with the given state, which must not be all zeros.
+     */
+    Xoshiro256(const uint64_t s0, const uint64_t s1, const uint64_t s2, const uint64_t s3)
+        : m_state{s0, s1, s2, s3} {}
+
+    static constexpr result_type min() { return 0; }
+
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()() { return step(m_state[0], m_state[1], m_state[2], m_state[3]); }
+
+    void jump() {
+        constexpr uint64_t Polynomial[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c,
+                                           0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+        jump(Polynomial);
+    }
+
+    void longJump() {
+        constexpr uint64_t Polynomial[] = {0x76e15d3efefdcbbf, 0xc5004e441c522fb3,
+                                           0x77710069854ee241, 0x39109bb02acbe635};
+        jump(Polynomial);
+    }
+
+    const uint64_t *state() const { return m_state; }
+
+    /**
+     * Output of the state s0..s3, which is advanced by one step.
+     */
+    static uint64_t step(uint64_t &s0, uint64_t &s1, uint64_t &s2, uint64_t &s3) {
+        const uint64_t result = rotl(s0 + s3, 23) + s0;
+        const uint64_t t = s1 << 17;
+        s2 ^= s0;
+        s3 ^= s1;
+        s1 ^= s2;
+        s0 ^= s3;
+        s2 ^= t;
+        s3 = rotl(s3, 45);
+        return result;
+    }
+
+  private:
+    static uint64_t rotl(const uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+    void jump(const uint64_t (&polynomial)[4]) {
+        uint64_t jumped[4] = {0, 0, 0, 0};
+        for (const uint64_t word : polynomial)
+            for (int b = 0; b < 64; b++) {
+                if (word & (uint64_t{1} << b))
+                    for (size_t i = 0; i < 4; i++)
+                        jumped[i] ^= m_state[i];
+                (*this)();
+            }
+
+        std::copy(jumped, jumped + 4, m_state);
+    }
+
+    uint64_t m_state[4];
+};
+
+/**
+ * Random numbers from Lanes interleaved xoshiro256++ generators, lane l being the generator of
+ * the seed jumped l times, stepped together so that bulk generation vectorizes. Value t of the
+ * sequence comes from lane t % Lanes, whether it is drawn alone or by a bulk fill, so the
+ * sequence only depends on the seed and the stream.
+ *
+ * Random is not thread-safe: parallel tasks each use their own stream. Streams of a seed are
+ * 2^192 steps apart and never overlap, and the same seed and stream always give the same
+ * sequence, whatever the number of threads. Random is also a uniform random bit generator for
+ * the algorithms of the standard library.
+ */
 class Random {
   public:
+    using result_type = uint64_t;
+
+    static constexpr size_t Lanes = 8;
+
+    static constexpr uint64_t DefaultSeed = 5489u;
+
+    /**
+     * Stream number stream of the generator of seed.
+     */
+    explicit Random(const uint64_t seed = DefaultSeed, const uint64_t stream = 0) {
+        Xoshiro256 generator(seed);
+        for (uint64_t s = 0; s < stream; s++)
+            generator.longJump();
+
+        for (size_t l = 0; l < Lanes; l++) {
+            for (size_t i = 0; i < 4; i++)
+                m_state[i][l] = generator.state()[i];
+            generator.jump();
+        }
+    }
+
+    static constexpr result_type min() { return Xoshiro256::min(); }
+
+    static constexpr result_type max() { return Xoshiro256::max(); }
+
+    result_type operator()() {
+        if (m_next == Lanes) {
+            step(m_buffer);
+            m_next = 0;
+        }
+        return m_buffer[m_next++];
+    }
+
+    /**
+     * Uniformly distributed value in [0, 1).
+     */
+    double uniform() { return toUnit((*this)()); }
+
+    /**
+     * Write n values uniformly distributed in [min(lo, hi), max(lo, hi)) to out.
+     */
+    void uniform(double *out, const size_t n, const double lo, const double hi) {
+        const double offset = std::min(lo, hi), range = std::max(lo, hi) - offset;
+        fill(out, n, [=](const uint64_t bits) { return offset + range * toUnit(bits); });
+    }
+
     template <typename OutputT> OutputT uniform(const double lo, const double hi) {
-        std::uniform_real_distribution<double> uniformDistribution(std::min(lo, hi),
-                                                                   std::max(lo, hi));
         OutputT v;
-        for (auto &elem : v) {
-            elem = uniformDistribution(m_generator);
-        }
+        uniform(v.data(), v.size(), lo, hi);
+        return v;
+    }
 
+    /**
+     * Vector of size uniformly distributed values, for vectors whose size is not fixed by their
+     * type.
+     */
+    template <typename OutputT>
+    OutputT uniform(const size_t size, const double lo, const double hi) {
+        auto v = zeros<OutputT>(size);
+        uniform(v.data(), v.size(), lo, hi);
         return v;
     }
 
+    /**
+     * Write n normally distributed values to out, by the Box-Muller transform of pairs of
+     * uniform values. An odd n discards the second value of the last pair.
+     */
+    void normal(double *out, const size_t n, const double mean, const double stddev) {
+        const size_t even = n - n % 2;
+        uniform(out, even, 0.0, 1.0);
+        for (size_t i = 0; i < even; i += 2) {
+            const auto [a, b] = boxMuller(out[i], out[i + 1]);
+            out[i] = mean + stddev * a;
+            out[i + 1] = mean + stddev * b;
+        }
+
+        if (even < n)
+            out[even] = normal(mean, stddev);
+    }
+
     double normal(const double mean, const double stddev) {
-        std::normal_distribution<double> normalDistribution(mean, stddev);
-        return normalDistribution(m_generator);
+        const double u = uniform();
+        return mean + stddev * boxMuller(u, uniform()).first;
+    }
+
+    /**
+     * Uniformly distributed index in [0, bound), by the multiply-shift of a 64-bit value, whose
+     * bias is below bound / 2^64.
+     */
+    size_t index(const size_t bound) { return toIndex((*this)(), bound); }
+
+    /**
+     * Write n indices uniformly distributed in [0, bound) to out, for instance the example
+     * indices of a bootstrap sample when n and bound are both the number of examples.
+     */
+    void indices(size_t *out, const size_t n, const size_t bound) {
+        fill(out, n, [=](const uint64_t bits) { return toIndex(bits, bound); });
+    }
+
+    /**
+     * Uniformly random permutation of [first, last), by Fisher-Yates shuffle.
+     */
+    template <typename TIterator> void shuffle(TIterator first, TIterator last) {
+        const size_t n = static_cast<size_t>(last - first);
+        for (size_t i = n; i > 1; i--)
+            std::iter_swap(first + (i - 1), first + index(i));
     }
 
   private:
-    std::mt19937 m_generator;
+    static double toUnit(const uint64_t bits) {
+        return static_cast<double>(bits >> 11) * 0x1.0p-53;
+    }
+
+    static size_t toIndex(const uint64_t bits, const size_t bound) {
+#ifdef __SIZEOF_INT128__
+        return static_cast<size_t>((static_cast<unsigned __int128>(bits) * bound) >> 64);
+#else
+        return static_cast<size_t>(bits % bound);
+#endif
+    }
+
+    /**
+     * Box-Muller transform of two uniform values in [0, 1) into two independent standard
+     * normal values.
+     */
+    static std::pair<double, double> boxMuller(const double u, const double v) {
+        constexpr double TwoPi = 6.283185307179586476925286766559;
+        const double radius = std::sqrt(-2.0 * std::log(1.0 - u));
+        return {radius * std::cos(TwoPi * v), radius * std::sin(TwoPi * v)};
+    }
+
+    /**
+     * Write the next output of every lane to out and advance them.
+     */
+    void step(uint64_t *out) {
+        for (size_t l = 0; l < Lanes; l++)
+            out[l] = Xoshiro256::step(m_state[0][l], m_state[1][l], m_state[2][l], m_state[3][l]);
+    }
+
+    /**
+     * out[i] = transform(value i of the sequence) for i in [0, n). Buffered values are used
+     * first, then all lanes write a block of values at once, and the values of the last block
+     * that are not needed are buffered.
+     */
+    template <typename T, typename TTransform>
+    void fill(T *out, const size_t n, TTransform &&transform) {
+        size_t i = 0;
+        for (; i < n && m_next < Lanes; i++)
+            out[i] = transform(m_buffer[m_next++]);
+
+        alignas(CacheLineSize) uint64_t block[Lanes];
+        for (; i + Lanes <= n; i += Lanes) {
+            step(block);
+            for (size_t l = 0; l < Lanes; l++)
+                out[i + l] = transform(block[l]);
+        }
+
+        if (i < n) {
+            step(m_buffer);
+            m_next = n - i;
+            for (size_t l = 0; l < m_next; l++)
+                out[i + l] = transform(m_buffer[l]);
+        }
+    }
+
+    alignas(CacheLineSize) uint64_t m_state[4][Lanes];
+    alignas(CacheLineSize) uint64_t m_buffer[Lanes];
+    size_t m_next = Lanes;
 };
-} // namespace ml
\ No newline at end of file
+} // namespace ml
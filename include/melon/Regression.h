@@ -1,54 +1,463 @@
 #pragma once
 
+#include <melon/BinaryDataset.h>
+#include <melon/Dataset.h>
+#include <melon/DifferentiableFunction.h>
+#include <melon/FeatureExpansion.h>
+#include <melon/FeatureStatistics.h>
 #include <melon/GradientDescent.h>
+#include <melon/LinearAlgebra.h>
 #include <melon/LinearModel.h>
 #include <melon/Random.h>
-
+#include <melon/Simd.h>
+#include <melon/StochasticGradientDescent.h>
+#include <melon/ThreadPool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <stdexcept>
+#include <string>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace ml {
 
-template <typename TModel> class CostFunction {
+/**
+ * Regularized cost of a model over examples whose features are stored as TScalar. Parameters,
+ * predictions and all sums are double whatever the storage type.
+ */
+template <typename TModel, typename TScalar = double> class CostFunction {
   public:
     using model_type = TModel;
+    using scalar_type = TScalar;
     using argument_type = typename model_type::parameters_type;
     using gradient_type = argument_type;
+    using features_type = typename model_type::argument_type;
     using training_set_type = TrainingSet<model_type::ArgumentDim>;
+    using dataset_type = Dataset<model_type::ArgumentDim, TScalar>;
+    using dataset_view_type = DatasetView<model_type::ArgumentDim, TScalar>;
+    using source_type = ChunkedDatasetSource<model_type::ArgumentDim, TScalar>;
+
+    /**
+     * Cost over a copy of trainingSet converted to the columnar layout.
+     */
+    CostFunction(const training_set_type &trainingSet)
+        : m_regularizationFactor{1E-6},
+          m_storage(std::make_shared<const dataset_type>(trainingSet)),
+          m_dataset(m_storage->view()) {}
+
+    /**
+     * Cost over dataset, which must outlive the cost function.
+     */
+    CostFunction(const dataset_view_type &dataset)
+        : m_regularizationFactor{1E-6}, m_dataset(dataset) {}
+
+    /**
+     * Cost over the examples of source, read one chunk at a time.
+     */
+    CostFunction(std::shared_ptr<const source_type> source)
+        : m_regularizationFactor{1E-6}, m_source(std::move(source)) {}
+
+    /**
+     * In-memory examples, empty when the cost function reads from a chunked source.
+     */
+    const dataset_view_type &dataset() const { return m_dataset; }
+
+    /**
+     * Evaluate cost and gradient on shards of the dataset in parallel on threadPool. Partial
+     * sums are reduced in a fixed order, so results are reproducible for a given pool size.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+    }
+
+    ThreadPool *threadPool() const { return m_threadPool.get(); }
+
+    /**
+     * Evaluate on features (x - means) / sdevs instead of x, without modifying the examples:
+     * blocks of examples are scaled into a small buffer as they are read.
+     */
+    void setFeatureScaling(const features_type &means, const features_type &sdevs) {
+        m_means = means;
+        m_sdevs = sdevs;
+        m_scaled = true;
+    }
+
+    /**
+     * Evaluate on the features of expansion, computed from the raw features of the examples
+     * as blocks of them are read, for models of runtime dimension over expansion.numOutputs()
+     * features. The feature scaling then applies to the expanded features.
+     */
+    void setFeatureExpansion(std::shared_ptr<const FeatureExpansion> expansion) {
+        assert(!expansion || model_type::ArgumentDim == Dynamic);
+        m_expansion = std::move(expansion);
+    }
+
+    const FeatureExpansion *featureExpansion() const { return m_expansion.get(); }
+
+    /**
+     * Weight of the L2 penalty 0.5 * regularizationFactor * |w|^2 on the non-bias parameters.
+     */
+    double regularizationFactor() const { return m_regularizationFactor; }
+
+    void setRegularizationFactor(const double regularizationFactor) {
+        m_regularizationFactor = regularizationFactor;
+    }
+
+    /**
+     * Weight of the L1 penalty l1RegularizationFactor * |w|_1 on the non-bias parameters, zero
+     * by default. Together with regularizationFactor() it makes an elastic-net penalty. The
+     * penalty is not differentiable at zero: gradients use the subgradient that is zero there,
+     * and CoordinateDescent minimizes it exactly.
+     */
+    double l1RegularizationFactor() const { return m_l1RegularizationFactor; }
+
+    void setL1RegularizationFactor(const double l1RegularizationFactor) {
+        m_l1RegularizationFactor = l1RegularizationFactor;
+    }
 
-    CostFunction(const training_set_type &trainingSet) : m_regularizationFactor{1E-6},
-        m_trainingSet(trainingSet) {}
+    /**
+     * Restrict the cost to the examples of the in-memory dataset at indices, for instance the
+     * training folds of a cross-validation. Example i of the cost is then row indices[i] of the
+     * dataset; blocks of selected rows are gathered into a small buffer as they are read.
+     */
+    void selectExamples(std::shared_ptr<const std::vector<size_t>> indices) {
+        assert(!m_source);
+        m_indices = std::move(indices);
+    }
+
+    size_t numExamples() const {
+        return m_indices ? m_indices->size() : m_source ? m_source->size() : m_dataset.size();
+    }
+
+    /**
+     * Number of consecutive examples read together. Batches passed to batchGradient() must not
+     * span two chunks.
+     */
+    size_t chunkSize() const { return m_source ? m_source->chunkSize() : numExamples(); }
 
-    gradient_type gradient(const argument_type &input) const {
-        const double numExamples = static_cast<double>(m_trainingSet.size());
+    /**
+     * Unbiased estimate of the gradient from the batchSize examples indexed by batch, for
+     * stochastic optimizers. Every index of batch must lie in the chunk of batch[0], which
+     * StochasticGradientDescent guarantees by drawing batches within chunks.
+     */
+    gradient_type batchGradient(const argument_type &input, const size_t *batch,
+                                const size_t batchSize) const {
         const model_type model(input);
-        gradient_type grad;
+        const size_t numFeatures = input.size() - 1;
+        auto grad = zeros<gradient_type>(input.size());
+
+        const size_t chunk = batchSize > 0 && m_source ? batch[0] / m_source->chunkSize() : 0;
+        const size_t offset = chunk * chunkSize();
+        const dataset_view_type dataset = m_source ? m_source->chunk(chunk) : m_dataset;
+        [[maybe_unused]] const size_t chunkExamples =
+            m_indices ? m_indices->size() : dataset.size();
+        AlignedVector<double> scaled(m_scaled || m_expansion ? numFeatures : 0);
+
+        const auto accumulate = [&](const auto *x, const double y) {
+            const double diff = model.eval(x) - y;
+            simd::axpy(diff, x, grad.data(), numFeatures);
+            grad[numFeatures] += diff;
+        };
+
+        for (size_t k = 0; k < batchSize; k++) {
+            assert(batch[k] >= offset && batch[k] - offset < chunkExamples);
+            const size_t i = exampleRow(batch[k] - offset);
+            if (m_scaled || m_expansion)
+                accumulate(modelFeatures(dataset.row(i), scaled.data(), numFeatures),
+                           dataset.label(i));
+            else
+                accumulate(dataset.row(i), dataset.label(i));
+        }
+
+        grad /= static_cast<double>(batchSize);
+
+        const double regularizationScale =
+            m_regularizationFactor / static_cast<double>(numExamples());
+        for (size_t i = 0; i < numFeatures; i++)
+            grad[i] += regularizationScale * input[i];
+        addL1Subgradient(input.data(), grad.data(), numFeatures,
+                         1.0 / static_cast<double>(numExamples()));
+
+        return grad;
+    }
 
-        for (size_t i = 0; i < grad.size(); i++) {
-            double sum = 0.0;
+    /**
+     * Reduce map(dataset, begin, end) over all examples, where dataset holds the examples in
+     * memory and [begin, end) is a shard of its rows, or of the selected examples. Shards of a
+     * chunk are mapped in parallel on the thread pool; partial results are folded with
+     * combine(result, partial) in shard and chunk order.
+     */
+    template <typename TMap, typename TCombine>
+    auto reduceExamples(TMap &&map, TCombine &&combine) const {
+        const auto reduceChunk = [&](const dataset_view_type &dataset) {
+            return shardedReduce(
+                m_threadPool.get(), m_indices ? m_indices->size() : dataset.size(), MinShardSize,
+                [&](const size_t begin, const size_t end) { return map(dataset, begin, end); },
+                combine);
+        };
+
+        if (!m_source)
+            return reduceChunk(m_dataset);
+
+        auto result = reduceChunk(m_source->chunk(0));
+        for (size_t i = 1; i < m_source->numChunks(); i++)
+            combine(result, reduceChunk(m_source->chunk(i)));
+
+        return result;
+    }
+
+    /**
+     * Call f(block) on consecutive blocks of at most BlockSize of the examples [begin, end) of
+     * dataset, or of the selected examples, with the feature scaling applied. Blocks are views
+     * of dataset when the rows are used as stored, and DatasetView<dim> views of a double
+     * buffer when they are expanded, scaled or gathered, so f must accept both.
+     */
+    template <typename TFunction>
+    void forEachBlock(const dataset_view_type &dataset, const size_t begin, const size_t end,
+                      TFunction &&f) const {
+        const bool transformed = m_scaled || m_expansion;
+        const bool buffered = transformed || m_indices;
+        const size_t numFeatures = m_expansion ? m_expansion->numOutputs() : dataset.numFeatures();
+        const size_t stride = paddedSize<double>(numFeatures);
+        AlignedVector<double> scaled(buffered ? BlockSize * stride : 0, 0.0);
+        double labels[BlockSize];
+
+        for (size_t j = begin; j < end; j += BlockSize) {
+            const size_t n = std::min(BlockSize, end - j);
+            if (!buffered) {
+                f(dataset.slice(j, j + n));
+                continue;
+            }
 
-            for (size_t j = 0; j < m_trainingSet.size(); j++) {
-                const auto &[x, y] = m_trainingSet[j];
-                const double diff = (model.eval(x) - y);
-                if (i < grad.size() - 1)
-                    sum += diff * x[i];
+            for (size_t k = 0; k < n; k++) {
+                const size_t i = exampleRow(j + k);
+                double *out = scaled.data() + k * stride;
+                if (transformed)
+                    modelFeatures(dataset.row(i), out, numFeatures);
                 else
-                    sum += diff;
+                    std::copy(dataset.row(i), dataset.row(i) + numFeatures, out);
+                labels[k] = dataset.label(i);
             }
+            f(DatasetView<model_type::ArgumentDim>(scaled.data(), labels, n, stride, numFeatures));
+        }
+    }
 
-            if (i < grad.size() - 1)
-                sum += m_regularizationFactor * input[i];
+    /**
+     * Call f(block) on consecutive blocks of all examples in order.
+     */
+    template <typename TFunction> void forEachBlock(TFunction &&f) const {
+        if (!m_source) {
+            forEachBlock(m_dataset, 0, numExamples(), f);
+            return;
+        }
 
-            grad[i] = sum / numExamples;
+        for (size_t i = 0; i < m_source->numChunks(); i++) {
+            const dataset_view_type chunk = m_source->chunk(i);
+            forEachBlock(chunk, 0, chunk.size(), f);
         }
+    }
 
-        return grad;
+    /**
+     * Number of examples evaluated by a single batched model evaluation.
+     */
+    static constexpr size_t BlockSize = 64;
+
+  protected:
+    /**
+     * Minimum number of examples per shard in parallel evaluation.
+     */
+    static constexpr size_t MinShardSize = 1024;
+
+    /**
+     * Regularized cost, where loss(scores, labels, losses, residuals, n) writes the loss of n
+     * examples and its derivative with respect to their linear scores w . x + b. Losses work
+     * on the scores rather than on the predictions so that they can be computed in a stable
+     * form.
+     */
+    template <typename TLoss> double evalLoss(const argument_type &input, TLoss &&loss) const {
+        const LinearModel<model_type::ArgumentDim> linearModel(input);
+
+        const double cost = reduceExamples(
+            [&](const dataset_view_type &dataset, const size_t begin, const size_t end) {
+                double scores[BlockSize], losses[BlockSize], residuals[BlockSize];
+                double partialCost = 0.0;
+                forEachBlock(dataset, begin, end, [&](const auto &block) {
+                    linearModel.evalBatch(block.row(0), block.size(), block.stride(), scores);
+                    loss(scores, block.labels(), losses, residuals, block.size());
+                    for (size_t k = 0; k < block.size(); k++)
+                        partialCost += losses[k];
+                });
+                return partialCost;
+            },
+            [](double &cost, const double partialCost) { cost += partialCost; });
+
+        const double numExamples = static_cast<double>(this->numExamples());
+        return (cost + regularizationTerm(input)) / numExamples;
+    }
+
+    /**
+     * Regularized cost and its gradient in a single sweep over the training set, with loss as
+     * in evalLoss(). The linear score of every example is computed once and shared by both.
+     */
+    template <typename TLoss>
+    ValueAndGradient<gradient_type> evalLossWithGradient(const argument_type &input,
+                                                         TLoss &&loss) const {
+        const LinearModel<model_type::ArgumentDim> linearModel(input);
+        const size_t numFeatures = input.size() - 1;
+
+        auto [cost, grad] = reduceExamples(
+            [&](const dataset_view_type &dataset, const size_t begin, const size_t end) {
+                ValueAndGradient<gradient_type> partial{0.0, zeros<gradient_type>(input.size())};
+                double scores[BlockSize], losses[BlockSize], residuals[BlockSize];
+                forEachBlock(dataset, begin, end, [&](const auto &block) {
+                    linearModel.evalBatch(block.row(0), block.size(), block.stride(), scores);
+                    loss(scores, block.labels(), losses, residuals, block.size());
+
+                    for (size_t k = 0; k < block.size(); k++) {
+                        partial.value += losses[k];
+                        simd::axpy(residuals[k], block.row(k), partial.gradient.data(),
+                                   numFeatures);
+                        partial.gradient[numFeatures] += residuals[k];
+                    }
+                });
+                return partial;
+            },
+            [](ValueAndGradient<gradient_type> &result,
+               const ValueAndGradient<gradient_type> &partial) {
+                result.value += partial.value;
+                result.gradient += partial.gradient;
+            });
+
+        for (size_t i = 0; i < numFeatures; i++)
+            grad[i] += m_regularizationFactor * input[i];
+        addL1Subgradient(input.data(), grad.data(), numFeatures);
+
+        const double numExamples = static_cast<double>(this->numExamples());
+        grad /= numExamples;
+
+        return {(cost + regularizationTerm(input)) / numExamples, grad};
+    }
+
+    /**
+     * Hessian of the regularized cost, for losses whose second derivative with respect to the
+     * linear score is weight(prediction). Only the lower triangle is filled.
+     */
+    template <typename TWeight>
+    SquareMatrix evalHessian(const argument_type &input, TWeight &&weight) const {
+        const model_type model(input);
+        const size_t numFeatures = input.size() - 1;
+
+        auto hessian = reduceExamples(
+            [&](const dataset_view_type &dataset, const size_t begin, const size_t end) {
+                SquareMatrix partial(input.size());
+                double weights[BlockSize];
+                forEachBlock(dataset, begin, end, [&](const auto &block) {
+                    model.evalBatch(block.row(0), block.size(), block.stride(), weights);
+                    for (size_t k = 0; k < block.size(); k++)
+                        weights[k] = weight(weights[k]);
+
+                    addWeightedGram(block.row(0), block.size(), block.stride(), numFeatures,
+                                    weights, partial);
+                });
+                return partial;
+            },
+            [](SquareMatrix &result, const SquareMatrix &partial) { result += partial; });
+
+        for (size_t i = 0; i < numFeatures; i++)
+            hessian(i, i) += m_regularizationFactor;
+
+        hessian *= 1.0 / static_cast<double>(numExamples());
+        return hessian;
+    }
+
+    /**
+     * Elastic-net penalty on the weights, the bias term is not regularized.
+     */
+    double regularizationTerm(const argument_type &input) const {
+        double sum = 0.0;
+        for (size_t i = 0; i < input.size() - 1; i++)
+            sum += (input[i] * input[i]);
+
+        return 0.5 * m_regularizationFactor * sum + l1Term(input.data(), input.size() - 1);
+    }
+
+    /**
+     * L1 penalty on the n weights w.
+     */
+    double l1Term(const double *w, const size_t n) const {
+        if (m_l1RegularizationFactor == 0.0)
+            return 0.0;
+
+        double sum = 0.0;
+        for (size_t i = 0; i < n; i++)
+            sum += std::fabs(w[i]);
+        return m_l1RegularizationFactor * sum;
+    }
+
+    /**
+     * grad[i] += scale * l1RegularizationFactor * sign(w[i]) for the n weights w.
+     */
+    void addL1Subgradient(const double *w, double *grad, const size_t n,
+                          const double scale = 1.0) const {
+        if (m_l1RegularizationFactor == 0.0)
+            return;
+
+        const double l1 = scale * m_l1RegularizationFactor;
+        for (size_t i = 0; i < n; i++)
+            grad[i] += w[i] > 0.0 ? l1 : w[i] < 0.0 ? -l1 : 0.0;
+    }
+
+  protected:
+    /**
+     * Row of the in-memory dataset holding example i.
+     */
+    size_t exampleRow(const size_t i) const { return m_indices ? (*m_indices)[i] : i; }
+
+    /**
+     * Write the n scaled features of x to out.
+     */
+    const double *scale(const TScalar *x, double *out, const size_t n) const {
+        if constexpr (std::is_same_v<TScalar, double>) {
+            simd::sub(x, m_means.data(), out, n);
+        } else {
+            simd::convert(x, out, n);
+            simd::sub(out, m_means.data(), out, n);
+        }
+        simd::div(out, m_sdevs.data(), out, n);
+        return out;
+    }
+
+    /**
+     * Write the numFeatures features the model is evaluated on to out: the expansion of the
+     * raw features x, scaled if feature scaling is set, or the scaled features x.
+     */
+    const double *modelFeatures(const TScalar *x, double *out, const size_t numFeatures) const {
+        if (!m_expansion)
+            return scale(x, out, numFeatures);
+
+        m_expansion->expand(x, out);
+        if (m_scaled) {
+            simd::sub(out, m_means.data(), out, numFeatures);
+            simd::div(out, m_sdevs.data(), out, numFeatures);
+        }
+        return out;
     }
 
   protected:
     double m_regularizationFactor;
-    const training_set_type &m_trainingSet;
+    double m_l1RegularizationFactor{0.0};
+    std::shared_ptr<const dataset_type> m_storage;
+    dataset_view_type m_dataset;
+    std::shared_ptr<const source_type> m_source;
+    std::shared_ptr<const std::vector<size_t>> m_indices;
+    std::shared_ptr<ThreadPool> m_threadPool;
+    std::shared_ptr<const FeatureExpansion> m_expansion;
+    bool m_scaled{false};
+    features_type m_means{}, m_sdevs{};
 };
 
 /**
@@ -61,84 +470,484 @@ template <typename TModel, typename TCostFunction> class Regression {
 
     using model_type = TModel;
     using cost_function_type = TCostFunction;
+    using scalar_type = typename cost_function_type::scalar_type;
     using argument_type = typename model_type::argument_type;
     using parameters_type = typename model_type::parameters_type;
     using training_set_type = TrainingSet<ArgumentDim>;
+    using dataset_type = Dataset<ArgumentDim, scalar_type>;
+    using dataset_view_type = DatasetView<ArgumentDim, scalar_type>;
+    using source_type = ChunkedDatasetSource<ArgumentDim, scalar_type>;
 
     static_assert(std::is_same<typename cost_function_type::argument_type, parameters_type>::value);
 
     virtual ~Regression() = default;
 
-    void fit(const training_set_type &trainingSet) {
-        const training_set_type &adjustedTrainingSet = adjustTrainingSet(trainingSet);
-        GradientDescent gradientDescent;
-        const auto &costFunction = getCostFunction(adjustedTrainingSet);
-        const auto initialParameters = Random().uniform<parameters_type>(-0.5, 0.5);
-        const auto result = gradientDescent.optimize(costFunction, initialParameters);
+    /**
+     * Evaluate cost and gradient during fit on threadPool, which may be shared between
+     * regressions.
+     */
+    Regression &withThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+        return *this;
+    }
 
-        m_model.setParameters(result.optimalArguments);
+    /**
+     * Evaluate cost and gradient during fit on a thread pool of numThreads owned by this
+     * regression.
+     */
+    Regression &withNumThreads(const size_t numThreads) {
+        return withThreadPool(numThreads > 1 ? std::make_shared<ThreadPool>(numThreads) : nullptr);
+    }
+
+    /**
+     * Weight of the L2 penalty on the weights of the fitted model, 1E-6 by default.
+     */
+    Regression &withRegularizationFactor(const double regularizationFactor) {
+        m_regularizationFactor = regularizationFactor;
+        return *this;
     }
 
-    virtual double predict(const argument_type &x) const { return m_model.eval(adjustInput(x)); }
+    double regularizationFactor() const { return m_regularizationFactor; }
+
+    /**
+     * Weight of the L1 penalty on the weights of the fitted model, zero by default. With a
+     * positive factor the penalty is an elastic net, best minimized by CoordinateDescent, which
+     * sets the weights of uninformative features exactly to zero.
+     */
+    Regression &withL1RegularizationFactor(const double l1RegularizationFactor) {
+        m_l1RegularizationFactor = l1RegularizationFactor;
+        return *this;
+    }
 
-    const model_type model() const { return m_model; }
+    double l1RegularizationFactor() const { return m_l1RegularizationFactor; }
 
-  protected:
-    virtual cost_function_type getCostFunction(const training_set_type &trainingSet) = 0;
+    /**
+     * Seed of the random initial parameters of a fit, so that fits are reproducible.
+     */
+    Regression &withSeed(const uint64_t seed) {
+        m_seed = seed;
+        return *this;
+    }
+
+    /**
+     * Fit and predict on the features of expansion, computed from the raw features of every
+     * example as it is read, instead of on the raw features. The model has
+     * expansion.numOutputs() features, normalized with statistics computed in a single pass
+     * over the expanded examples, and the expanded dataset is never materialized. Only for
+     * regressions of runtime dimension.
+     */
+    Regression &withFeatureExpansion(FeatureExpansion expansion) {
+        static_assert(ArgumentDim == Dynamic,
+                      "Feature expansion needs a model of runtime dimension");
+        m_expansion = std::make_shared<const FeatureExpansion>(std::move(expansion));
+        return *this;
+    }
+
+    const FeatureExpansion *featureExpansion() const { return m_expansion.get(); }
 
     /**
-     * Adjust argument value to account for feature scaling and mean normalization.
+     * Start every fit from the current model, re-expressed in the normalization of the new
+     * training set, instead of from random parameters. Has no effect before the first fit.
      */
-    argument_type adjustInput(const argument_type &x) const { return (x - m_means) / m_sdevs; }
+    Regression &withWarmStart(const bool warmStart = true) {
+        m_warmStart = warmStart;
+        return *this;
+    }
+
+    void fit(const training_set_type &trainingSet) { fit(trainingSet, GradientDescent()); }
+
+    void fit(const dataset_view_type &dataset) { fit(dataset, GradientDescent()); }
+
+    void fit(dataset_type &&dataset) { fit(std::move(dataset), GradientDescent()); }
+
+    void fit(const source_type &source) { fit(source, GradientDescent()); }
+
+    /**
+     * Fit with optimizer, any type providing optimize(costFunction, initialParameters).
+     */
+    template <typename TOptimizer>
+    void fit(const training_set_type &trainingSet, const TOptimizer &optimizer) {
+        fit(dataset_type(trainingSet), optimizer);
+    }
+
+    /**
+     * Fit on dataset without copying it: the cost function normalizes blocks of examples as it
+     * reads them.
+     */
+    template <typename TOptimizer>
+    void fit(const dataset_view_type &dataset, const TOptimizer &optimizer) {
+        if (m_warmStart)
+            checkNumFeatures(dataset.numFeatures());
+        setNormalization(featureStatistics(dataset, m_threadPool.get()));
+        m_refitOffset = dataset.size();
+
+        auto costFunction = getCostFunction(dataset);
+        costFunction.setFeatureScaling(m_means, m_sdevs);
+        fitCostFunction(std::move(costFunction), numModelFeatures(dataset.numFeatures()),
+                        optimizer);
+    }
+
+    /**
+     * Fit on dataset, handed over by the caller: it is normalized in place, so the cost
+     * function reads normalized examples directly. With a feature expansion the examples are
+     * expanded and normalized as they are read instead.
+     */
+    template <typename TOptimizer> void fit(dataset_type &&dataset, const TOptimizer &optimizer) {
+        if (m_expansion) {
+            fit(dataset.view(), optimizer);
+            return;
+        }
 
-    argument_type computePerFeatureMean(const training_set_type &trainingSet) {
-        argument_type means = {0.0};
+        if (m_warmStart)
+            checkNumFeatures(dataset.numFeatures());
+        adjustTrainingSet(dataset);
+        m_refitOffset = dataset.size();
+        fitCostFunction(getCostFunction(dataset), dataset.numFeatures(), optimizer);
+    }
 
-        for (const auto &example : trainingSet) {
-            const auto &x = example.first;
-            means += x;
+    /**
+     * Fit on dataset through a normalized copy written to scratch, whose storage is reused from
+     * one fit to the next: the cost function reads the normalized examples directly, without
+     * scaling blocks into buffers as it reads them.
+     */
+    template <typename TOptimizer>
+    void fit(const dataset_view_type &dataset, const TOptimizer &optimizer,
+             dataset_type &scratch) {
+        if (m_expansion) {
+            fit(dataset, optimizer);
+            return;
         }
 
-        const auto numExamples = static_cast<double>(trainingSet.size());
-        means /= numExamples;
+        if (m_warmStart)
+            checkNumFeatures(dataset.numFeatures());
+        scratch.assign(dataset);
+        adjustTrainingSet(scratch);
+        m_refitOffset = dataset.size();
+        fitCostFunction(getCostFunction(scratch.view()), dataset.numFeatures(), optimizer);
+    }
+
+    /**
+     * Fit on the examples of source without loading them into memory: feature statistics are
+     * computed in a single pass over the chunks, and chunks are normalized as they are read.
+     */
+    template <typename TOptimizer>
+    void fit(const source_type &source, const TOptimizer &optimizer) {
+        if (m_warmStart)
+            checkNumFeatures(source.numFeatures());
+        FeatureStatistics<ArgumentDim> statistics(numModelFeatures(source.numFeatures()));
+        for (size_t c = 0; c < source.numChunks(); c++)
+            statistics.merge(featureStatistics(source.chunk(c), m_threadPool.get()));
+        setNormalization(statistics);
+        m_refitOffset = statistics.count();
+
+        auto costFunction = getCostFunction(std::make_shared<const source_type>(source));
+        costFunction.setFeatureScaling(m_means, m_sdevs);
+        fitCostFunction(std::move(costFunction), numModelFeatures(source.numFeatures()),
+                        optimizer);
+    }
+
+    /**
+     * Update the model with one epoch of StochasticGradientDescent over batch.
+     */
+    void partialFit(const dataset_view_type &batch) {
+        StochasticGradientDescent::HyperParameters hyperParameters;
+        hyperParameters.maxEpochs = 1;
+        partialFit(batch, StochasticGradientDescent().withHyperParameters(hyperParameters));
+    }
 
-        return means;
+    /**
+     * Update the model with the examples of batch alone, in time proportional to its size: the
+     * statistics of batch are merged into the running feature statistics, and the optimizer
+     * minimizes the cost over batch starting from the current model, re-expressed in the
+     * updated normalization. Optimizers that take a bounded number of steps, such as a few
+     * epochs of StochasticGradientDescent, keep what the model learned from earlier batches;
+     * optimizers that run to convergence forget them. The first call fits from random
+     * parameters. Batches are not part of the dataset a later refit() extends. Throws
+     * std::invalid_argument when batch has other features than the model.
+     */
+    template <typename TOptimizer>
+    void partialFit(const dataset_view_type &batch, const TOptimizer &optimizer) {
+        checkNumFeatures(batch.numFeatures());
+        auto statistics = m_statistics;
+        statistics.merge(featureStatistics(batch, m_threadPool.get()));
+        setNormalization(statistics);
+
+        auto costFunction = getCostFunction(batch);
+        costFunction.setFeatureScaling(m_means, m_sdevs);
+        fitCostFunction(std::move(costFunction), numModelFeatures(batch.numFeatures()), optimizer,
+                        true);
     }
 
-    argument_type computePerFeatureSDev(const training_set_type &trainingSet,
-                                        const argument_type &means) {
-        argument_type sdevs = {0};
-        for (const auto &example : trainingSet) {
-            const auto &x = example.first;
-            const auto diff = x - means;
-            sdevs += (diff * diff);
+    void refit(const dataset_view_type &dataset) { refit(dataset, GradientDescent()); }
+
+    /**
+     * Fit on dataset, made of the examples of the previous fit() or refit() followed by new
+     * ones: only the new rows are read to update the feature statistics, and the optimizer
+     * starts from the current model, so a dataset that grew slightly converges in a few
+     * iterations. Statistics of batches passed to partialFit() in between are kept. Throws
+     * std::invalid_argument when dataset is shorter than the dataset it extends or has other
+     * features than the model.
+     */
+    template <typename TOptimizer>
+    void refit(const dataset_view_type &dataset, const TOptimizer &optimizer) {
+        checkNumFeatures(dataset.numFeatures());
+        if (dataset.size() < m_refitOffset)
+            throw std::invalid_argument("refit on " + std::to_string(dataset.size()) +
+                                        " examples, fewer than the " +
+                                        std::to_string(m_refitOffset) + " already fitted");
+        auto statistics = m_statistics;
+        statistics.merge(featureStatistics(dataset.slice(m_refitOffset, dataset.size()),
+                                           m_threadPool.get()));
+        setNormalization(statistics);
+        m_refitOffset = dataset.size();
+
+        auto costFunction = getCostFunction(dataset);
+        costFunction.setFeatureScaling(m_means, m_sdevs);
+        fitCostFunction(std::move(costFunction), numModelFeatures(dataset.numFeatures()),
+                        optimizer, true);
+    }
+
+    /**
+     * Resume from parameters fitted on normalized features and the statistics of the examples
+     * they were fitted on, for instance to continue with partialFit() or refit() in another
+     * process. refitOffset is the refitOffset() of the model saved, since statistics also count
+     * the partialFit() batches that are not part of the dataset refit() extends.
+     */
+    void setState(const FeatureStatistics<ArgumentDim> &statistics, const size_t refitOffset,
+                  const parameters_type &parameters) {
+        assert(refitOffset <= statistics.count());
+        setNormalization(statistics);
+        m_refitOffset = refitOffset;
+        m_model.setParameters(parameters);
+        foldNormalization();
+        m_fitted = true;
+    }
+
+    /**
+     * Statistics of the features of all examples the model was fitted on.
+     */
+    const FeatureStatistics<ArgumentDim> &statistics() const { return m_statistics; }
+
+    /**
+     * Rows of the dataset of the last fit() or refit(), from which a later refit() reads.
+     */
+    size_t refitOffset() const { return m_refitOffset; }
+
+    /**
+     * Statistics over dataset of the features the model is fitted on, the raw features or their
+     * expansion, with shards accumulated in parallel on threadPool when it is not null.
+     */
+    FeatureStatistics<ArgumentDim> featureStatistics(const dataset_view_type &dataset,
+                                                     ThreadPool *threadPool) const {
+        if constexpr (ArgumentDim == Dynamic)
+            if (m_expansion)
+                return computeFeatureStatistics(dataset, *m_expansion, threadPool);
+
+        return computeFeatureStatistics(dataset, threadPool);
+    }
+
+    /**
+     * Number of features of the model for examples of numFeatures raw features.
+     */
+    size_t numModelFeatures(const size_t numFeatures) const {
+        return m_expansion ? m_expansion->numOutputs() : numFeatures;
+    }
+
+    /**
+     * Prediction for x, from the model with normalization folded into its parameters.
+     */
+    double predict(const argument_type &x) const {
+        return withModelFeatures(
+            x.data(), [&](const double *features) { return m_scoringModel.eval(features); });
+    }
+
+    /**
+     * Predictions for numRows rows of raw features starting at features, stride elements apart,
+     * written to out: one value per row, or one per class for multiclass models. Scores blocks
+     * of rows with a single matrix product and does not allocate, unless features are expanded:
+     * blocks of rows are then expanded into a buffer before they are scored.
+     */
+    template <typename TScalar>
+    void predictBatch(const TScalar *features, const size_t numRows, const size_t stride,
+                      double *out) const {
+        if (!m_expansion) {
+            m_scoringModel.evalBatch(features, numRows, stride, out);
+            return;
         }
 
-        const auto numExamples = static_cast<double>(trainingSet.size());
-        sdevs = apply<ArgumentDim>(sdevs / numExamples, [](double x) { return sqrt(x); });
+        constexpr size_t BlockSize = cost_function_type::BlockSize;
+        const size_t numOutputs = m_expansion->numOutputs();
+        const size_t expandedStride = paddedSize<double>(numOutputs);
+        const size_t outputsPerRow = m_scoringModel.parameters().size() / (numOutputs + 1);
+        AlignedVector<double> expanded(BlockSize * expandedStride, 0.0);
+
+        for (size_t i = 0; i < numRows; i += BlockSize) {
+            const size_t n = std::min(BlockSize, numRows - i);
+            for (size_t k = 0; k < n; k++)
+                m_expansion->expand(features + (i + k) * stride,
+                                    expanded.data() + k * expandedStride);
+            m_scoringModel.evalBatch(expanded.data(), n, expandedStride, out + i * outputsPerRow);
+        }
+    }
 
-        return sdevs;
+    /**
+     * Predictions for every row of dataset, written to out.
+     */
+    void predictBatch(const dataset_view_type &dataset, double *out) const {
+        predictBatch(dataset.row(0), dataset.size(), dataset.stride(), out);
+    }
+
+    /**
+     * Cost function of this regression over dataset, which must outlive it, with the
+     * regularization factors and feature expansion of the regression and without
+     * normalization.
+     */
+    cost_function_type costFunction(const dataset_view_type &dataset) {
+        auto costFunction = getCostFunction(dataset);
+        costFunction.setRegularizationFactor(m_regularizationFactor);
+        costFunction.setL1RegularizationFactor(m_l1RegularizationFactor);
+        costFunction.setFeatureExpansion(m_expansion);
+        return costFunction;
     }
 
     /**
-     * Perform feature scaling and mean normalization on trainingSet.
+     * Number of parameters of a model on numFeatures features.
      */
-    training_set_type adjustTrainingSet(const training_set_type &trainingSet) {
-        m_means = computePerFeatureMean(trainingSet);
-        m_sdevs = computePerFeatureSDev(trainingSet, m_means);
+    virtual size_t numParameters(const size_t numFeatures) const {
+        return augmentedDim(numFeatures);
+    }
 
-        training_set_type adjustedTrainingSet;
+    /**
+     * Model fitted on the normalized features.
+     */
+    const model_type &model() const { return m_model; }
 
-        for (const auto &[x, y] : trainingSet) {
-            adjustedTrainingSet.emplace_back(adjustInput(x), y);
+    /**
+     * Model fitted on the normalized features with the normalization folded into its
+     * parameters, so that it applies to raw features.
+     */
+    const model_type &scoringModel() const { return m_scoringModel; }
+
+  protected:
+    virtual cost_function_type getCostFunction(const dataset_view_type &dataset) = 0;
+
+    virtual cost_function_type getCostFunction(std::shared_ptr<const source_type> source) = 0;
+
+    /**
+     * Normalize features to zero mean and unit standard deviation. Constant features are only
+     * centered.
+     */
+    void setNormalization(const FeatureStatistics<ArgumentDim> &statistics) {
+        m_statistics = statistics;
+        m_means = statistics.mean();
+        m_sdevs = statistics.scale();
+    }
+
+    /**
+     * f(features) for the features the model is evaluated on for the raw features x: x itself,
+     * or its expansion.
+     */
+    template <typename TFunction> auto withModelFeatures(const double *x, TFunction &&f) const {
+        if (!m_expansion)
+            return f(x);
+
+        AlignedVector<double> expanded(m_expansion->numOutputs());
+        m_expansion->expand(x, expanded.data());
+        return f(static_cast<const double *>(expanded.data()));
+    }
+
+    /**
+     * Perform feature scaling and mean normalization on dataset, in place.
+     */
+    void adjustTrainingSet(dataset_type &dataset) {
+        setNormalization(computeFeatureStatistics(dataset.view(), m_threadPool.get()));
+
+        for (size_t i = 0; i < dataset.size(); i++) {
+            scalar_type *x = dataset.row(i);
+            for (size_t j = 0; j < dataset.numFeatures(); j++)
+                x[j] = static_cast<scalar_type>((x[j] - m_means[j]) / m_sdevs[j]);
+        }
+    }
+
+  private:
+    /**
+     * Throws std::invalid_argument when the model is fitted on another number of features than
+     * examples of numFeatures raw features have, so it cannot be updated from them.
+     */
+    void checkNumFeatures(const size_t numFeatures) const {
+        if (m_fitted && numModelFeatures(numFeatures) != m_statistics.numFeatures())
+            throw std::invalid_argument("examples of " +
+                                        std::to_string(numModelFeatures(numFeatures)) +
+                                        " features for a model fitted on " +
+                                        std::to_string(m_statistics.numFeatures()));
+    }
+
+    template <typename TOptimizer>
+    void fitCostFunction(cost_function_type &&costFunction, const size_t numFeatures,
+                         const TOptimizer &optimizer, const bool warmStart = false) {
+        costFunction.setThreadPool(m_threadPool);
+        costFunction.setFeatureExpansion(m_expansion);
+        costFunction.setRegularizationFactor(m_regularizationFactor);
+        costFunction.setL1RegularizationFactor(m_l1RegularizationFactor);
+        assert(!(m_fitted && (warmStart || m_warmStart)) ||
+               m_scoringModel.parameters().size() == numParameters(numFeatures));
+        const auto initialParameters =
+            m_fitted && (warmStart || m_warmStart)
+                ? normalizedScoringParameters()
+                : Random(m_seed).uniform<parameters_type>(numParameters(numFeatures), -0.5, 0.5);
+        const auto result = optimizer.optimize(costFunction, initialParameters);
+
+        m_model.setParameters(result.optimalArguments);
+        foldNormalization();
+        m_fitted = true;
+    }
+
+    /**
+     * Parameters of the scoring model on the current normalization, the inverse of
+     * foldNormalization(): w' = w * sdevs and b' = b + w . means for every row.
+     */
+    parameters_type normalizedScoringParameters() const {
+        auto parameters = m_scoringModel.parameters();
+        const size_t numFeatures = m_means.size();
+
+        for (size_t row = 0; row < parameters.size(); row += numFeatures + 1) {
+            double *w = parameters.data() + row;
+            w[numFeatures] += simd::dot(w, m_means.data(), numFeatures);
+            simd::mul(w, m_sdevs.data(), w, numFeatures);
+        }
+
+        return parameters;
+    }
+
+    /**
+     * w . (x - means) / sdevs + b = (w / sdevs) . x + b - (w / sdevs) . means, for every row of
+     * weights and bias of the parameters.
+     */
+    void foldNormalization() {
+        auto parameters = m_model.parameters();
+        const size_t numFeatures = m_means.size();
+
+        for (size_t row = 0; row < parameters.size(); row += numFeatures + 1) {
+            double *w = parameters.data() + row;
+            simd::div(w, m_sdevs.data(), w, numFeatures);
+            w[numFeatures] -= simd::dot(w, m_means.data(), numFeatures);
         }
 
-        return adjustedTrainingSet;
+        m_scoringModel.setParameters(parameters);
     }
 
   protected:
-    bool m_adjust{false};
+    double m_regularizationFactor{1E-6};
+    double m_l1RegularizationFactor{0.0};
+    uint64_t m_seed{Random::DefaultSeed};
+    bool m_warmStart{false};
+    bool m_fitted{false};
+    FeatureStatistics<ArgumentDim> m_statistics{ArgumentDim == Dynamic ? 0 : ArgumentDim};
+    size_t m_refitOffset{0}; // Rows of the dataset of the last fit() or refit()
     argument_type m_means, m_sdevs;
     model_type m_model;
+    model_type m_scoringModel;
+    std::shared_ptr<ThreadPool> m_threadPool;
+    std::shared_ptr<const FeatureExpansion> m_expansion;
 };
-} // namespace ml
\ No newline at end of file
+} // namespace ml
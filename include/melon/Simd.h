@@ -0,0 +1,592 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
+namespace ml::simd {
+
+namespace detail {
+
+/**
+ * Packed doubles of the widest instruction set enabled at compile time: AVX-512, AVX2, SSE2 or a
+ * scalar fallback. Kernels are written once against this interface. Loading from floats widens
+ * Width consecutive floats to doubles; gather loads base[indices[i]] for Width indices.
+ * whereNegative(c, a, b) selects a in the lanes where the sign bit of c is set and b elsewhere.
+ */
+#if defined(__AVX512F__)
+struct Pack {
+    static constexpr size_t Width = 8;
+    __m512d v;
+
+    static Pack load(const double *p) { return {_mm512_loadu_pd(p)}; }
+    static Pack load(const float *p) { return {_mm512_cvtps_pd(_mm256_loadu_ps(p))}; }
+    static Pack gather(const double *base, const uint32_t *indices) {
+        const __m256i offsets = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices));
+        return {_mm512_i32gather_pd(offsets, base, 8)};
+    }
+    static Pack broadcast(const double s) { return {_mm512_set1_pd(s)}; }
+    void store(double *p) const { _mm512_storeu_pd(p, v); }
+    double sum() const { return _mm512_reduce_add_pd(v); }
+
+    friend Pack operator+(const Pack a, const Pack b) { return {_mm512_add_pd(a.v, b.v)}; }
+    friend Pack operator-(const Pack a, const Pack b) { return {_mm512_sub_pd(a.v, b.v)}; }
+    friend Pack operator*(const Pack a, const Pack b) { return {_mm512_mul_pd(a.v, b.v)}; }
+    friend Pack operator/(const Pack a, const Pack b) { return {_mm512_div_pd(a.v, b.v)}; }
+    friend Pack fma(const Pack a, const Pack b, const Pack c) {
+        return {_mm512_fmadd_pd(a.v, b.v, c.v)};
+    }
+    friend Pack min(const Pack a, const Pack b) { return {_mm512_min_pd(a.v, b.v)}; }
+    friend Pack max(const Pack a, const Pack b) { return {_mm512_max_pd(a.v, b.v)}; }
+    friend Pack shiftToExponent(const Pack a) {
+        return {_mm512_castsi512_pd(_mm512_slli_epi64(_mm512_castpd_si512(a.v), 52))};
+    }
+    friend Pack whereNegative(const Pack c, const Pack a, const Pack b) {
+        const __mmask8 negative = _mm512_test_epi64_mask(
+            _mm512_castpd_si512(c.v), _mm512_set1_epi64(INT64_MIN));
+        return {_mm512_mask_blend_pd(negative, b.v, a.v)};
+    }
+};
+#elif defined(__AVX2__)
+struct Pack {
+    static constexpr size_t Width = 4;
+    __m256d v;
+
+    static Pack load(const double *p) { return {_mm256_loadu_pd(p)}; }
+    static Pack load(const float *p) { return {_mm256_cvtps_pd(_mm_loadu_ps(p))}; }
+    static Pack gather(const double *base, const uint32_t *indices) {
+        const __m128i offsets = _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices));
+        return {_mm256_i32gather_pd(base, offsets, 8)};
+    }
+    static Pack broadcast(const double s) { return {_mm256_set1_pd(s)}; }
+    void store(double *p) const { _mm256_storeu_pd(p, v); }
+    double sum() const {
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+
+    friend Pack operator+(const Pack a, const Pack b) { return {_mm256_add_pd(a.v, b.v)}; }
+    friend Pack operator-(const Pack a, const Pack b) { return {_mm256_sub_pd(a.v, b.v)}; }
+    friend Pack operator*(const Pack a, const Pack b) { return {_mm256_mul_pd(a.v, b.v)}; }
+    friend Pack operator/(const Pack a, const Pack b) { return {_mm256_div_pd(a.v, b.v)}; }
+#if defined(__FMA__)
+    friend Pack fma(const Pack a, const Pack b, const Pack c) {
+        return {_mm256_fmadd_pd(a.v, b.v, c.v)};
+    }
+#else
+    friend Pack fma(const Pack a, const Pack b, const Pack c) { return a * b + c; }
+#endif
+    friend Pack min(const Pack a, const Pack b) { return {_mm256_min_pd(a.v, b.v)}; }
+    friend Pack max(const Pack a, const Pack b) { return {_mm256_max_pd(a.v, b.v)}; }
+    friend Pack shiftToExponent(const Pack a) {
+        return {_mm256_castsi256_pd(_mm256_slli_epi64(_mm256_castpd_si256(a.v), 52))};
+    }
+    friend Pack whereNegative(const Pack c, const Pack a, const Pack b) {
+        return {_mm256_blendv_pd(b.v, a.v, c.v)};
+    }
+};
+#elif defined(__SSE2__)
+struct Pack {
+    static constexpr size_t Width = 2;
+    __m128d v;
+
+    static Pack load(const double *p) { return {_mm_loadu_pd(p)}; }
+    static Pack load(const float *p) {
+        return {_mm_cvtps_pd(_mm_castpd_ps(_mm_load_sd(reinterpret_cast<const double *>(p))))};
+    }
+    static Pack gather(const double *base, const uint32_t *indices) {
+        return {_mm_set_pd(base[indices[1]], base[indices[0]])};
+    }
+    static Pack broadcast(const double s) { return {_mm_set1_pd(s)}; }
+    void store(double *p) const { _mm_storeu_pd(p, v); }
+    double sum() const { return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v))); }
+
+    friend Pack operator+(const Pack a, const Pack b) { return {_mm_add_pd(a.v, b.v)}; }
+    friend Pack operator-(const Pack a, const Pack b) { return {_mm_sub_pd(a.v, b.v)}; }
+    friend Pack operator*(const Pack a, const Pack b) { return {_mm_mul_pd(a.v, b.v)}; }
+    friend Pack operator/(const Pack a, const Pack b) { return {_mm_div_pd(a.v, b.v)}; }
+    friend Pack fma(const Pack a, const Pack b, const Pack c) { return a * b + c; }
+    friend Pack min(const Pack a, const Pack b) { return {_mm_min_pd(a.v, b.v)}; }
+    friend Pack max(const Pack a, const Pack b) { return {_mm_max_pd(a.v, b.v)}; }
+    friend Pack shiftToExponent(const Pack a) {
+        return {_mm_castsi128_pd(_mm_slli_epi64(_mm_castpd_si128(a.v), 52))};
+    }
+    friend Pack whereNegative(const Pack c, const Pack a, const Pack b) {
+        const __m128d mask = _mm_castsi128_pd(_mm_srai_epi32(
+            _mm_shuffle_epi32(_mm_castpd_si128(c.v), _MM_SHUFFLE(3, 3, 1, 1)), 31));
+        return {_mm_or_pd(_mm_and_pd(mask, a.v), _mm_andnot_pd(mask, b.v))};
+    }
+};
+#else
+struct Pack {
+    static constexpr size_t Width = 1;
+    double v;
+
+    static Pack load(const double *p) { return {*p}; }
+    static Pack load(const float *p) { return {*p}; }
+    static Pack gather(const double *base, const uint32_t *indices) { return {base[*indices]}; }
+    static Pack broadcast(const double s) { return {s}; }
+    void store(double *p) const { *p = v; }
+    double sum() const { return v; }
+
+    friend Pack operator+(const Pack a, const Pack b) { return {a.v + b.v}; }
+    friend Pack operator-(const Pack a, const Pack b) { return {a.v - b.v}; }
+    friend Pack operator*(const Pack a, const Pack b) { return {a.v * b.v}; }
+    friend Pack operator/(const Pack a, const Pack b) { return {a.v / b.v}; }
+    friend Pack fma(const Pack a, const Pack b, const Pack c) { return {a.v * b.v + c.v}; }
+    friend Pack min(const Pack a, const Pack b) { return {std::min(a.v, b.v)}; }
+    friend Pack max(const Pack a, const Pack b) { return {std::max(a.v, b.v)}; }
+    friend Pack whereNegative(const Pack c, const Pack a, const Pack b) {
+        return std::signbit(c.v) ? a : b;
+    }
+};
+#endif
+
+#if defined(__AVX512F__) || defined(__AVX2__) || defined(__SSE2__)
+
+/**
+ * e^x for x clamped to [-708, 709]. Range reduction x = k ln(2) + r with |r| <= ln(2) / 2,
+ * followed by a degree 12 Taylor polynomial for e^r; relative error is below 1E-14.
+ */
+inline Pack exp(const Pack x) {
+    // Adding 1.5 * 2^52 rounds to the nearest integer, which is left in the low mantissa bits.
+    const Pack roundingBias = Pack::broadcast(6755399441055744.0);
+
+    const Pack clamped = min(max(x, Pack::broadcast(-708.0)), Pack::broadcast(709.0));
+    const Pack shifted = fma(clamped, Pack::broadcast(1.4426950408889634), roundingBias);
+    const Pack k = shifted - roundingBias;
+    const Pack r = fma(k, Pack::broadcast(-1.4286068203094173E-6),
+                       fma(k, Pack::broadcast(-6.93145751953125E-1), clamped));
+
+    Pack p = Pack::broadcast(1.0 / 479001600.0);
+    const double coefficients[] = {1.0 / 39916800.0, 1.0 / 3628800.0, 1.0 / 362880.0,
+                                   1.0 / 40320.0,    1.0 / 5040.0,    1.0 / 720.0,
+                                   1.0 / 120.0,      1.0 / 24.0,      1.0 / 6.0,
+                                   0.5,              1.0,             1.0};
+    for (const double c : coefficients)
+        p = fma(p, r, Pack::broadcast(c));
+
+    return p * shiftToExponent(shifted + Pack::broadcast(1023.0));
+}
+#else
+inline Pack exp(const Pack x) { return {std::exp(x.v)}; }
+#endif
+
+/**
+ * log(1 + t) for t in [0, 1], as 2 atanh(s) with s = t / (2 + t) in [0, 1/3]. The odd series
+ * of atanh is cut after s^27; relative error is below 1E-14, also for t close to 0.
+ */
+inline Pack log1p(const Pack t) {
+    const Pack s = t / (Pack::broadcast(2.0) + t);
+    const Pack u = s * s;
+
+    Pack p = Pack::broadcast(1.0 / 27.0);
+    for (int k = 12; k >= 0; k--)
+        p = fma(p, u, Pack::broadcast(1.0 / (2 * k + 1)));
+
+    return Pack::broadcast(2.0) * s * p;
+}
+
+} // namespace detail
+
+/**
+ * Sum of a[i] * b[i] for i in [0, n), accumulated in double also when a holds floats.
+ */
+template <typename TScalar> double dot(const TScalar *a, const double *b, const size_t n) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    Pack acc0 = Pack::broadcast(0.0), acc1 = Pack::broadcast(0.0);
+    size_t i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        acc0 = fma(Pack::load(a + i), Pack::load(b + i), acc0);
+        acc1 = fma(Pack::load(a + i + W), Pack::load(b + i + W), acc1);
+    }
+    if (i + W <= n) {
+        acc0 = fma(Pack::load(a + i), Pack::load(b + i), acc0);
+        i += W;
+    }
+
+    double sum = (acc0 + acc1).sum();
+    for (; i < n; i++)
+        sum += a[i] * b[i];
+
+    return sum;
+}
+
+/**
+ * Sum of w[i] * a[i] * b[i] for i in [0, n).
+ */
+inline double weightedDot(const double *a, const double *b, const double *w, const size_t n) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    Pack acc0 = Pack::broadcast(0.0), acc1 = Pack::broadcast(0.0);
+    size_t i = 0;
+    for (; i + 2 * W <= n; i += 2 * W) {
+        acc0 = fma(Pack::load(w + i) * Pack::load(a + i), Pack::load(b + i), acc0);
+        acc1 = fma(Pack::load(w + i + W) * Pack::load(a + i + W), Pack::load(b + i + W), acc1);
+    }
+    if (i + W <= n) {
+        acc0 = fma(Pack::load(w + i) * Pack::load(a + i), Pack::load(b + i), acc0);
+        i += W;
+    }
+
+    double sum = (acc0 + acc1).sum();
+    for (; i < n; i++)
+        sum += w[i] * a[i] * b[i];
+
+    return sum;
+}
+
+/**
+ * Sum of a[i]^2 for i in [0, n).
+ */
+inline double sumOfSquares(const double *a, const size_t n) { return dot(a, a, n); }
+
+/**
+ * y[i] += alpha * x[i] for i in [0, n).
+ */
+template <typename TScalar>
+void axpy(const double alpha, const TScalar *x, double *y, const size_t n) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    const Pack a = Pack::broadcast(alpha);
+    size_t i = 0;
+    for (; i + W <= n; i += W)
+        fma(a, Pack::load(x + i), Pack::load(y + i)).store(y + i);
+    for (; i < n; i++)
+        y[i] += alpha * x[i];
+}
+
+/**
+ * y[r] = dot(a + r * stride, x, cols) for r in [0, rows). Four rows are processed together so
+ * that every load of x is shared between them.
+ */
+template <typename TScalar>
+void gemv(const TScalar *a, const size_t rows, const size_t cols, const size_t stride,
+          const double *x, double *y) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    size_t r = 0;
+    for (; r + 4 <= rows; r += 4) {
+        const TScalar *a0 = a + r * stride, *a1 = a0 + stride, *a2 = a1 + stride,
+                      *a3 = a2 + stride;
+        Pack acc0 = Pack::broadcast(0.0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+        size_t j = 0;
+        for (; j + W <= cols; j += W) {
+            const Pack xj = Pack::load(x + j);
+            acc0 = fma(Pack::load(a0 + j), xj, acc0);
+            acc1 = fma(Pack::load(a1 + j), xj, acc1);
+            acc2 = fma(Pack::load(a2 + j), xj, acc2);
+            acc3 = fma(Pack::load(a3 + j), xj, acc3);
+        }
+
+        double y0 = acc0.sum(), y1 = acc1.sum(), y2 = acc2.sum(), y3 = acc3.sum();
+        for (; j < cols; j++) {
+            y0 += a0[j] * x[j];
+            y1 += a1[j] * x[j];
+            y2 += a2[j] * x[j];
+            y3 += a3[j] * x[j];
+        }
+
+        y[r] = y0;
+        y[r + 1] = y1;
+        y[r + 2] = y2;
+        y[r + 3] = y3;
+    }
+
+    for (; r < rows; r++)
+        y[r] = dot(a + r * stride, x, cols);
+}
+
+/**
+ * out[r * numB + c] = dot(a + r * stride, b + c * bStride, cols) for r in [0, rows) and c in
+ * [0, numB): the products of every row of a with every row of b. Four rows of b are processed
+ * together so that every load from a row of a is shared between them; b is expected to be
+ * small enough to stay in cache.
+ */
+template <typename TScalar>
+void gemm(const TScalar *a, const size_t rows, const size_t cols, const size_t stride,
+          const double *b, const size_t numB, const size_t bStride, double *out) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    for (size_t r = 0; r < rows; r++) {
+        const TScalar *ar = a + r * stride;
+        double *outr = out + r * numB;
+
+        size_t c = 0;
+        for (; c + 4 <= numB; c += 4) {
+            const double *b0 = b + c * bStride, *b1 = b0 + bStride, *b2 = b1 + bStride,
+                         *b3 = b2 + bStride;
+            Pack acc0 = Pack::broadcast(0.0), acc1 = acc0, acc2 = acc0, acc3 = acc0;
+
+            size_t j = 0;
+            for (; j + W <= cols; j += W) {
+                const Pack aj = Pack::load(ar + j);
+                acc0 = fma(aj, Pack::load(b0 + j), acc0);
+                acc1 = fma(aj, Pack::load(b1 + j), acc1);
+                acc2 = fma(aj, Pack::load(b2 + j), acc2);
+                acc3 = fma(aj, Pack::load(b3 + j), acc3);
+            }
+
+            double y0 = acc0.sum(), y1 = acc1.sum(), y2 = acc2.sum(), y3 = acc3.sum();
+            for (; j < cols; j++) {
+                y0 += ar[j] * b0[j];
+                y1 += ar[j] * b1[j];
+                y2 += ar[j] * b2[j];
+                y3 += ar[j] * b3[j];
+            }
+
+            outr[c] = y0;
+            outr[c + 1] = y1;
+            outr[c + 2] = y2;
+            outr[c + 3] = y3;
+        }
+
+        for (; c < numB; c++)
+            outr[c] = dot(ar, b + c * bStride, cols);
+    }
+}
+
+namespace detail {
+
+template <typename TOp>
+inline void transform(const double *a, const double *b, double *out, const size_t n, TOp op) {
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width)
+        op(Pack::load(a + i), Pack::load(b + i)).store(out + i);
+    for (; i < n; i++)
+        out[i] = op(a[i], b[i]);
+}
+
+template <typename TOp>
+inline void transform(const double *a, const double s, double *out, const size_t n, TOp op) {
+    const Pack ps = Pack::broadcast(s);
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width)
+        op(Pack::load(a + i), ps).store(out + i);
+    for (; i < n; i++)
+        out[i] = op(a[i], s);
+}
+} // namespace detail
+
+/**
+ * Elementwise out[i] = a[i] + b[i]. Output may alias either input.
+ */
+inline void add(const double *a, const double *b, double *out, const size_t n) {
+    detail::transform(a, b, out, n, [](auto x, auto y) { return x + y; });
+}
+
+inline void add(const double *a, const double s, double *out, const size_t n) {
+    detail::transform(a, s, out, n, [](auto x, auto y) { return x + y; });
+}
+
+/**
+ * Elementwise out[i] = a[i] - b[i]. Output may alias either input.
+ */
+inline void sub(const double *a, const double *b, double *out, const size_t n) {
+    detail::transform(a, b, out, n, [](auto x, auto y) { return x - y; });
+}
+
+/**
+ * Elementwise out[i] = a[i] * b[i]. Output may alias either input.
+ */
+inline void mul(const double *a, const double *b, double *out, const size_t n) {
+    detail::transform(a, b, out, n, [](auto x, auto y) { return x * y; });
+}
+
+inline void mul(const double *a, const double s, double *out, const size_t n) {
+    detail::transform(a, s, out, n, [](auto x, auto y) { return x * y; });
+}
+
+/**
+ * Elementwise out[i] = a[i] / b[i]. Output may alias either input.
+ */
+inline void div(const double *a, const double *b, double *out, const size_t n) {
+    detail::transform(a, b, out, n, [](auto x, auto y) { return x / y; });
+}
+
+inline void div(const double *a, const double s, double *out, const size_t n) {
+    detail::transform(a, s, out, n, [](auto x, auto y) { return x / y; });
+}
+
+/**
+ * Sum of values[k] * x[indices[k]] for k in [0, n), the dot product of a sparse and a dense
+ * vector.
+ */
+inline double sparseDot(const uint32_t *indices, const double *values, const size_t n,
+                        const double *x) {
+    using detail::Pack;
+    constexpr size_t W = Pack::Width;
+
+    Pack acc = Pack::broadcast(0.0);
+    size_t k = 0;
+    for (; k + W <= n; k += W)
+        acc = fma(Pack::load(values + k), Pack::gather(x, indices + k), acc);
+
+    double sum = acc.sum();
+    for (; k < n; k++)
+        sum += values[k] * x[indices[k]];
+
+    return sum;
+}
+
+/**
+ * y[indices[k]] += alpha * values[k] for k in [0, n). Indices must be distinct.
+ */
+inline void sparseAxpy(const double alpha, const uint32_t *indices, const double *values,
+                       const size_t n, double *y) {
+    for (size_t k = 0; k < n; k++)
+        y[indices[k]] += alpha * values[k];
+}
+
+/**
+ * out[i] = a[i] widened to double for i in [0, n).
+ */
+inline void convert(const float *a, double *out, const size_t n) {
+    using detail::Pack;
+
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width)
+        Pack::load(a + i).store(out + i);
+    for (; i < n; i++)
+        out[i] = a[i];
+}
+
+/**
+ * Elementwise out[i] = e^a[i], with the accuracy of the vectorized exponential for a[i] in
+ * [-708, 709]. Output may alias the input.
+ */
+inline void exp(const double *a, double *out, const size_t n) {
+    using detail::Pack;
+
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width)
+        detail::exp(Pack::load(a + i)).store(out + i);
+    for (; i < n; i++)
+        out[i] = std::exp(a[i]);
+}
+
+/**
+ * Softmax in place of each of rows rows of cols values, e^(z - max) / sum of e^(z - max) so
+ * that no exponential overflows. When logSumExp is given, log(sum of e^z) of every row is
+ * written to it. The exponentials of all rows are computed by a single vectorized pass.
+ */
+inline void softmax(double *z, const size_t rows, const size_t cols,
+                    double *logSumExp = nullptr) {
+    for (size_t r = 0; r < rows; r++) {
+        double *zr = z + r * cols;
+        const double maximum = *std::max_element(zr, zr + cols);
+        add(zr, -maximum, zr, cols);
+        if (logSumExp)
+            logSumExp[r] = maximum;
+    }
+
+    exp(z, z, rows * cols);
+
+    for (size_t r = 0; r < rows; r++) {
+        double *zr = z + r * cols;
+        double sum = 0.0;
+        for (size_t c = 0; c < cols; c++)
+            sum += zr[c];
+
+        mul(zr, 1.0 / sum, zr, cols);
+        if (logSumExp)
+            logSumExp[r] += std::log(sum);
+    }
+}
+
+/**
+ * Logistic function 1 / (1 + e^-z).
+ */
+inline double sigmoid(const double z) { return 1.0 / (1.0 + std::exp(-z)); }
+
+/**
+ * Softplus log(1 + e^z), computed as max(z, 0) + log(1 + e^-|z|) so that it neither overflows
+ * nor loses precision for large |z|.
+ */
+inline double softplus(const double z) {
+    return std::max(z, 0.0) + std::log1p(std::exp(-std::abs(z)));
+}
+
+/**
+ * Cross entropy y log(1 + e^-z) + (1 - y) log(1 + e^z) of the logistic prediction for the
+ * linear score z and a label y in [0, 1], finite for every z.
+ */
+inline double logisticLoss(const double z, const double y) {
+    return std::log1p(std::exp(-std::abs(z))) + (std::max(z, 0.0) - y * z);
+}
+
+/**
+ * Cross entropy loss[i] = logisticLoss(z[i], y[i]) and its derivative with respect to the
+ * score, residual[i] = sigmoid(z[i]) - y[i], for i in [0, n). Both share a single vectorized
+ * e^-|z|, and the logarithm is taken of 1 + e^-|z| in [1, 2] only, so neither can overflow.
+ */
+template <typename TScalar>
+void logisticLoss(const double *z, const TScalar *y, double *loss, double *residual,
+                  const size_t n) {
+    using detail::Pack;
+
+    const Pack one = Pack::broadcast(1.0), zero = Pack::broadcast(0.0);
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width) {
+        const Pack zi = Pack::load(z + i), yi = Pack::load(y + i);
+        const Pack t = detail::exp(zero - max(zi, zero - zi));
+        const Pack q = one / (one + t);
+
+        (detail::log1p(t) + fma(zero - yi, zi, max(zi, zero))).store(loss + i);
+        (whereNegative(zi, t * q, q) - yi).store(residual + i);
+    }
+    for (; i < n; i++) {
+        const double t = std::exp(-std::abs(z[i])), q = 1.0 / (1.0 + t);
+        loss[i] = std::log1p(t) + (std::max(z[i], 0.0) - y[i] * z[i]);
+        residual[i] = (z[i] < 0.0 ? t * q : q) - y[i];
+    }
+}
+
+/**
+ * Squared error loss[i] = 0.5 (z[i] - y[i])^2 of the linear prediction z[i] and its derivative
+ * residual[i] = z[i] - y[i], for i in [0, n).
+ */
+template <typename TScalar>
+void squaredLoss(const double *z, const TScalar *y, double *loss, double *residual,
+                 const size_t n) {
+    using detail::Pack;
+
+    const Pack half = Pack::broadcast(0.5);
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width) {
+        const Pack diff = Pack::load(z + i) - Pack::load(y + i);
+        diff.store(residual + i);
+        (half * diff * diff).store(loss + i);
+    }
+    for (; i < n; i++) {
+        residual[i] = z[i] - y[i];
+        loss[i] = 0.5 * (residual[i] * residual[i]);
+    }
+}
+
+/**
+ * Elementwise out[i] = 1 / (1 + e^-z[i]). Output may alias the input.
+ */
+inline void sigmoid(const double *z, double *out, const size_t n) {
+    using detail::Pack;
+
+    const Pack one = Pack::broadcast(1.0), zero = Pack::broadcast(0.0);
+    size_t i = 0;
+    for (; i + Pack::Width <= n; i += Pack::Width)
+        (one / (one + detail::exp(zero - Pack::load(z + i)))).store(out + i);
+    for (; i < n; i++)
+        out[i] = sigmoid(z[i]);
+}
+} // namespace ml::simd
@@ -0,0 +1,101 @@
+#pragma once
+
+#include <melon/Simd.h>
+#include <melon/Types.h>
+
+#include <cassert>
+
+namespace ml {
+
+/**
+ * Multinomial logistic model over numClasses() classes. Parameters are numClasses() rows of
+ * numFeatures() weights followed by a bias, one row per class; class c has logit w_c . x + b_c
+ * and probability e^(logit c) / sum of e^logits. Labels are class indices 0, 1, ...
+ */
+template <size_t dim> class SoftmaxModel {
+  public:
+    static constexpr size_t ArgumentDim = dim;
+    static constexpr size_t NumParameters = Dynamic;
+
+    using argument_type = Vector<ArgumentDim>;
+    using parameters_type = DynamicVector;
+
+    SoftmaxModel() = default;
+
+    explicit SoftmaxModel(const size_t numClasses) : m_numClasses(numClasses) {}
+
+    SoftmaxModel(const size_t numClasses, const parameters_type &parameters)
+        : m_numClasses(numClasses) {
+        setParameters(parameters);
+    }
+
+    void setParameters(const parameters_type &parameters) {
+        assert(m_numClasses > 0 && parameters.size() % m_numClasses == 0);
+        m_parameters = parameters;
+    }
+
+    const parameters_type &parameters() const { return m_parameters; }
+
+    size_t numClasses() const { return m_numClasses; }
+
+    size_t numFeatures() const {
+        return m_numClasses == 0 ? 0 : m_parameters.size() / m_numClasses - 1;
+    }
+
+    double eval(const argument_type &x) const { return eval(x.data()); }
+
+    /**
+     * Most likely class for numFeatures() contiguous features, doubles or floats.
+     */
+    template <typename TScalar> double eval(const TScalar *x) const {
+        const size_t rowSize = numFeatures() + 1;
+        size_t best = 0;
+        double bestLogit = 0.0;
+        for (size_t c = 0; c < m_numClasses; c++) {
+            const double *w = m_parameters.data() + c * rowSize;
+            const double logit = simd::dot(x, w, numFeatures()) + w[numFeatures()];
+            if (c == 0 || logit > bestLogit) {
+                best = c;
+                bestLogit = logit;
+            }
+        }
+
+        return static_cast<double>(best);
+    }
+
+    /**
+     * Probabilities of the numClasses() classes for numFeatures() contiguous features, written
+     * to out.
+     */
+    template <typename TScalar> void probabilities(const TScalar *x, double *out) const {
+        evalBatch(x, 1, numFeatures(), out);
+    }
+
+    /**
+     * Logits of n rows of features starting at x, stride elements apart: numClasses() values
+     * per row written to out, computed with a single matrix product.
+     */
+    template <typename TScalar>
+    void logitsBatch(const TScalar *x, const size_t n, const size_t stride, double *out) const {
+        const size_t rowSize = numFeatures() + 1;
+        simd::gemm(x, n, numFeatures(), stride, m_parameters.data(), m_numClasses, rowSize, out);
+        for (size_t r = 0; r < n; r++)
+            for (size_t c = 0; c < m_numClasses; c++)
+                out[r * m_numClasses + c] += m_parameters[c * rowSize + numFeatures()];
+    }
+
+    /**
+     * Class probabilities of n rows of features starting at x, stride elements apart:
+     * numClasses() values per row written to out.
+     */
+    template <typename TScalar>
+    void evalBatch(const TScalar *x, const size_t n, const size_t stride, double *out) const {
+        logitsBatch(x, n, stride, out);
+        simd::softmax(out, n, m_numClasses);
+    }
+
+  private:
+    size_t m_numClasses{0};
+    parameters_type m_parameters;
+};
+} // namespace ml
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <melon/Regression.h>
+#include <melon/SoftmaxModel.h>
+
+#include <cassert>
+
+namespace ml {
+
+/**
+ * Cross entropy of a softmax model over numClasses classes, whose labels are class indices.
+ * All logits of a block of examples are computed by a single matrix product and shared by the
+ * loss, a log-sum-exp that cannot overflow, and the gradient.
+ */
+template <size_t dim, typename TScalar = double>
+class SoftmaxRegressionCostFunction : public CostFunction<SoftmaxModel<dim>, TScalar> {
+  public:
+    using model_type = SoftmaxModel<dim>;
+    using argument_type = typename model_type::parameters_type;
+    using gradient_type = argument_type;
+    using training_set_type = TrainingSet<dim>;
+    using dataset_view_type = DatasetView<dim, TScalar>;
+    using source_type = ChunkedDatasetSource<dim, TScalar>;
+
+  public:
+    SoftmaxRegressionCostFunction(const training_set_type &trainingSet, const size_t numClasses)
+        : CostFunction<model_type, TScalar>(trainingSet), m_numClasses(numClasses) {}
+
+    SoftmaxRegressionCostFunction(const dataset_view_type &dataset, const size_t numClasses)
+        : CostFunction<model_type, TScalar>(dataset), m_numClasses(numClasses) {}
+
+    SoftmaxRegressionCostFunction(std::shared_ptr<const source_type> source,
+                                  const size_t numClasses)
+        : CostFunction<model_type, TScalar>(std::move(source)), m_numClasses(numClasses) {}
+
+    size_t numClasses() const { return m_numClasses; }
+
+    double eval(const argument_type &input) const { return evalCost<false>(input).value; }
+
+    gradient_type gradient(const argument_type &input) const {
+        return evalCost<true>(input).gradient;
+    }
+
+    ValueAndGradient<gradient_type> valueAndGradient(const argument_type &input) const {
+        return evalCost<true>(input);
+    }
+
+    /**
+     * Unbiased estimate of the gradient from the batchSize examples indexed by batch, for
+     * stochastic optimizers. Every index of batch must lie in the chunk of batch[0], as for
+     * linear and logistic costs.
+     */
+    gradient_type batchGradient(const argument_type &input, const size_t *batch,
+                                const size_t batchSize) const {
+        const model_type model(m_numClasses, input);
+        const size_t numFeatures = model.numFeatures(), rowSize = numFeatures + 1;
+        auto grad = zeros<gradient_type>(input.size());
+
+        const size_t chunk =
+            batchSize > 0 && this->m_source ? batch[0] / this->m_source->chunkSize() : 0;
+        const size_t offset = chunk * this->chunkSize();
+        const dataset_view_type dataset =
+            this->m_source ? this->m_source->chunk(chunk) : this->m_dataset;
+        [[maybe_unused]] const size_t chunkExamples =
+            this->m_indices ? this->m_indices->size() : dataset.size();
+        AlignedVector<double> scaled(this->m_scaled || this->m_expansion ? numFeatures : 0);
+        AlignedVector<double> residuals(m_numClasses);
+
+        const auto accumulate = [&](const auto *x, const double y) {
+            model.probabilities(x, residuals.data());
+            residuals[classOf(y)] -= 1.0;
+            for (size_t c = 0; c < m_numClasses; c++) {
+                simd::axpy(residuals[c], x, grad.data() + c * rowSize, numFeatures);
+                grad[c * rowSize + numFeatures] += residuals[c];
+            }
+        };
+
+        for (size_t k = 0; k < batchSize; k++) {
+            assert(batch[k] >= offset && batch[k] - offset < chunkExamples);
+            const size_t i = this->exampleRow(batch[k] - offset);
+            if (this->m_scaled || this->m_expansion)
+                accumulate(this->modelFeatures(dataset.row(i), scaled.data(), numFeatures),
+                           dataset.label(i));
+            else
+                accumulate(dataset.row(i), dataset.label(i));
+        }
+
+        grad /= static_cast<double>(batchSize);
+
+        const double regularizationScale =
+            this->m_regularizationFactor / static_cast<double>(this->numExamples());
+        for (size_t c = 0; c < m_numClasses; c++) {
+            simd::axpy(regularizationScale, input.data() + c * rowSize, grad.data() + c * rowSize,
+                       numFeatures);
+            this->addL1Subgradient(input.data() + c * rowSize, grad.data() + c * rowSize,
+                                   numFeatures, 1.0 / static_cast<double>(this->numExamples()));
+        }
+
+        return grad;
+    }
+
+  private:
+    static size_t classOf(const double y) { return static_cast<size_t>(y); }
+
+    /**
+     * Regularized cost, and its gradient when WithGradient, in a single sweep over the
+     * training set.
+     */
+    template <bool WithGradient>
+    ValueAndGradient<gradient_type> evalCost(const argument_type &input) const {
+        constexpr size_t BlockSize = CostFunction<model_type, TScalar>::BlockSize;
+
+        const model_type model(m_numClasses, input);
+        const size_t numFeatures = model.numFeatures(), rowSize = numFeatures + 1;
+
+        auto [cost, grad] = this->reduceExamples(
+            [&](const dataset_view_type &dataset, const size_t begin, const size_t end) {
+                ValueAndGradient<gradient_type> partial{
+                    0.0, zeros<gradient_type>(WithGradient ? input.size() : 0)};
+                AlignedVector<double> probabilities(BlockSize * m_numClasses);
+                double logSumExp[BlockSize];
+                size_t labels[BlockSize];
+
+                this->forEachBlock(dataset, begin, end, [&](const auto &block) {
+                    const size_t n = block.size();
+                    double *p = probabilities.data();
+                    model.logitsBatch(block.row(0), n, block.stride(), p);
+
+                    for (size_t k = 0; k < n; k++) {
+                        labels[k] = classOf(block.label(k));
+                        assert(labels[k] < m_numClasses);
+                        partial.value -= p[k * m_numClasses + labels[k]];
+                    }
+
+                    simd::softmax(p, n, m_numClasses, logSumExp);
+                    for (size_t k = 0; k < n; k++)
+                        partial.value += logSumExp[k];
+
+                    if constexpr (WithGradient) {
+                        for (size_t k = 0; k < n; k++) {
+                            double *residuals = p + k * m_numClasses;
+                            residuals[labels[k]] -= 1.0;
+                            for (size_t c = 0; c < m_numClasses; c++) {
+                                double *g = partial.gradient.data() + c * rowSize;
+                                simd::axpy(residuals[c], block.row(k), g, numFeatures);
+                                g[numFeatures] += residuals[c];
+                            }
+                        }
+                    }
+                });
+                return partial;
+            },
+            [](ValueAndGradient<gradient_type> &result,
+               const ValueAndGradient<gradient_type> &partial) {
+                result.value += partial.value;
+                if constexpr (WithGradient)
+                    result.gradient += partial.gradient;
+            });
+
+        const double lambda = this->m_regularizationFactor;
+        double sumOfSquares = 0.0, l1Term = 0.0;
+        for (size_t c = 0; c < m_numClasses; c++) {
+            const double *w = input.data() + c * rowSize;
+            sumOfSquares += simd::sumOfSquares(w, numFeatures);
+            l1Term += this->l1Term(w, numFeatures);
+            if constexpr (WithGradient) {
+                simd::axpy(lambda, w, grad.data() + c * rowSize, numFeatures);
+                this->addL1Subgradient(w, grad.data() + c * rowSize, numFeatures);
+            }
+        }
+
+        const double numExamples = static_cast<double>(this->numExamples());
+        if constexpr (WithGradient)
+            grad /= numExamples;
+
+        return {(cost + 0.5 * lambda * sumOfSquares + l1Term) / numExamples, grad};
+    }
+
+    size_t m_numClasses;
+};
+
+/**
+   Multinomial logistic regression over numClasses classes. All classes are fitted together:
+   every iteration reads the normalized features once, whatever the number of classes.
+   predict() returns the most likely class, predictBatch() the probabilities of every class.
+ */
+template <size_t dim, typename TScalar = double>
+class SoftmaxRegression
+    : public Regression<SoftmaxModel<dim>, SoftmaxRegressionCostFunction<dim, TScalar>> {
+  public:
+    using model_type = SoftmaxModel<dim>;
+    using cost_function_type = SoftmaxRegressionCostFunction<dim, TScalar>;
+    using argument_type = typename model_type::argument_type;
+    using training_set_type = typename cost_function_type::training_set_type;
+    using dataset_view_type = typename cost_function_type::dataset_view_type;
+    using source_type = typename cost_function_type::source_type;
+
+    explicit SoftmaxRegression(const size_t numClasses) : m_numClasses(numClasses) {
+        this->m_model = model_type(numClasses);
+        this->m_scoringModel = model_type(numClasses);
+    }
+
+    size_t numClasses() const { return m_numClasses; }
+
+    /**
+     * Probabilities of the numClasses() classes for x, written to out.
+     */
+    void predictProbabilities(const argument_type &x, double *out) const {
+        this->withModelFeatures(x.data(), [&](const double *features) {
+            this->m_scoringModel.probabilities(features, out);
+        });
+    }
+
+    virtual size_t numParameters(const size_t numFeatures) const {
+        return m_numClasses * (numFeatures + 1);
+    }
+
+  private:
+    virtual cost_function_type getCostFunction(const dataset_view_type &dataset) {
+        return cost_function_type(dataset, m_numClasses);
+    }
+
+    virtual cost_function_type getCostFunction(std::shared_ptr<const source_type> source) {
+        return cost_function_type(std::move(source), m_numClasses);
+    }
+
+    size_t m_numClasses;
+};
+} // namespace ml
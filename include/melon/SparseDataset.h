@@ -0,0 +1,162 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+#include <melon/Dataset.h>
+#include <melon/Types.h>
+
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Non-owning view over a block of rows of a sparse dataset in compressed sparse row (CSR)
+ * layout: the nonzeros of row i are indices[offsets[i], offsets[i + 1]) and the values at the
+ * same positions. Offsets are positions in the indices and values arrays of the whole dataset,
+ * so a slice shares them.
+ */
+class SparseDatasetView {
+  public:
+    SparseDatasetView() = default;
+
+    SparseDatasetView(const size_t *offsets, const uint32_t *indices, const double *values,
+                      const double *labels, const size_t size, const size_t numFeatures)
+        : m_offsets(offsets), m_indices(indices), m_values(values), m_labels(labels),
+          m_size(size), m_numFeatures(numFeatures) {}
+
+    size_t size() const { return m_size; }
+
+    size_t numFeatures() const { return m_numFeatures; }
+
+    bool empty() const { return m_size == 0; }
+
+    /**
+     * Number of nonzeros of the rows of the view.
+     */
+    size_t nnz() const { return m_size == 0 ? 0 : m_offsets[m_size] - m_offsets[0]; }
+
+    SparseVectorView row(const size_t i) const {
+        return {m_indices + m_offsets[i], m_values + m_offsets[i],
+                m_offsets[i + 1] - m_offsets[i]};
+    }
+
+    double label(const size_t i) const { return m_labels[i]; }
+
+    const double *labels() const { return m_labels; }
+
+    /**
+     * View over rows [begin, end).
+     */
+    SparseDatasetView slice(const size_t begin, const size_t end) const {
+        assert(begin <= end && end <= m_size);
+        return {m_offsets + begin, m_indices, m_values, m_labels + begin, end - begin,
+                m_numFeatures};
+    }
+
+  private:
+    const size_t *m_offsets{nullptr};
+    const uint32_t *m_indices{nullptr};
+    const double *m_values{nullptr};
+    const double *m_labels{nullptr};
+    size_t m_size{0};
+    size_t m_numFeatures{0};
+};
+
+/**
+ * Training set of high-dimensional, mostly zero features in compressed sparse row layout. Memory
+ * and the cost of every pass over the examples are linear in the number of nonzeros.
+ */
+class SparseDataset {
+  public:
+    using view_type = SparseDatasetView;
+
+    SparseDataset() : SparseDataset(0) {}
+
+    explicit SparseDataset(const size_t numFeatures)
+        : m_numFeatures(numFeatures), m_offsets(1, 0) {}
+
+    /**
+     * Nonzeros of every row of dataset, that is all entries that are not exactly zero.
+     */
+    template <size_t dim, typename TScalar>
+    explicit SparseDataset(const DatasetView<dim, TScalar> &dataset)
+        : SparseDataset(dataset.numFeatures()) {
+        reserve(dataset.size(), 0);
+        for (size_t i = 0; i < dataset.size(); i++) {
+            const TScalar *x = dataset.row(i);
+            for (size_t j = 0; j < dataset.numFeatures(); j++) {
+                if (x[j] != TScalar(0)) {
+                    m_indices.push_back(static_cast<uint32_t>(j));
+                    m_values.push_back(x[j]);
+                }
+            }
+            m_offsets.push_back(m_indices.size());
+            m_labels.push_back(dataset.label(i));
+        }
+    }
+
+    void reserve(const size_t size, const size_t nnz) {
+        m_offsets.reserve(size + 1);
+        m_labels.reserve(size);
+        m_indices.reserve(nnz);
+        m_values.reserve(nnz);
+    }
+
+    /**
+     * Append an example with n nonzeros at increasing indices below numFeatures().
+     */
+    void emplace_back(const uint32_t *indices, const double *values, const size_t n,
+                      const double y) {
+        for (size_t k = 0; k < n; k++) {
+            assert(indices[k] < m_numFeatures);
+            assert(k == 0 || indices[k - 1] < indices[k]);
+        }
+
+        m_indices.insert(m_indices.end(), indices, indices + n);
+        m_values.insert(m_values.end(), values, values + n);
+        m_offsets.push_back(m_indices.size());
+        m_labels.push_back(y);
+    }
+
+    /**
+     * Append an example given as (index, value) pairs at increasing indices.
+     */
+    void emplace_back(const std::vector<std::pair<uint32_t, double>> &x, const double y) {
+        for (const auto &[index, value] : x) {
+            assert(index < m_numFeatures);
+            m_indices.push_back(index);
+            m_values.push_back(value);
+        }
+        m_offsets.push_back(m_indices.size());
+        m_labels.push_back(y);
+    }
+
+    size_t size() const { return m_labels.size(); }
+
+    bool empty() const { return m_labels.empty(); }
+
+    size_t numFeatures() const { return m_numFeatures; }
+
+    size_t nnz() const { return m_indices.size(); }
+
+    SparseVectorView row(const size_t i) const { return view().row(i); }
+
+    double label(const size_t i) const { return m_labels[i]; }
+
+    view_type view() const {
+        return {m_offsets.data(), m_indices.data(), m_values.data(), m_labels.data(), size(),
+                m_numFeatures};
+    }
+
+    operator view_type() const { return view(); }
+
+  private:
+    size_t m_numFeatures;
+    std::vector<size_t> m_offsets;
+    AlignedVector<uint32_t> m_indices;
+    AlignedVector<double> m_values;
+    AlignedVector<double> m_labels;
+};
+} // namespace ml
@@ -0,0 +1,438 @@
+#pragma once
+
+#include <melon/DifferentiableFunction.h>
+#include <melon/GradientDescent.h>
+#include <melon/LinearModel.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticModel.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+#include <melon/Simd.h>
+#include <melon/SparseDataset.h>
+#include <melon/ThreadPool.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <memory>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Regularized cost of a model over a sparse dataset. Evaluations cost O(nnz) for the examples
+ * plus O(numFeatures) for the parameters; sparseStep() performs a plain stochastic gradient
+ * step in O(nnz) of the batch by keeping the L2 decay of the weights in a separate scale.
+ */
+template <typename TModel> class SparseCostFunction {
+  public:
+    using model_type = TModel;
+    using argument_type = typename model_type::parameters_type;
+    using gradient_type = argument_type;
+    using features_type = typename model_type::argument_type;
+    using dataset_view_type = SparseDatasetView;
+
+    /**
+     * Cost over dataset, which must outlive the cost function.
+     */
+    SparseCostFunction(const dataset_view_type &dataset)
+        : m_regularizationFactor{1E-6}, m_dataset(dataset) {}
+
+    const dataset_view_type &dataset() const { return m_dataset; }
+
+    /**
+     * Evaluate cost and gradient on shards of the dataset in parallel on threadPool.
+     */
+    void setThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+    }
+
+    ThreadPool *threadPool() const { return m_threadPool.get(); }
+
+    /**
+     * Evaluate on features x[j] * inverseScales[j] instead of x[j]. Without centering the
+     * scaling keeps zeros at zero, and it is folded into the weights rather than applied to
+     * the examples.
+     */
+    void setFeatureScaling(const features_type &inverseScales) {
+        m_inverseScales = inverseScales;
+        m_scaled = true;
+    }
+
+    /**
+     * Weight of the L2 penalty 0.5 * regularizationFactor * |w|^2 on the non-bias parameters.
+     */
+    double regularizationFactor() const { return m_regularizationFactor; }
+
+    void setRegularizationFactor(const double regularizationFactor) {
+        m_regularizationFactor = regularizationFactor;
+    }
+
+    size_t numExamples() const { return m_dataset.size(); }
+
+    /**
+     * Unbiased estimate of the gradient from the batchSize examples indexed by batch. The
+     * examples cost O(nnz), the dense result O(numFeatures); see sparseStep() for an update
+     * that avoids the latter.
+     */
+    gradient_type batchGradient(const argument_type &input, const size_t *batch,
+                                const size_t batchSize) const {
+        const model_type model(scaleWeights(input));
+        const size_t numFeatures = input.size() - 1;
+        auto grad = zeros<gradient_type>(input.size());
+
+        for (size_t k = 0; k < batchSize; k++) {
+            const SparseVectorView x = m_dataset.row(batch[k]);
+            const double diff = model.eval(x) - m_dataset.label(batch[k]);
+            simd::sparseAxpy(diff, x.indices, x.values, x.size, grad.data());
+            grad[numFeatures] += diff;
+        }
+
+        grad /= static_cast<double>(batchSize);
+        if (m_scaled)
+            simd::mul(grad.data(), m_inverseScales.data(), grad.data(), numFeatures);
+
+        const double regularizationScale =
+            m_regularizationFactor / static_cast<double>(numExamples());
+        for (size_t i = 0; i < numFeatures; i++)
+            grad[i] += regularizationScale * input[i];
+
+        return grad;
+    }
+
+    /**
+     * Plain stochastic gradient step arguments -= learningRate * batchGradient(arguments) on
+     * weights stored as weightScale * arguments, in O(nnz) of the batch: the L2 decay only
+     * multiplies weightScale, and only the weights of features present in the batch move.
+     */
+    void sparseStep(argument_type &arguments, double &weightScale, const size_t *batch,
+                    const size_t batchSize, const double learningRate) const {
+        const size_t numFeatures = arguments.size() - 1;
+        double &bias = arguments[numFeatures];
+
+        std::vector<double> diffs(batchSize);
+        for (size_t k = 0; k < batchSize; k++) {
+            const SparseVectorView x = m_dataset.row(batch[k]);
+            const double score = weightScale * scaledDot(x, arguments.data()) + bias;
+            diffs[k] = model_type::link(score) - m_dataset.label(batch[k]);
+        }
+
+        const double decay = 1.0 - learningRate * m_regularizationFactor /
+                                       static_cast<double>(numExamples());
+        if (decay > 0.0) {
+            weightScale *= decay;
+        } else {
+            std::fill(arguments.begin(), arguments.begin() + numFeatures, 0.0);
+            weightScale = 1.0;
+        }
+
+        const double stepSize = learningRate / static_cast<double>(batchSize);
+        for (size_t k = 0; k < batchSize; k++) {
+            const SparseVectorView x = m_dataset.row(batch[k]);
+            const double alpha = -stepSize * diffs[k] / weightScale;
+            for (size_t n = 0; n < x.size; n++) {
+                const double value = m_scaled ? x.values[n] * m_inverseScales[x.indices[n]]
+                                              : x.values[n];
+                arguments[x.indices[n]] += alpha * value;
+            }
+            bias -= stepSize * diffs[k];
+        }
+
+        // Keep the stored weights representable; this O(numFeatures) pass is rare.
+        if (weightScale < 1E-9)
+            applyWeightScale(arguments, weightScale);
+    }
+
+    /**
+     * Multiply the weights stored by sparseStep() by weightScale and reset it to 1.
+     */
+    void applyWeightScale(argument_type &arguments, double &weightScale) const {
+        simd::mul(arguments.data(), weightScale, arguments.data(), arguments.size() - 1);
+        weightScale = 1.0;
+    }
+
+  protected:
+    /**
+     * Minimum number of examples per shard in parallel evaluation.
+     */
+    static constexpr size_t MinShardSize = 1024;
+
+    /**
+     * Number of examples whose losses are evaluated together.
+     */
+    static constexpr size_t BlockSize = 64;
+
+    /**
+     * Regularized cost, where loss(scores, labels, losses, residuals, n) writes the loss of n
+     * examples and its derivative with respect to their linear scores, as for CostFunction.
+     */
+    template <typename TLoss> double evalLoss(const argument_type &input, TLoss &&loss) const {
+        const LinearModel<model_type::ArgumentDim> linearModel(scaleWeights(input));
+
+        const double cost = shardedReduce(
+            m_threadPool.get(), m_dataset.size(), MinShardSize,
+            [&](const size_t begin, const size_t end) {
+                double scores[BlockSize], losses[BlockSize], residuals[BlockSize];
+                double partialCost = 0.0;
+                for (size_t j = begin; j < end; j += BlockSize) {
+                    const size_t n = std::min(BlockSize, end - j);
+                    for (size_t k = 0; k < n; k++)
+                        scores[k] = linearModel.eval(m_dataset.row(j + k));
+                    loss(scores, m_dataset.labels() + j, losses, residuals, n);
+                    for (size_t k = 0; k < n; k++)
+                        partialCost += losses[k];
+                }
+                return partialCost;
+            },
+            [](double &cost, const double partialCost) { cost += partialCost; });
+
+        return (cost + regularizationTerm(input)) / static_cast<double>(numExamples());
+    }
+
+    /**
+     * Regularized cost and its gradient in a single sweep over the examples, with loss as in
+     * evalLoss().
+     */
+    template <typename TLoss>
+    ValueAndGradient<gradient_type> evalLossWithGradient(const argument_type &input,
+                                                         TLoss &&loss) const {
+        const LinearModel<model_type::ArgumentDim> linearModel(scaleWeights(input));
+        const size_t numFeatures = input.size() - 1;
+
+        auto [cost, grad] = shardedReduce(
+            m_threadPool.get(), m_dataset.size(), MinShardSize,
+            [&](const size_t begin, const size_t end) {
+                ValueAndGradient<gradient_type> partial{0.0, zeros<gradient_type>(input.size())};
+                double scores[BlockSize], losses[BlockSize], residuals[BlockSize];
+                for (size_t j = begin; j < end; j += BlockSize) {
+                    const size_t n = std::min(BlockSize, end - j);
+                    for (size_t k = 0; k < n; k++)
+                        scores[k] = linearModel.eval(m_dataset.row(j + k));
+                    loss(scores, m_dataset.labels() + j, losses, residuals, n);
+
+                    for (size_t k = 0; k < n; k++) {
+                        const SparseVectorView x = m_dataset.row(j + k);
+                        partial.value += losses[k];
+                        simd::sparseAxpy(residuals[k], x.indices, x.values, x.size,
+                                         partial.gradient.data());
+                        partial.gradient[numFeatures] += residuals[k];
+                    }
+                }
+                return partial;
+            },
+            [](ValueAndGradient<gradient_type> &result,
+               const ValueAndGradient<gradient_type> &partial) {
+                result.value += partial.value;
+                result.gradient += partial.gradient;
+            });
+
+        if (m_scaled)
+            simd::mul(grad.data(), m_inverseScales.data(), grad.data(), numFeatures);
+        simd::axpy(m_regularizationFactor, input.data(), grad.data(), numFeatures);
+
+        const double numExamples = static_cast<double>(this->numExamples());
+        grad /= numExamples;
+
+        return {(cost + regularizationTerm(input)) / numExamples, grad};
+    }
+
+    /**
+     * L2 penalty on the weights, the bias term is not regularized.
+     */
+    double regularizationTerm(const argument_type &input) const {
+        return 0.5 * m_regularizationFactor * simd::sumOfSquares(input.data(), input.size() - 1);
+    }
+
+  private:
+    /**
+     * Parameters that apply to unscaled features.
+     */
+    argument_type scaleWeights(const argument_type &input) const {
+        if (!m_scaled)
+            return input;
+
+        argument_type scaled = input;
+        simd::mul(scaled.data(), m_inverseScales.data(), scaled.data(), input.size() - 1);
+        return scaled;
+    }
+
+    double scaledDot(const SparseVectorView &x, const double *weights) const {
+        if (!m_scaled)
+            return dot(x, weights);
+
+        double sum = 0.0;
+        for (size_t n = 0; n < x.size; n++)
+            sum += x.values[n] * m_inverseScales[x.indices[n]] * weights[x.indices[n]];
+        return sum;
+    }
+
+  protected:
+    double m_regularizationFactor;
+    dataset_view_type m_dataset;
+    std::shared_ptr<ThreadPool> m_threadPool;
+    bool m_scaled{false};
+    features_type m_inverseScales{};
+};
+
+template <size_t dim = Dynamic>
+class SparseLinearRegressionCostFunction : public SparseCostFunction<LinearModel<dim>> {
+  public:
+    using argument_type = typename LinearModel<dim>::parameters_type;
+    using gradient_type = argument_type;
+
+    SparseLinearRegressionCostFunction(const SparseDatasetView &dataset)
+        : SparseCostFunction<LinearModel<dim>>(dataset) {}
+
+    double eval(const argument_type &input) const {
+        return this->evalLoss(input, LinearRegressionCostFunction<dim>::loss);
+    }
+
+    gradient_type gradient(const argument_type &input) const {
+        return valueAndGradient(input).gradient;
+    }
+
+    ValueAndGradient<gradient_type> valueAndGradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, LinearRegressionCostFunction<dim>::loss);
+    }
+};
+
+template <size_t dim = Dynamic>
+class SparseLogisticRegressionCostFunction : public SparseCostFunction<LogisticModel<dim>> {
+  public:
+    using argument_type = typename LogisticModel<dim>::parameters_type;
+    using gradient_type = argument_type;
+
+    SparseLogisticRegressionCostFunction(const SparseDatasetView &dataset)
+        : SparseCostFunction<LogisticModel<dim>>(dataset) {}
+
+    double eval(const argument_type &input) const {
+        return this->evalLoss(input, LogisticRegressionCostFunction<dim>::loss);
+    }
+
+    gradient_type gradient(const argument_type &input) const {
+        return valueAndGradient(input).gradient;
+    }
+
+    ValueAndGradient<gradient_type> valueAndGradient(const argument_type &input) const {
+        return this->evalLossWithGradient(input, LogisticRegressionCostFunction<dim>::loss);
+    }
+};
+
+/**
+ * Linear model regression on sparse features. Features are scaled to unit root mean square
+ * instead of being standardized: subtracting the mean would make every entry nonzero.
+ */
+template <typename TModel, typename TCostFunction> class SparseRegression {
+  public:
+    static constexpr size_t ArgumentDim = TModel::ArgumentDim;
+
+    using model_type = TModel;
+    using cost_function_type = TCostFunction;
+    using argument_type = typename model_type::argument_type;
+    using parameters_type = typename model_type::parameters_type;
+    using dataset_view_type = SparseDatasetView;
+
+    SparseRegression &withThreadPool(std::shared_ptr<ThreadPool> threadPool) {
+        m_threadPool = std::move(threadPool);
+        return *this;
+    }
+
+    SparseRegression &withNumThreads(const size_t numThreads) {
+        return withThreadPool(numThreads > 1 ? std::make_shared<ThreadPool>(numThreads) : nullptr);
+    }
+
+    /**
+     * Weight of the L2 penalty on the weights of the fitted model, 1E-6 by default.
+     */
+    SparseRegression &withRegularizationFactor(const double regularizationFactor) {
+        m_regularizationFactor = regularizationFactor;
+        return *this;
+    }
+
+    /**
+     * Seed of the random initial parameters of a fit, so that fits are reproducible.
+     */
+    SparseRegression &withSeed(const uint64_t seed) {
+        m_seed = seed;
+        return *this;
+    }
+
+    void fit(const dataset_view_type &dataset) { fit(dataset, GradientDescent()); }
+
+    /**
+     * Fit with optimizer, any type providing optimize(costFunction, initialParameters).
+     */
+    template <typename TOptimizer>
+    void fit(const dataset_view_type &dataset, const TOptimizer &optimizer) {
+        computeInverseScales(dataset);
+
+        cost_function_type costFunction(dataset);
+        costFunction.setThreadPool(m_threadPool);
+        costFunction.setRegularizationFactor(m_regularizationFactor);
+        costFunction.setFeatureScaling(m_inverseScales);
+
+        const auto initialParameters =
+            Random(m_seed).uniform<parameters_type>(augmentedDim(dataset.numFeatures()), -0.5, 0.5);
+        const auto result = optimizer.optimize(costFunction, initialParameters);
+
+        m_model.setParameters(result.optimalArguments);
+        auto parameters = result.optimalArguments;
+        simd::mul(parameters.data(), m_inverseScales.data(), parameters.data(),
+                  dataset.numFeatures());
+        m_scoringModel.setParameters(parameters);
+    }
+
+    double predict(const SparseVectorView &x) const { return m_scoringModel.eval(x); }
+
+    /**
+     * Predictions for every row of dataset, written to out.
+     */
+    void predictBatch(const dataset_view_type &dataset, double *out) const {
+        for (size_t i = 0; i < dataset.size(); i++)
+            out[i] = m_scoringModel.eval(dataset.row(i));
+    }
+
+    /**
+     * Model fitted on the scaled features.
+     */
+    const model_type &model() const { return m_model; }
+
+    /**
+     * Model with the scaling folded into its weights, so that it applies to raw features.
+     */
+    const model_type &scoringModel() const { return m_scoringModel; }
+
+  protected:
+    /**
+     * Inverse root mean square of every feature over all examples, zeros included, in a pass
+     * over the nonzeros. Features that never occur keep a scale of 1.
+     */
+    void computeInverseScales(const dataset_view_type &dataset) {
+        m_inverseScales = zeros<argument_type>(dataset.numFeatures());
+        for (size_t i = 0; i < dataset.size(); i++) {
+            const SparseVectorView x = dataset.row(i);
+            for (size_t n = 0; n < x.size; n++)
+                m_inverseScales[x.indices[n]] += x.values[n] * x.values[n];
+        }
+
+        const double numExamples = static_cast<double>(std::max<size_t>(1, dataset.size()));
+        for (auto &scale : m_inverseScales)
+            scale = scale > 0.0 ? std::sqrt(numExamples / scale) : 1.0;
+    }
+
+    double m_regularizationFactor{1E-6};
+    uint64_t m_seed{Random::DefaultSeed};
+    argument_type m_inverseScales;
+    model_type m_model;
+    model_type m_scoringModel;
+    std::shared_ptr<ThreadPool> m_threadPool;
+};
+
+template <size_t dim = Dynamic>
+class SparseLinearRegression
+    : public SparseRegression<LinearModel<dim>, SparseLinearRegressionCostFunction<dim>> {};
+
+template <size_t dim = Dynamic>
+class SparseLogisticRegression
+    : public SparseRegression<LogisticModel<dim>, SparseLogisticRegressionCostFunction<dim>> {};
+} // namespace ml
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <melon/DifferentiableFunction.h>
+#include <melon/OptimizationObserver.h>
+#include <melon/Random.h>
+#include <melon/Types.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Mini-batch stochastic gradient descent. Works on differentiable functions that are sums over
+ * examples and provide numExamples() and batchGradient(arguments, batch, batchSize) next to
+ * eval() and gradient(). Functions that read their examples in chunks and provide chunkSize()
+ * get batches that stay within a chunk, and chunks are visited once per epoch in random order.
+ * Plain steps on functions that provide sparseStep() cost O(nnz) of the batch instead of
+ * O(numFeatures).
+ */
+class StochasticGradientDescent {
+  public:
+    enum class Method { Plain, Momentum, Nesterov, Adam };
+
+    /**
+     * Learning rate at epoch t: Constant keeps learningRate, InverseTime uses
+     * learningRate / (1 + decayRate * t) and Exponential learningRate * decayFactor^t.
+     */
+    enum class Schedule { Constant, InverseTime, Exponential };
+
+    struct HyperParameters {
+        Method method = Method::Adam;
+        Schedule schedule = Schedule::Constant;
+        size_t batchSize = 32;
+        size_t maxEpochs = 100;
+        bool shuffle = true;
+        double learningRate = 0.01;
+        double decayRate = 0.0;   // InverseTime, >= 0
+        double decayFactor = 0.9; // Exponential, (0, 1]
+        double momentum = 0.9;    // Momentum and Nesterov, [0, 1)
+        double beta1 = 0.9;       // Adam first moment decay, [0, 1)
+        double beta2 = 0.999;     // Adam second moment decay, [0, 1)
+        double epsilon = 1E-8;    // Adam denominator offset
+        double relativeStepTolerance = 1E-9;
+        uint64_t seed = Random::DefaultSeed;
+    };
+
+    /**
+     * Learning rate of the given epoch under the configured schedule.
+     */
+    double scheduledLearningRate(const size_t epoch) const {
+        const double t = static_cast<double>(epoch);
+        switch (m_hyperParameters.schedule) {
+        case Schedule::InverseTime:
+            assert(m_hyperParameters.decayRate >= 0.0);
+            return m_hyperParameters.learningRate / (1.0 + m_hyperParameters.decayRate * t);
+        case Schedule::Exponential:
+            assert(m_hyperParameters.decayFactor > 0.0 && m_hyperParameters.decayFactor <= 1.0);
+            return m_hyperParameters.learningRate * std::pow(m_hyperParameters.decayFactor, t);
+        case Schedule::Constant:
+        default:
+            return m_hyperParameters.learningRate;
+        }
+    }
+
+    template <typename TArguments> using Result = OptimizationResult<TArguments>;
+
+    StochasticGradientDescent &withHyperParameters(const HyperParameters hyperParameters) {
+        m_hyperParameters = hyperParameters;
+        return *this;
+    }
+
+    /**
+     * Run epochs over shuffled mini-batches until maxEpochs or until an epoch moves the
+     * arguments by less than relativeStepTolerance relative to their length. The result counts
+     * epochs as iterations and mini-batch gradients as gradient evaluations.
+     */
+    template <typename TDifferentiableFunction>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &function,
+             const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        NullObserver observer;
+        return optimize(function, initialArguments, observer);
+    }
+
+    /**
+     * Optimize, reporting every epoch and evaluation to observer. Each epoch is reported with
+     * the full cost at its end and the full gradient norm at its start, which costs one pass
+     * over the examples per epoch on top of the mini-batches.
+     */
+    template <typename TDifferentiableFunction, typename TObserver>
+    Result<typename TDifferentiableFunction::argument_type>
+    optimize(const TDifferentiableFunction &unobservedFunction,
+             const typename TDifferentiableFunction::argument_type &initialArguments,
+             TObserver &observer) const {
+        using argument_type = typename TDifferentiableFunction::argument_type;
+        const auto &function = observe(unobservedFunction, observer);
+
+        const size_t numExamples = function.numExamples();
+        const size_t batchSize = std::max<size_t>(1, m_hyperParameters.batchSize);
+        const size_t chunkSize = std::max<size_t>(1, chunkSizeOf(function));
+        std::vector<size_t> indices(numExamples);
+        std::iota(indices.begin(), indices.end(), 0);
+        std::vector<size_t> chunks((numExamples + chunkSize - 1) / chunkSize);
+        std::iota(chunks.begin(), chunks.end(), 0);
+        Random random(m_hyperParameters.seed);
+
+        argument_type arguments = initialArguments;
+        auto velocity = zeros<argument_type>(arguments.size());
+        auto secondMoment = zeros<argument_type>(arguments.size());
+        size_t numSteps = 0, numEpochs = 0;
+
+        constexpr bool hasSparseStep = HasSparseStep<TDifferentiableFunction>::value;
+        const bool sparse = hasSparseStep && m_hyperParameters.method == Method::Plain;
+        double weightScale = 1.0;
+        StopReason stopReason = StopReason::MaxIterations;
+        double gradientNorm = 0.0;
+        if constexpr (TObserver::Enabled)
+            gradientNorm = std::sqrt(sqLength(evalWithGradient(function, arguments).gradient));
+
+        for (size_t epoch = 0; epoch < m_hyperParameters.maxEpochs; epoch++) {
+            numEpochs++;
+            if (m_hyperParameters.shuffle)
+                random.shuffle(chunks.begin(), chunks.end());
+
+            const double learningRate = scheduledLearningRate(epoch);
+            const argument_type epochStart = arguments;
+
+            for (const size_t chunk : chunks) {
+                const size_t chunkBegin = chunk * chunkSize;
+                const size_t chunkEnd = std::min(chunkBegin + chunkSize, numExamples);
+                if (m_hyperParameters.shuffle)
+                    random.shuffle(indices.begin() + chunkBegin, indices.begin() + chunkEnd);
+
+                for (size_t begin = chunkBegin; begin < chunkEnd; begin += batchSize) {
+                    const size_t size = std::min(batchSize, chunkEnd - begin);
+                    if constexpr (hasSparseStep) {
+                        if (sparse) {
+                            function.sparseStep(arguments, weightScale, indices.data() + begin,
+                                                size, learningRate);
+                            ++numSteps;
+                            continue;
+                        }
+                    }
+
+                    const auto gradientAt = [&](const argument_type &x) {
+                        return function.batchGradient(x, indices.data() + begin, size);
+                    };
+
+                    step(gradientAt, learningRate, ++numSteps, arguments, velocity, secondMoment);
+                }
+            }
+
+            if constexpr (hasSparseStep) {
+                if (sparse)
+                    function.applyWeightScale(arguments, weightScale);
+            }
+
+            const double stepLength = std::sqrt(sqLength(arguments - epochStart));
+            if constexpr (TObserver::Enabled) {
+                const auto [value, gradient] = evalWithGradient(function, arguments);
+                if (!observer.onIteration({numEpochs, value, gradientNorm, stepLength, 0})) {
+                    stopReason = StopReason::Observer;
+                    break;
+                }
+                gradientNorm = std::sqrt(sqLength(gradient));
+            }
+
+            if (stepLength <= m_hyperParameters.relativeStepTolerance *
+                                  std::max(1.0, std::sqrt(sqLength(arguments)))) {
+                stopReason = StopReason::Converged;
+                break;
+            }
+        }
+
+        return {arguments, function.eval(arguments), numEpochs, 1, numSteps, stopReason};
+    }
+
+  private:
+    template <typename TFunction> static size_t chunkSizeOf(const TFunction &function) {
+        if constexpr (HasChunkSize<TFunction>::value)
+            return function.chunkSize();
+        else
+            return function.numExamples();
+    }
+
+    template <typename TGradientAt, typename TArguments>
+    void step(TGradientAt &&gradientAt, const double learningRate, const size_t numSteps,
+              TArguments &arguments, TArguments &velocity, TArguments &secondMoment) const {
+        const double momentum = m_hyperParameters.momentum;
+
+        switch (m_hyperParameters.method) {
+        case Method::Plain:
+            arguments = arguments - learningRate * gradientAt(arguments);
+            break;
+        case Method::Momentum:
+            velocity = momentum * velocity - learningRate * gradientAt(arguments);
+            arguments += velocity;
+            break;
+        case Method::Nesterov:
+            velocity = momentum * velocity -
+                       learningRate * gradientAt(arguments + momentum * velocity);
+            arguments += velocity;
+            break;
+        case Method::Adam: {
+            const double beta1 = m_hyperParameters.beta1, beta2 = m_hyperParameters.beta2;
+            const auto gradient = gradientAt(arguments);
+            velocity = beta1 * velocity + (1.0 - beta1) * gradient;
+            secondMoment = beta2 * secondMoment + (1.0 - beta2) * (gradient * gradient);
+
+            const double t = static_cast<double>(numSteps);
+            const double stepSize = learningRate * std::sqrt(1.0 - std::pow(beta2, t)) /
+                                    (1.0 - std::pow(beta1, t));
+            for (size_t i = 0; i < arguments.size(); i++)
+                arguments[i] -= stepSize * velocity[i] /
+                                (std::sqrt(secondMoment[i]) + m_hyperParameters.epsilon);
+            break;
+        }
+        }
+    }
+
+  private:
+    HyperParameters m_hyperParameters;
+};
+} // namespace ml
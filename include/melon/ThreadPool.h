@@ -0,0 +1,294 @@
+#pragma once
+
+#include <melon/AlignedAllocator.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ml {
+
+/**
+ * Fixed-size pool of threads executing data-parallel loops. The calling thread takes part in
+ * every loop as worker 0, so a pool of size n owns n - 1 worker threads, numbered from 1.
+ */
+class ThreadPool {
+  public:
+    explicit ThreadPool(const size_t numThreads = std::thread::hardware_concurrency())
+        : m_numThreads(std::max<size_t>(1, numThreads)),
+          m_ranges(std::make_unique<TaskRange[]>(m_numThreads)) {
+        for (size_t i = 1; i < m_numThreads; i++)
+            m_workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_wakeUp.notify_all();
+
+        for (auto &worker : m_workers)
+            worker.join();
+    }
+
+    size_t size() const { return m_numThreads; }
+
+    /**
+     * Run task(i) for every i in [0, numTasks) and wait for all of them to complete. Loops
+     * started from within a task of this pool run serially on the calling thread.
+     */
+    template <typename TTask> void parallelFor(const size_t numTasks, TTask &&task) {
+        if (m_workers.empty() || numTasks < 2 || currentPool() == this) {
+            for (size_t i = 0; i < numTasks; i++)
+                task(i);
+            return;
+        }
+
+        std::lock_guard<std::mutex> loopLock(m_loopMutex);
+        m_nextTask = 0;
+        runLoop(numTasks, [&](size_t) {
+            size_t i;
+            while ((i = m_nextTask.fetch_add(1)) < numTasks) {
+                task(i);
+                finishTask();
+            }
+        });
+    }
+
+    /**
+     * Run task(i, worker) for every i in [0, numTasks) and wait for all of them to complete,
+     * where worker in [0, size()) is the thread running the task, for instance to index
+     * per-worker scratch space. Tasks are dealt round-robin, so thread w starts with tasks w,
+     * w + size(), w + 2 size() and so on, which it runs in order: when tasks are listed from
+     * most to least expensive, every thread starts on one of the most expensive ones. A thread
+     * whose tasks are exhausted steals the upper half of the remaining tasks of another thread,
+     * so tasks of very uneven cost keep all threads busy without a shared counter. Loops
+     * started from within a task of this pool run serially on the calling thread, with its
+     * worker index.
+     */
+    template <typename TTask> void parallelForWorkStealing(const size_t numTasks, TTask &&task) {
+        if (m_workers.empty() || numTasks < 2 || currentPool() == this) {
+            const size_t worker = currentPool() == this ? currentWorker() : 0;
+            for (size_t i = 0; i < numTasks; i++)
+                task(i, worker);
+            return;
+        }
+
+        assert(numTasks <= UINT32_MAX);
+        std::lock_guard<std::mutex> loopLock(m_loopMutex);
+
+        // Ranges hold positions: the first numTasks % size() threads are dealt one more task
+        // than the others, and position k of the range of thread w is task w + k * size().
+        const size_t perThread = numTasks / m_numThreads, extra = numTasks % m_numThreads;
+        const auto rangeStart = [&](const size_t w) { return w * perThread + std::min(w, extra); };
+        const auto taskAt = [&](const size_t position) {
+            const size_t longRanges = extra * (perThread + 1);
+            const size_t w = position < longRanges
+                                 ? position / (perThread + 1)
+                                 : extra + (position - longRanges) / perThread;
+            return w + (position - rangeStart(w)) * m_numThreads;
+        };
+
+        for (size_t w = 0; w < m_numThreads; w++)
+            m_ranges[w].bounds.store(packRange(rangeStart(w), rangeStart(w + 1)));
+
+        runLoop(numTasks, [&](const size_t worker) {
+            size_t position;
+            while (nextTask(worker, position)) {
+                task(taskAt(position), worker);
+                finishTask();
+            }
+        });
+    }
+
+  private:
+    /**
+     * Remaining tasks [begin, end) of a thread, packed into one word so that the owner and the
+     * thieves update it with a single compare-and-swap.
+     */
+    struct alignas(CacheLineSize) TaskRange {
+        std::atomic<uint64_t> bounds{0};
+    };
+
+    static uint64_t packRange(const uint64_t begin, const uint64_t end) {
+        return (end << 32) | begin;
+    }
+
+    static size_t rangeBegin(const uint64_t bounds) { return bounds & UINT32_MAX; }
+
+    static size_t rangeEnd(const uint64_t bounds) { return bounds >> 32; }
+
+    static const ThreadPool *&currentPool() {
+        thread_local const ThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    static size_t &currentWorker() {
+        thread_local size_t worker = 0;
+        return worker;
+    }
+
+    /**
+     * Run job(worker) on every thread of the pool for a loop of numTasks tasks, each of which
+     * calls finishTask(), and wait for all of them. The caller holds m_loopMutex.
+     */
+    template <typename TJob> void runLoop(const size_t numTasks, TJob &&job) {
+        const std::function<void(size_t)> function(std::ref(job));
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_job = &function;
+            m_pendingTasks = numTasks;
+            m_generation++;
+        }
+        m_wakeUp.notify_all();
+
+        runJob(0);
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_pendingTasks == 0 && m_activeWorkers == 0; });
+        m_job = nullptr;
+    }
+
+    void finishTask() {
+        if (m_pendingTasks.fetch_sub(1) == 1) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_done.notify_all();
+        }
+    }
+
+    /**
+     * Take the first position of the range of worker, or steal from the range of another
+     * thread. Returns false when all ranges are empty.
+     */
+    bool nextTask(const size_t worker, size_t &task) {
+        std::atomic<uint64_t> &own = m_ranges[worker].bounds;
+        uint64_t bounds = own.load();
+        while (rangeBegin(bounds) < rangeEnd(bounds)) {
+            if (own.compare_exchange_weak(bounds,
+                                          packRange(rangeBegin(bounds) + 1, rangeEnd(bounds)))) {
+                task = rangeBegin(bounds);
+                return true;
+            }
+        }
+
+        bool remaining = true;
+        while (remaining) {
+            remaining = false;
+            for (size_t k = 1; k < m_numThreads; k++) {
+                std::atomic<uint64_t> &victim = m_ranges[(worker + k) % m_numThreads].bounds;
+                bounds = victim.load();
+                while (rangeBegin(bounds) < rangeEnd(bounds)) {
+                    remaining = true;
+                    const size_t begin = rangeBegin(bounds), end = rangeEnd(bounds);
+                    const size_t middle = end - (end - begin + 1) / 2;
+                    if (victim.compare_exchange_weak(bounds, packRange(begin, middle))) {
+                        own.store(packRange(middle + 1, end));
+                        task = middle;
+                        return true;
+                    }
+                }
+            }
+        }
+
+        return false;
+    }
+
+    void workerLoop(const size_t worker) {
+        size_t generation = 0;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_wakeUp.wait(lock, [&] { return m_stop || m_generation != generation; });
+                if (m_stop)
+                    return;
+
+                generation = m_generation;
+                if (m_job == nullptr)
+                    continue;
+
+                m_activeWorkers++;
+            }
+
+            runJob(worker);
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_activeWorkers--;
+            }
+            m_done.notify_all();
+        }
+    }
+
+    void runJob(const size_t worker) {
+        const ThreadPool *previousPool = currentPool();
+        const size_t previousWorker = currentWorker();
+        currentPool() = this;
+        currentWorker() = worker;
+
+        (*m_job)(worker);
+
+        currentPool() = previousPool;
+        currentWorker() = previousWorker;
+    }
+
+  private:
+    size_t m_numThreads;
+    std::unique_ptr<TaskRange[]> m_ranges;
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_loopMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wakeUp;
+    std::condition_variable m_done;
+
+    const std::function<void(size_t)> *m_job{nullptr};
+    std::atomic<size_t> m_nextTask{0};
+    std::atomic<size_t> m_pendingTasks{0};
+    size_t m_activeWorkers{0};
+    size_t m_generation{0};
+    bool m_stop{false};
+};
+
+/**
+ * Split [0, size) into at most pool->size() contiguous shards of at least minShardSize items,
+ * evaluate map(begin, end) for every shard in parallel and fold the partial results with combine
+ * in shard order. For a given pool size the result does not depend on thread scheduling. A null
+ * pool evaluates a single shard on the calling thread.
+ */
+template <typename TMap, typename TCombine>
+auto shardedReduce(ThreadPool *pool, const size_t size, const size_t minShardSize, TMap &&map,
+                   TCombine &&combine) -> decltype(map(size_t(0), size)) {
+    using partial_type = decltype(map(size_t(0), size));
+
+    const size_t maxShards = pool == nullptr ? 1 : pool->size();
+    const size_t numShards =
+        std::max<size_t>(1, std::min(maxShards, size / std::max<size_t>(1, minShardSize)));
+
+    if (pool == nullptr || numShards == 1)
+        return map(size_t(0), size);
+
+    std::vector<partial_type> partials(numShards);
+    pool->parallelFor(numShards, [&](const size_t shard) {
+        partials[shard] = map(shard * size / numShards, (shard + 1) * size / numShards);
+    });
+
+    partial_type result = std::move(partials[0]);
+    for (size_t shard = 1; shard < numShards; shard++)
+        combine(result, partials[shard]);
+
+    return result;
+}
+} // namespace ml
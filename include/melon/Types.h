@@ -1,77 +1,473 @@
 #pragma once
 
+#include <melon/AlignedAllocator.h>
+#include <melon/Simd.h>
+
 #include <algorithm>
 #include <array>
+#include <cassert>
+#include <cstdint>
 #include <functional>
+#include <initializer_list>
+#include <limits>
 #include <numeric>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 #include <vector>
 
 namespace ml {
-template <size_t dim> using Vector = std::array<double, dim>;
+
+/**
+ * Dimension of vectors, models and datasets whose size is only known at runtime.
+ */
+constexpr size_t Dynamic = std::numeric_limits<size_t>::max();
+
+/**
+ * Number of parameters of a linear model on dim features, the weights plus the bias.
+ */
+constexpr size_t augmentedDim(const size_t dim) { return dim == Dynamic ? Dynamic : dim + 1; }
+
+/**
+ * Vector of doubles sized at runtime, stored in a cache line aligned heap buffer.
+ */
+class DynamicVector {
+  public:
+    using value_type = double;
+    using iterator = double *;
+    using const_iterator = const double *;
+
+    DynamicVector() = default;
+
+    explicit DynamicVector(const size_t size, const double value = 0.0) : m_data(size, value) {}
+
+    DynamicVector(std::initializer_list<double> values) : m_data(values) {}
+
+    template <typename TIterator, typename = std::enable_if_t<!std::is_arithmetic_v<TIterator>>>
+    DynamicVector(TIterator first, TIterator last) : m_data(first, last) {}
+
+    size_t size() const { return m_data.size(); }
+
+    bool empty() const { return m_data.empty(); }
+
+    double *data() { return m_data.data(); }
+
+    const double *data() const { return m_data.data(); }
+
+    double &operator[](const size_t i) { return m_data[i]; }
+
+    double operator[](const size_t i) const { return m_data[i]; }
+
+    double &back() { return m_data.back(); }
+
+    double back() const { return m_data.back(); }
+
+    iterator begin() { return m_data.data(); }
+
+    iterator end() { return m_data.data() + m_data.size(); }
+
+    const_iterator begin() const { return m_data.data(); }
+
+    const_iterator end() const { return m_data.data() + m_data.size(); }
+
+    bool operator==(const DynamicVector &other) const { return m_data == other.m_data; }
+
+    bool operator!=(const DynamicVector &other) const { return m_data != other.m_data; }
+
+  private:
+    AlignedVector<double> m_data;
+};
+
+namespace detail {
+template <size_t dim> struct VectorType {
+    using type = std::array<double, dim>;
+};
+
+template <> struct VectorType<Dynamic> {
+    using type = DynamicVector;
+};
+} // namespace detail
+
+/**
+ * Vector of dim doubles: a std::array for dimensions fixed at compile time, a DynamicVector for
+ * Dynamic.
+ */
+template <size_t dim> using Vector = typename detail::VectorType<dim>::type;
+/**
+ * Non-owning view of a sparse vector: size values at distinct, increasing indices.
+ */
+struct SparseVectorView {
+    const uint32_t *indices{nullptr};
+    const double *values{nullptr};
+    size_t size{0};
+};
+
 template <size_t dim> using TrainingExample = std::pair<Vector<dim>, double>;
 template <size_t dim> using TrainingSet = std::vector<TrainingExample<dim>>;
 
-template <size_t dim> Vector<dim> operator+(const Vector<dim> &vec, const double s) {
-    Vector<dim> result;
-    std::transform(vec.begin(), vec.end(), result.begin(), [s](double x) { return x + s; });
-    return result;
+/**
+ * Vector of size zeros. The size of fixed dimension vectors is given by their type.
+ */
+template <typename TVector> TVector zeros(const size_t size) {
+    if constexpr (std::is_same_v<TVector, DynamicVector>) {
+        return DynamicVector(size);
+    } else {
+        assert(size == std::tuple_size<TVector>::value);
+        return TVector{};
+    }
 }
 
-template <size_t dim> void operator+=(Vector<dim> &lhs, const Vector<dim> &rhs) {
-    std::transform(lhs.begin(), lhs.end(), rhs.begin(), lhs.begin(),
-                   [](double xlhs, double xrhs) { return xlhs + xrhs; });
+namespace detail {
+
+template <typename T> struct VectorTraits {
+    static constexpr bool IsVector = false;
+};
+
+template <size_t dim> struct VectorTraits<std::array<double, dim>> {
+    static constexpr bool IsVector = true;
+    static constexpr size_t Dim = dim;
+};
+
+template <> struct VectorTraits<DynamicVector> {
+    static constexpr bool IsVector = true;
+    static constexpr size_t Dim = Dynamic;
+};
+
+/**
+ * Operand of an expression that refers to a vector, which must outlive the expression.
+ */
+struct VectorReference {
+    const double *data;
+    size_t length;
+
+    size_t size() const { return length; }
+
+    double operator[](const size_t i) const { return data[i]; }
+};
+
+/**
+ * Operand of an expression that owns a temporary vector.
+ */
+template <typename TVector> struct VectorValue {
+    TVector vector;
+
+    size_t size() const { return vector.size(); }
+
+    double operator[](const size_t i) const { return vector[i]; }
+};
+
+/**
+ * Operand of an expression that is the same scalar for every element.
+ */
+struct ScalarOperand {
+    double value;
+
+    size_t size() const { return 0; }
+
+    double operator[](const size_t) const { return value; }
+};
+} // namespace detail
+
+template <size_t dim, typename TFunction, typename... TOperands> class VectorExpression;
+
+template <typename T> struct IsVectorExpression : std::false_type {};
+
+template <size_t dim, typename TFunction, typename... TOperands>
+struct IsVectorExpression<VectorExpression<dim, TFunction, TOperands...>> : std::true_type {};
+
+/**
+ * Vectors and vector expressions, the types vector operators apply to.
+ */
+template <typename T>
+constexpr bool IsVectorLike = detail::VectorTraits<std::decay_t<T>>::IsVector ||
+                              IsVectorExpression<std::decay_t<T>>::value;
+
+/**
+ * Element-wise expression over vectors and scalars, evaluated lazily: element i is
+ * function(operands[i]...). An expression is evaluated in a single loop, without temporaries
+ * for its subexpressions, when it is converted to a vector or reduced by sqLength() or dot().
+ *
+ * Expressions refer to the vectors they were built from unless these were temporaries, which
+ * they own: an expression stored with auto sees later changes to those vectors.
+ */
+template <size_t dim, typename TFunction, typename... TOperands> class VectorExpression {
+  public:
+    static constexpr size_t Dim = dim;
+    using vector_type = Vector<dim>;
+
+    explicit VectorExpression(TFunction function, TOperands... operands)
+        : m_function(std::move(function)), m_operands(std::move(operands)...) {
+        assert(std::apply(
+            [&](const auto &...operands) {
+                return ((operands.size() == 0 || operands.size() == size()) && ...);
+            },
+            m_operands));
+    }
+
+    size_t size() const {
+        if constexpr (dim != Dynamic)
+            return dim;
+        else
+            return std::apply(
+                [](const auto &...operands) { return std::max({operands.size()...}); },
+                m_operands);
+    }
+
+    double operator[](const size_t i) const {
+        return std::apply([&](const auto &...operands) { return m_function(operands[i]...); },
+                          m_operands);
+    }
+
+    /**
+     * Write elements [begin, end) to out, which may be the storage of an operand.
+     */
+    void evalTo(double *out, const size_t begin, const size_t end) const {
+        for (size_t i = begin; i < end; i++)
+            out[i - begin] = (*this)[i];
+    }
+
+    void evalTo(double *out) const { evalTo(out, 0, size()); }
+
+    vector_type eval() const {
+        vector_type result;
+        if constexpr (dim == Dynamic)
+            result = DynamicVector(size());
+        evalTo(result.data());
+        return result;
+    }
+
+    operator vector_type() const { return eval(); }
+
+  private:
+    TFunction m_function;
+    std::tuple<TOperands...> m_operands;
+};
+
+namespace detail {
+
+template <typename T> constexpr size_t dimOf() {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_arithmetic_v<D>)
+        return 0;
+    else if constexpr (IsVectorExpression<D>::value)
+        return D::Dim;
+    else
+        return VectorTraits<D>::Dim;
 }
 
-template <size_t dim> Vector<dim> operator-(const Vector<dim> &lhs, const Vector<dim> &rhs) {
-    Vector<dim> result;
-    std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(),
-                   [](double xlhs, double xrhs) { return xlhs - xrhs; });
+/**
+ * Dimension shared by the vector operands among T..., or 0 if they do not all agree.
+ */
+template <typename... T> constexpr size_t commonDim() {
+    size_t result = 0;
+    for (const size_t dim : {dimOf<T>()...}) {
+        if (dim != 0 && result != 0 && dim != result)
+            return 0;
+        if (dim != 0)
+            result = dim;
+    }
     return result;
 }
 
-template <size_t dim> Vector<dim> operator*(const Vector<dim> &lhs, const Vector<dim> &rhs) {
-    Vector<dim> result;
-    std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(),
-                   [](double xlhs, double xrhs) { return xlhs * xrhs; });
-    return result;
+template <typename T> auto makeOperand(T &&x) {
+    using D = std::decay_t<T>;
+    if constexpr (std::is_arithmetic_v<D>)
+        return ScalarOperand{static_cast<double>(x)};
+    else if constexpr (IsVectorExpression<D>::value)
+        return D(std::forward<T>(x));
+    else if constexpr (std::is_lvalue_reference_v<T>)
+        return VectorReference{x.data(), x.size()};
+    else
+        return VectorValue<D>{std::move(x)};
 }
 
-template <size_t dim> Vector<dim> operator*(const Vector<dim> &vec, const double s) {
-    Vector<dim> result;
-    std::transform(vec.begin(), vec.end(), result.begin(), [s](double x) { return x * s; });
-    return result;
+template <typename L, typename R>
+constexpr bool IsVectorOperation =
+    (IsVectorLike<L> || IsVectorLike<R>) &&
+    (IsVectorLike<L> || std::is_arithmetic_v<std::decay_t<L>>) &&
+    (IsVectorLike<R> || std::is_arithmetic_v<std::decay_t<R>>);
+
+template <typename TVector, typename R>
+using EnableCompoundAssignment =
+    std::enable_if_t<VectorTraits<TVector>::IsVector && IsVectorOperation<TVector, R>>;
+} // namespace detail
+
+/**
+ * Lazy element-wise application of function, any callable, to vectors, vector expressions and
+ * scalars of which at least one is a vector or an expression: element i is
+ * function(operands[i]...).
+ */
+template <typename TFunction, typename... TOperands>
+auto map(TFunction function, TOperands &&...operands) {
+    constexpr size_t dim = detail::commonDim<TOperands...>();
+    static_assert(dim != 0, "map() requires vector operands of the same dimension");
+
+    return VectorExpression<dim, TFunction,
+                            decltype(detail::makeOperand(std::forward<TOperands>(operands)))...>(
+        std::move(function), detail::makeOperand(std::forward<TOperands>(operands))...);
 }
 
-template <size_t dim> Vector<dim> operator*(const double s, const Vector<dim> &vec) {
-    return vec * s;
+template <typename L, typename R, typename = std::enable_if_t<detail::IsVectorOperation<L, R>>>
+auto operator+(L &&lhs, R &&rhs) {
+    return map(std::plus<>(), std::forward<L>(lhs), std::forward<R>(rhs));
 }
 
-template <size_t dim> void operator/=(Vector<dim> &vec, const double s) {
-    std::transform(vec.begin(), vec.end(), vec.begin(), [s](double x) { return x / s; });
+template <typename L, typename R, typename = std::enable_if_t<detail::IsVectorOperation<L, R>>>
+auto operator-(L &&lhs, R &&rhs) {
+    return map(std::minus<>(), std::forward<L>(lhs), std::forward<R>(rhs));
 }
 
-template <size_t dim> Vector<dim> operator/(const Vector<dim> &lhs, const Vector<dim> &rhs) {
-    Vector<dim> result;
-    std::transform(lhs.begin(), lhs.end(), rhs.begin(), result.begin(),
-                   [](double xlhs, double xrhs) { return xlhs / xrhs; });
-    return result;
+template <typename T, typename = std::enable_if_t<IsVectorLike<T>>> auto operator-(T &&x) {
+    return map(std::negate<>(), std::forward<T>(x));
+}
+
+template <typename L, typename R, typename = std::enable_if_t<detail::IsVectorOperation<L, R>>>
+auto operator*(L &&lhs, R &&rhs) {
+    return map(std::multiplies<>(), std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+/**
+ * Element-wise quotient; division by a scalar multiplies by its reciprocal.
+ */
+template <typename L, typename R, typename = std::enable_if_t<detail::IsVectorOperation<L, R>>>
+auto operator/(L &&lhs, R &&rhs) {
+    if constexpr (std::is_arithmetic_v<std::decay_t<R>>)
+        return map(std::multiplies<>(), std::forward<L>(lhs), 1.0 / rhs);
+    else
+        return map(std::divides<>(), std::forward<L>(lhs), std::forward<R>(rhs));
+}
+
+template <typename TVector, typename R, typename = detail::EnableCompoundAssignment<TVector, R>>
+TVector &operator+=(TVector &lhs, R &&rhs) {
+    map(std::plus<>(), lhs, std::forward<R>(rhs)).evalTo(lhs.data());
+    return lhs;
+}
+
+template <typename TVector, typename R, typename = detail::EnableCompoundAssignment<TVector, R>>
+TVector &operator-=(TVector &lhs, R &&rhs) {
+    map(std::minus<>(), lhs, std::forward<R>(rhs)).evalTo(lhs.data());
+    return lhs;
+}
+
+template <typename TVector, typename R, typename = detail::EnableCompoundAssignment<TVector, R>>
+TVector &operator*=(TVector &lhs, R &&rhs) {
+    map(std::multiplies<>(), lhs, std::forward<R>(rhs)).evalTo(lhs.data());
+    return lhs;
+}
+
+template <typename TVector, typename R, typename = detail::EnableCompoundAssignment<TVector, R>>
+TVector &operator/=(TVector &lhs, R &&rhs) {
+    map(std::divides<>(), lhs, std::forward<R>(rhs)).evalTo(lhs.data());
+    return lhs;
+}
+
+template <typename TVector, size_t dim, typename TFunction, typename... TOperands,
+          typename = std::enable_if_t<detail::VectorTraits<TVector>::IsVector>>
+bool operator==(const TVector &lhs, const VectorExpression<dim, TFunction, TOperands...> &rhs) {
+    return lhs == rhs.eval();
 }
 
-template <size_t dim> Vector<dim> operator/(const Vector<dim> &vec, const double s) {
-    return vec * (1.0 / s);
+template <typename TVector, size_t dim, typename TFunction, typename... TOperands,
+          typename = std::enable_if_t<detail::VectorTraits<TVector>::IsVector>>
+bool operator==(const VectorExpression<dim, TFunction, TOperands...> &lhs, const TVector &rhs) {
+    return lhs.eval() == rhs;
+}
+
+namespace detail {
+
+constexpr size_t ReductionBlockSize = 256;
+
+/**
+ * Elements [begin, end) of x: in place for vectors, evaluated into buffer for expressions.
+ */
+template <typename T>
+const double *elements(const T &x, const size_t begin, const size_t end, double *buffer) {
+    if constexpr (IsVectorExpression<T>::value) {
+        x.evalTo(buffer, begin, end);
+        return buffer;
+    } else {
+        return x.data() + begin;
+    }
 }
+} // namespace detail
 
 template <typename T> double sqLength(const T &vec) {
     return std::inner_product(vec.begin(), vec.end(), vec.begin(), 0.0);
 }
 
-template <> double sqLength(const double &sc) { return sc * sc; }
+template <> inline double sqLength(const double &sc) { return sc * sc; }
+
+template <size_t dim> double sqLength(const std::array<double, dim> &vec) {
+    return simd::sumOfSquares(vec.data(), dim);
+}
+
+inline double sqLength(const DynamicVector &vec) {
+    return simd::sumOfSquares(vec.data(), vec.size());
+}
+
+/**
+ * Squared length of an expression, evaluated block by block into a buffer that stays in cache
+ * and reduced with the SIMD kernel.
+ */
+template <size_t dim, typename TFunction, typename... TOperands>
+double sqLength(const VectorExpression<dim, TFunction, TOperands...> &expression) {
+    alignas(CacheLineSize) double buffer[detail::ReductionBlockSize];
+    double sum = 0.0;
+    for (size_t begin = 0; begin < expression.size(); begin += detail::ReductionBlockSize) {
+        const size_t end = std::min(begin + detail::ReductionBlockSize, expression.size());
+        expression.evalTo(buffer, begin, end);
+        sum += simd::sumOfSquares(buffer, end - begin);
+    }
+    return sum;
+}
 
 template <size_t dim>
-Vector<dim> apply(const Vector<dim> &vec, std::function<double(double)> &&func) {
-    Vector<dim> result;
-    std::transform(vec.begin(), vec.end(), result.begin(), func);
-    return result;
+double dot(const std::array<double, dim> &lhs, const std::array<double, dim> &rhs) {
+    return simd::dot(lhs.data(), rhs.data(), dim);
+}
+
+inline double dot(const DynamicVector &lhs, const DynamicVector &rhs) {
+    assert(lhs.size() == rhs.size());
+    return simd::dot(lhs.data(), rhs.data(), lhs.size());
+}
+
+/**
+ * Dot product of vectors or expressions, at least one of them an expression, evaluated block
+ * by block as sqLength().
+ */
+template <typename L, typename R,
+          typename = std::enable_if_t<IsVectorLike<L> && IsVectorLike<R> &&
+                                      (IsVectorExpression<L>::value ||
+                                       IsVectorExpression<R>::value)>>
+double dot(const L &lhs, const R &rhs) {
+    assert(lhs.size() == rhs.size());
+    alignas(CacheLineSize) double lhsBuffer[detail::ReductionBlockSize];
+    alignas(CacheLineSize) double rhsBuffer[detail::ReductionBlockSize];
+    double sum = 0.0;
+    for (size_t begin = 0; begin < lhs.size(); begin += detail::ReductionBlockSize) {
+        const size_t end = std::min(begin + detail::ReductionBlockSize, lhs.size());
+        sum += simd::dot(detail::elements(lhs, begin, end, lhsBuffer),
+                         detail::elements(rhs, begin, end, rhsBuffer), end - begin);
+    }
+    return sum;
+}
+
+/**
+ * Dot product of sparse x and the dense vector starting at y.
+ */
+inline double dot(const SparseVectorView &x, const double *y) {
+    return simd::sparseDot(x.indices, x.values, x.size, y);
+}
+
+/**
+ * Vector of func, any callable, applied to every element of vec, in a single loop.
+ */
+template <size_t dim, typename TFunction>
+std::array<double, dim> apply(const std::array<double, dim> &vec, TFunction func) {
+    return map(std::move(func), vec);
+}
+
+template <typename TFunction> DynamicVector apply(const DynamicVector &vec, TFunction func) {
+    return map(std::move(func), vec);
 }
-} // namespace ml
\ No newline at end of file
+} // namespace ml
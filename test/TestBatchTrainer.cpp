@@ -0,0 +1,74 @@
+#include <melon/BatchTrainer.h>
+#include <melon/LBFGS.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+namespace {
+
+/**
+ * Datasets of very uneven sizes, each labelled by its own logistic model.
+ */
+std::vector<ml::Dataset<4>> createSegments(const size_t numSegments) {
+    ml::Random random(17);
+    std::vector<ml::Dataset<4>> segments(numSegments);
+    for (size_t s = 0; s < numSegments; s++) {
+        const ml::LogisticModel<4> model(random.uniform<ml::Vector<5>>(-2.0, 2.0));
+        const size_t size = s % 10 == 0 ? 2000 : 50 + 10 * s;
+        for (size_t i = 0; i < size; i++) {
+            const auto x = random.uniform<ml::Vector<4>>(-2.0, 2.0);
+            segments[s].emplace_back(x, random.uniform() < model.eval(x) ? 1.0 : 0.0);
+        }
+    }
+
+    return segments;
+}
+} // namespace
+
+TEST(TestBatchTrainer, fit) {
+    const auto segments = createSegments(40);
+
+    using Trainer = ml::BatchTrainer<ml::LogisticRegression<4>, ml::LBFGS>;
+    std::vector<Trainer::Job> jobs;
+    for (size_t s = 0; s < segments.size(); s++)
+        jobs.push_back({segments[s].view(), 0.1 * static_cast<double>(s % 3), 0.0, s});
+
+    Trainer serial;
+    Trainer parallel;
+    parallel.withNumThreads(4);
+    const auto expected = serial.fit(jobs);
+    const auto actual = parallel.fit(jobs);
+
+    ASSERT_EQ(actual.results.size(), jobs.size());
+    EXPECT_GT(actual.wallSeconds, 0.0);
+    for (size_t s = 0; s < jobs.size(); s++) {
+        const auto &result = actual.results[s];
+        EXPECT_LT(result.worker, 4u);
+        EXPECT_GT(result.seconds, 0.0);
+        EXPECT_DOUBLE_EQ(result.regression.regularizationFactor(), jobs[s].regularizationFactor);
+
+        // Same model as a serial batch and as a fit of its own.
+        ml::LogisticRegression<4> single;
+        single.withRegularizationFactor(jobs[s].regularizationFactor).withSeed(s);
+        single.fit(ml::Dataset<4>(segments[s]), ml::LBFGS());
+
+        const auto &parameters = result.regression.scoringModel().parameters();
+        for (size_t i = 0; i < parameters.size(); i++) {
+            EXPECT_EQ(parameters[i], expected.results[s].regression.scoringModel().parameters()[i]);
+            EXPECT_NEAR(parameters[i], single.scoringModel().parameters()[i], 1E-9);
+        }
+    }
+
+    // Scratch datasets are reused by later batches.
+    const auto again = parallel.fit(jobs);
+    EXPECT_EQ(again.results[7].regression.scoringModel().parameters(),
+              actual.results[7].regression.scoringModel().parameters());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,194 @@
+#include <melon/BinaryDataset.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/NormalEquation.h>
+#include <melon/Random.h>
+#include <melon/StochasticGradientDescent.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <string>
+
+namespace {
+
+template <size_t dim>
+ml::TrainingSet<dim> createSyntheticTrainingSet(const ml::LinearModel<dim> &model,
+                                                const size_t numExamples) {
+    ml::TrainingSet<dim> trainingSet;
+    ml::Random random;
+
+    for (size_t count = 0; count < numExamples; count++) {
+        const auto x = random.uniform<ml::Vector<dim>>(-100.0, 100.0);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+
+/**
+ * Binary dataset file removed when the test ends.
+ */
+class TemporaryFile {
+  public:
+    explicit TemporaryFile(const std::string &name) : m_path(::testing::TempDir() + name) {}
+
+    ~TemporaryFile() { std::remove(m_path.c_str()); }
+
+    const std::string &path() const { return m_path; }
+
+  private:
+    std::string m_path;
+};
+} // namespace
+
+TEST(TestBinaryDataset, float64View) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 100));
+    const TemporaryFile file("float64View.bin");
+
+    ml::writeBinaryDataset(file.path(), dataset.view());
+    const ml::MappedBinaryDataset<3> mapped(file.path());
+    const auto view = mapped.view();
+
+    ASSERT_EQ(view.size(), dataset.size());
+    EXPECT_EQ(view.stride(), dataset.stride());
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.row(0)) % ml::CacheLineSize, 0u);
+    for (size_t i = 0; i < dataset.size(); i++) {
+        for (size_t j = 0; j < 3; j++)
+            EXPECT_EQ(view.row(i)[j], dataset.row(i)[j]);
+        EXPECT_EQ(view.label(i), dataset.label(i));
+    }
+}
+
+TEST(TestBinaryDataset, float32FromTrainingSet) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto trainingSet = createSyntheticTrainingSet(model, 100);
+    const TemporaryFile file("float32FromTrainingSet.bin");
+
+    ml::writeBinaryDataset(file.path(), trainingSet, ml::ScalarType::Float32);
+    const auto mapped = std::make_shared<const ml::MappedBinaryDataset<3>>(file.path());
+    EXPECT_EQ(mapped->scalarType(), ml::ScalarType::Float32);
+    EXPECT_THROW(mapped->view(), std::logic_error);
+
+    const ml::ChunkedDatasetSource<3> source(mapped, 32);
+    ASSERT_EQ(source.numChunks(), 4u);
+    for (size_t c = 0; c < source.numChunks(); c++) {
+        const auto chunk = source.chunk(c);
+        for (size_t i = 0; i < chunk.size(); i++) {
+            const auto &[x, y] = trainingSet[c * 32 + i];
+            for (size_t j = 0; j < 3; j++)
+                EXPECT_EQ(chunk.row(i)[j], static_cast<double>(static_cast<float>(x[j])));
+            EXPECT_EQ(chunk.label(i), static_cast<double>(static_cast<float>(y)));
+        }
+    }
+}
+
+TEST(TestBinaryDataset, float32View) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto trainingSet = createSyntheticTrainingSet(model, 100);
+    const TemporaryFile file("float32View.bin");
+
+    ml::writeBinaryDataset(file.path(), trainingSet, ml::ScalarType::Float32);
+    const auto mapped = std::make_shared<const ml::MappedBinaryDataset<3>>(file.path());
+    const ml::ChunkedDatasetSource<3, float> source(mapped, 32);
+    const auto view = mapped->view<float>();
+
+    const auto chunk = source.chunk(1);
+    EXPECT_EQ(chunk.row(0), view.row(32));
+    EXPECT_EQ(chunk.labels(), view.labels() + 32);
+
+    const ml::Dataset<3, float> dataset(trainingSet);
+    const ml::LinearRegressionCostFunction<3, float> inMemory(dataset.view());
+    const ml::LinearRegressionCostFunction<3, float> chunked(
+        std::make_shared<const ml::ChunkedDatasetSource<3, float>>(source));
+    const ml::Vector<4> parameters = {0.1, 0.2, -0.3, 0.4};
+    const double expected = inMemory.eval(parameters);
+    EXPECT_NEAR(chunked.eval(parameters), expected, 1E-12 * std::fabs(expected));
+}
+
+TEST(TestBinaryDataset, mismatchedDimension) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const TemporaryFile file("mismatchedDimension.bin");
+    ml::writeBinaryDataset(file.path(), createSyntheticTrainingSet(model, 10));
+
+    EXPECT_THROW(ml::MappedBinaryDataset<4>(file.path()), std::runtime_error);
+    EXPECT_EQ(ml::MappedBinaryDataset<ml::Dynamic>(file.path()).numFeatures(), 3u);
+    EXPECT_THROW(ml::MappedBinaryDataset<3>(file.path() + ".missing"), std::runtime_error);
+}
+
+TEST(TestBinaryDataset, corruptHeader) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 4.0});
+    const TemporaryFile file("corruptHeader.bin");
+
+    const auto expectCorrupt = [&](const uint64_t stride, const uint64_t numRows) {
+        ml::writeBinaryDataset(file.path(), createSyntheticTrainingSet(model, 10));
+        ml::BinaryDatasetHeader header;
+        std::fstream stream(file.path(), std::ios::in | std::ios::out | std::ios::binary);
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        header.stride = stride;
+        header.numRows = numRows;
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.close();
+        EXPECT_THROW(ml::MappedBinaryDataset<3>(file.path()), std::runtime_error);
+    };
+
+    // Overlapping rows, a stride the writer does not use, and a size that wraps around.
+    expectCorrupt(2, 10);
+    expectCorrupt(16, 10);
+    expectCorrupt(8, (uint64_t(1) << 61) + 1);
+}
+
+TEST(TestBinaryDataset, chunkedCostFunction) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 5000));
+    const TemporaryFile file("chunkedCostFunction.bin");
+    ml::writeBinaryDataset(file.path(), dataset.view());
+
+    const auto mapped = std::make_shared<const ml::MappedBinaryDataset<3>>(file.path());
+    const ml::LogisticRegressionCostFunction<3> inMemory(dataset.view());
+    const ml::LogisticRegressionCostFunction<3> chunked(
+        std::make_shared<const ml::ChunkedDatasetSource<3>>(mapped, 1500));
+
+    const ml::Vector<4> parameters = {0.001, 0.002, -0.003, 0.4};
+    const auto expected = inMemory.valueAndGradient(parameters);
+    const auto actual = chunked.valueAndGradient(parameters);
+    EXPECT_NEAR(actual.value, expected.value, 1E-12 * std::fabs(expected.value));
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(actual.gradient[i], expected.gradient[i], 1E-12 * std::fabs(expected.value));
+}
+
+TEST(TestBinaryDataset, fit) {
+    ml::LinearModel<4> model({3.0, 1.0, -4.0, 10.0, 1.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 4000);
+    const TemporaryFile file("fit.bin");
+    ml::writeBinaryDataset(file.path(), trainingSet, ml::ScalarType::Float32);
+
+    const auto mapped = std::make_shared<const ml::MappedBinaryDataset<4>>(file.path());
+    const ml::ChunkedDatasetSource<4> source(mapped, 1000);
+
+    ml::LinearRegression<4> normalEquation, stochastic;
+    normalEquation.fit(source, ml::NormalEquation());
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = ml::StochasticGradientDescent::Method::Plain;
+    hyperParameters.learningRate = 0.01;
+    hyperParameters.maxEpochs = 20;
+    stochastic.fit(source, ml::StochasticGradientDescent().withHyperParameters(hyperParameters));
+
+    ml::Random random;
+    for (size_t i = 0; i < 100; i++) {
+        const auto x = random.uniform<ml::Vector<4>>(-1.0, 1.0);
+        EXPECT_NEAR(normalEquation.predict(x), model.eval(x), 1E-3);
+        EXPECT_NEAR(stochastic.predict(x), model.eval(x), 1E-2);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,168 @@
+#include <melon/CoordinateDescent.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/NormalEquation.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <random>
+
+namespace {
+
+/**
+ * Examples of 10 features of which only the first three are informative.
+ */
+ml::Dataset<10> createSparseDataset(const size_t numExamples, const bool binary) {
+    const ml::LinearModel<10> model({2.0, -1.5, 1.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.5});
+    ml::Random random;
+    std::mt19937 generator(11);
+    std::normal_distribution<double> noise(0.0, 0.5);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+
+    ml::Dataset<10> dataset;
+    for (size_t i = 0; i < numExamples; i++) {
+        const auto x = random.uniform<ml::Vector<10>>(-2.0, 2.0);
+        const double score = model.eval(x);
+        const double y = binary ? (uniform(generator) < ml::simd::sigmoid(score) ? 1.0 : 0.0)
+                                : score + noise(generator);
+        dataset.emplace_back(x, y);
+    }
+
+    return dataset;
+}
+
+/**
+ * Check the optimality conditions of the elastic-net cost at parameters: the loss gradient of
+ * every non-zero weight balances its penalty, and is below the L1 factor for zero weights.
+ */
+template <typename TCostFunction>
+void expectOptimal(TCostFunction costFunction, const ml::Vector<11> &parameters) {
+    const double l2 = costFunction.regularizationFactor();
+    const double l1 = costFunction.l1RegularizationFactor();
+    costFunction.setRegularizationFactor(0.0);
+    costFunction.setL1RegularizationFactor(0.0);
+
+    const double n = static_cast<double>(costFunction.numExamples());
+    const auto gradient = costFunction.gradient(parameters);
+    const double tolerance = 1E-4 * n;
+    for (size_t j = 0; j < 10; j++) {
+        const double g = n * gradient[j] + l2 * parameters[j];
+        if (parameters[j] != 0.0)
+            EXPECT_NEAR(g + std::copysign(l1, parameters[j]), 0.0, tolerance) << j;
+        else
+            EXPECT_LE(std::fabs(g), l1 + tolerance) << j;
+    }
+    EXPECT_NEAR(n * gradient[10], 0.0, tolerance);
+}
+} // namespace
+
+TEST(TestCoordinateDescent, ridge) {
+    const auto dataset = createSparseDataset(2000, false);
+
+    ml::LinearRegression<10> direct, coordinate;
+    direct.withRegularizationFactor(10.0).fit(dataset.view(), ml::NormalEquation());
+    coordinate.withRegularizationFactor(10.0).fit(dataset.view(), ml::CoordinateDescent());
+
+    for (size_t j = 0; j < 11; j++)
+        EXPECT_NEAR(coordinate.scoringModel().parameters()[j],
+                    direct.scoringModel().parameters()[j], 1E-5);
+}
+
+TEST(TestCoordinateDescent, lasso) {
+    const auto dataset = createSparseDataset(2000, false);
+    const auto statistics = ml::computeFeatureStatistics(dataset.view());
+
+    ml::LinearRegressionCostFunction<10> costFunction(dataset.view());
+    costFunction.setFeatureScaling(statistics.mean(), statistics.scale());
+    costFunction.setRegularizationFactor(0.0);
+    costFunction.setL1RegularizationFactor(200.0);
+
+    const auto result =
+        ml::CoordinateDescent().optimize(costFunction, ml::zeros<ml::Vector<11>>(11));
+    EXPECT_EQ(result.stopReason, ml::StopReason::Converged);
+    EXPECT_NEAR(result.optimalValue, costFunction.eval(result.optimalArguments), 1E-12);
+    expectOptimal(costFunction, result.optimalArguments);
+
+    // Uninformative features get exactly zero weight.
+    for (size_t j = 0; j < 10; j++)
+        EXPECT_EQ(result.optimalArguments[j] == 0.0, j >= 3) << j;
+
+    ml::LinearRegression<10> regression;
+    regression.withRegularizationFactor(0.0).withL1RegularizationFactor(200.0);
+    regression.fit(dataset.view(), ml::CoordinateDescent());
+    for (size_t j = 0; j < 11; j++)
+        EXPECT_NEAR(regression.model().parameters()[j], result.optimalArguments[j], 1E-6);
+}
+
+TEST(TestCoordinateDescent, logisticElasticNet) {
+    auto dataset = createSparseDataset(3000, true);
+    const auto statistics = ml::computeFeatureStatistics(dataset.view());
+
+    ml::LogisticRegressionCostFunction<10> costFunction(dataset.view());
+    costFunction.setFeatureScaling(statistics.mean(), statistics.scale());
+    costFunction.setRegularizationFactor(5.0);
+    costFunction.setL1RegularizationFactor(30.0);
+
+    const auto result = ml::CoordinateDescent().optimize(
+        costFunction, ml::Random().uniform<ml::Vector<11>>(-0.5, 0.5));
+    EXPECT_EQ(result.stopReason, ml::StopReason::Converged);
+    expectOptimal(costFunction, result.optimalArguments);
+    EXPECT_NE(result.optimalArguments[0], 0.0);
+
+    // Examples normalized in place and normalized as they are read give the same model.
+    ml::LogisticRegression<10> lazy, inPlace;
+    lazy.withRegularizationFactor(5.0).withL1RegularizationFactor(30.0);
+    inPlace.withRegularizationFactor(5.0).withL1RegularizationFactor(30.0);
+    lazy.fit(dataset.view(), ml::CoordinateDescent());
+    inPlace.fit(std::move(dataset), ml::CoordinateDescent());
+    for (size_t j = 0; j < 11; j++) {
+        EXPECT_NEAR(lazy.model().parameters()[j], result.optimalArguments[j], 1E-6);
+        EXPECT_NEAR(inPlace.model().parameters()[j], result.optimalArguments[j], 1E-6);
+    }
+}
+
+TEST(TestCoordinateDescent, regularizationPath) {
+    const auto dataset = createSparseDataset(2000, true);
+    const auto statistics = ml::computeFeatureStatistics(dataset.view());
+
+    ml::LogisticRegressionCostFunction<10> costFunction(dataset.view());
+    costFunction.setFeatureScaling(statistics.mean(), statistics.scale());
+    costFunction.setRegularizationFactor(1.0);
+
+    const ml::CoordinateDescent optimizer;
+    const double maxFactor = optimizer.maxL1RegularizationFactor(costFunction);
+    const std::vector<double> factors = {0.01 * maxFactor, 1.01 * maxFactor, 0.5 * maxFactor,
+                                         0.1 * maxFactor, 0.99 * maxFactor};
+    const auto path = optimizer.regularizationPath(costFunction, factors);
+    ASSERT_EQ(path.size(), factors.size());
+
+    // Solutions are ordered by decreasing factor, with more and more non-zero weights.
+    auto ordered = factors;
+    std::sort(ordered.begin(), ordered.end(), std::greater<double>());
+    size_t previousNonZero = 0;
+    for (size_t k = 0; k < path.size(); k++) {
+        const auto &parameters = path[k].optimalArguments;
+        size_t numNonZero = 0;
+        for (size_t j = 0; j < 10; j++)
+            numNonZero += parameters[j] != 0.0;
+        EXPECT_EQ(numNonZero == 0, k == 0) << k;
+        EXPECT_GE(numNonZero, previousNonZero) << k;
+        previousNonZero = numNonZero;
+
+        // Screening does not change the solution.
+        costFunction.setL1RegularizationFactor(ordered[k]);
+        const auto single = optimizer.optimize(costFunction, ml::zeros<ml::Vector<11>>(11));
+        for (size_t j = 0; j < 11; j++)
+            EXPECT_NEAR(parameters[j], single.optimalArguments[j], 1E-5) << k;
+        expectOptimal(costFunction, parameters);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
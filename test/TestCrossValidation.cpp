@@ -0,0 +1,149 @@
+#include <melon/CrossValidation.h>
+#include <melon/GradientDescent.h>
+#include <melon/LBFGS.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+ml::Dataset<3> createNoisyDataset(const size_t numExamples) {
+    const ml::LinearModel<3> model({2.0, -1.0, 0.5, 3.0});
+    ml::Random random;
+    std::mt19937 generator(7);
+    std::normal_distribution<double> noise(0.0, 0.5);
+
+    ml::Dataset<3> dataset;
+    for (size_t i = 0; i < numExamples; i++) {
+        const auto x = random.uniform<ml::Vector<3>>(-2.0, 2.0);
+        dataset.emplace_back(x, model.eval(x) + noise(generator));
+    }
+
+    return dataset;
+}
+
+/**
+ * Returns the given parameters whatever the cost, so validation scores depend only on them.
+ */
+struct FixedOptimizer {
+    ml::Vector<4> parameters;
+
+    template <typename TDifferentiableFunction, typename TArguments>
+    ml::OptimizationResult<TArguments> optimize(const TDifferentiableFunction &,
+                                                const TArguments &) const {
+        ml::OptimizationResult<TArguments> result;
+        result.optimalArguments = parameters;
+        return result;
+    }
+};
+} // namespace
+
+TEST(TestCrossValidation, selectExamples) {
+    const auto dataset = createNoisyDataset(300);
+
+    std::vector<size_t> indices;
+    ml::Dataset<3> subset;
+    for (size_t i = 0; i < dataset.size(); i += 3) {
+        indices.push_back(i);
+        ml::Vector<3> x;
+        std::copy(dataset.row(i), dataset.row(i) + 3, x.begin());
+        subset.emplace_back(x, dataset.label(i));
+    }
+
+    ml::LogisticRegressionCostFunction<3> selected(dataset.view());
+    selected.selectExamples(std::make_shared<const std::vector<size_t>>(indices));
+    selected.setFeatureScaling({0.1, 0.2, 0.3}, {1.0, 2.0, 0.5});
+    selected.setRegularizationFactor(0.1);
+    ml::LogisticRegressionCostFunction<3> copied(subset.view());
+    copied.setFeatureScaling({0.1, 0.2, 0.3}, {1.0, 2.0, 0.5});
+    copied.setRegularizationFactor(0.1);
+
+    ASSERT_EQ(selected.numExamples(), subset.size());
+    const ml::Vector<4> parameters = {0.1, 0.2, -0.3, 0.4};
+    const auto expected = copied.valueAndGradient(parameters);
+    const auto actual = selected.valueAndGradient(parameters);
+    EXPECT_DOUBLE_EQ(actual.value, expected.value);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_DOUBLE_EQ(actual.gradient[i], expected.gradient[i]);
+
+    const size_t batch[] = {0, 5, 17, 42};
+    const auto expectedBatch = copied.batchGradient(parameters, batch, 4);
+    const auto actualBatch = selected.batchGradient(parameters, batch, 4);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_DOUBLE_EQ(actualBatch[i], expectedBatch[i]);
+}
+
+TEST(TestCrossValidation, regularizationFactor) {
+    const auto dataset = createNoisyDataset(500);
+
+    ml::LinearRegression<3> weak, strong;
+    weak.fit(dataset.view(), ml::LBFGS());
+    strong.withRegularizationFactor(1000.0).fit(dataset.view(), ml::LBFGS());
+
+    EXPECT_DOUBLE_EQ(strong.regularizationFactor(), 1000.0);
+    const auto &w = weak.model().parameters(), &s = strong.model().parameters();
+    EXPECT_LT(ml::sqLength(ml::Vector<3>{s[0], s[1], s[2]}),
+              0.5 * ml::sqLength(ml::Vector<3>{w[0], w[1], w[2]}));
+}
+
+TEST(TestCrossValidation, gridSearch) {
+    const auto dataset = createNoisyDataset(1000);
+    const std::vector<double> factors = {1E-6, 1E4, 1.0, 100.0};
+
+    ml::GradientDescent::HyperParameters coarse;
+    coarse.relativeErrorTolerance = 1E-3;
+    const std::vector<ml::GradientDescent> optimizers = {
+        ml::GradientDescent(), ml::GradientDescent().withHyperParameters(coarse)};
+
+    ml::LinearRegression<3> regression;
+    const auto serial = ml::CrossValidation(regression, 4).run(dataset.view(), factors, optimizers);
+    const auto parallel = ml::CrossValidation(regression, 4)
+                              .withNumThreads(3)
+                              .run(dataset.view(), factors, optimizers);
+
+    ASSERT_EQ(serial.scores.size(), factors.size() * optimizers.size());
+    EXPECT_GT(serial.wallSeconds, 0.0);
+    for (size_t i = 0; i < serial.scores.size(); i++) {
+        ASSERT_EQ(serial.scores[i].foldScores.size(), 4u);
+        EXPECT_EQ(serial.scores[i].optimizerIndex, i / factors.size());
+        EXPECT_EQ(serial.scores[i].foldScores, parallel.scores[i].foldScores);
+    }
+
+    // Factors are visited in decreasing order; heavy regularization underfits.
+    EXPECT_DOUBLE_EQ(serial.scores[0].regularizationFactor, 1E4);
+    EXPECT_GT(serial.scores[0].mean(), 2.0 * serial.best().mean());
+    EXPECT_LE(serial.best().regularizationFactor, 1.0);
+
+    // Validation scores are the half mean squared error, close to the noise variance / 2.
+    EXPECT_NEAR(serial.best().mean(), 0.5 * 0.25, 0.05);
+}
+
+TEST(TestCrossValidation, l1RegularizationFactor) {
+    const auto dataset = createNoisyDataset(400);
+    const std::vector<double> factors = {0.0, 10.0};
+    const std::vector<FixedOptimizer> optimizers = {{{2.0, -1.0, 0.5, 3.0}}};
+
+    ml::LinearRegression<3> plain, sparse;
+    sparse.withL1RegularizationFactor(50.0);
+    const auto expected = ml::CrossValidation(plain, 4).run(dataset.view(), factors, optimizers);
+    const auto actual = ml::CrossValidation(sparse, 4).run(dataset.view(), factors, optimizers);
+
+    // Fold scores are the plain validation loss, without the L1 penalty of the fit.
+    ASSERT_EQ(actual.scores.size(), expected.scores.size());
+    for (size_t i = 0; i < actual.scores.size(); i++)
+        for (size_t fold = 0; fold < 4; fold++)
+            EXPECT_DOUBLE_EQ(actual.scores[i].foldScores[fold],
+                             expected.scores[i].foldScores[fold]);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,103 @@
+#include <melon/Dataset.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+
+ml::TrainingSet<3> createTrainingSet() {
+    return {{{1.0, 2.0, 3.0}, 0.5}, {{4.0, 5.0, 6.0}, -1.0}, {{7.0, 8.0, 9.0}, 2.0}};
+}
+} // namespace
+
+TEST(TestDataset, fromTrainingSet) {
+    const auto trainingSet = createTrainingSet();
+    const ml::Dataset<3> dataset(trainingSet);
+
+    ASSERT_EQ(dataset.size(), trainingSet.size());
+    for (size_t i = 0; i < dataset.size(); i++) {
+        const auto &[x, y] = trainingSet[i];
+        for (size_t j = 0; j < x.size(); j++)
+            EXPECT_EQ(dataset.row(i)[j], x[j]);
+        EXPECT_EQ(dataset.label(i), y);
+    }
+}
+
+TEST(TestDataset, alignment) {
+    const ml::Dataset<3> dataset(createTrainingSet());
+
+    EXPECT_EQ(ml::Dataset<3>::stride(), 8u);
+    EXPECT_EQ(ml::Dataset<9>::stride(), 16u);
+    for (size_t i = 0; i < dataset.size(); i++)
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset.row(i)) % ml::CacheLineSize, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset.labels()) % ml::CacheLineSize, 0u);
+}
+
+TEST(TestDataset, slice) {
+    const ml::Dataset<3> dataset(createTrainingSet());
+    const auto slice = dataset.view().slice(1, 3);
+
+    ASSERT_EQ(slice.size(), 2u);
+    EXPECT_EQ(slice.row(0)[0], 4.0);
+    EXPECT_EQ(slice.row(1)[2], 9.0);
+    EXPECT_EQ(slice.label(1), 2.0);
+}
+
+TEST(TestDataset, columnMajor) {
+    const ml::Dataset<3> dataset(createTrainingSet());
+    const auto columns = dataset.columnMajor();
+
+    ASSERT_EQ(columns.size(), dataset.size());
+    for (size_t j = 0; j < 3; j++) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(columns.column(j)) % ml::CacheLineSize, 0u);
+        for (size_t i = 0; i < dataset.size(); i++)
+            EXPECT_EQ(columns.column(j)[i], dataset.row(i)[j]);
+    }
+}
+
+TEST(TestDataset, float32) {
+    const auto trainingSet = createTrainingSet();
+    const ml::Dataset<3, float> dataset(trainingSet);
+
+    EXPECT_EQ((ml::Dataset<3, float>::stride()), 16u);
+    EXPECT_EQ((ml::Dataset<20, float>::stride()), 32u);
+    for (size_t i = 0; i < dataset.size(); i++) {
+        const auto &[x, y] = trainingSet[i];
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset.row(i)) % ml::CacheLineSize, 0u);
+        for (size_t j = 0; j < 3; j++)
+            EXPECT_EQ(dataset.row(i)[j], static_cast<float>(x[j]));
+        EXPECT_EQ(dataset.label(i), static_cast<double>(static_cast<float>(y)));
+    }
+
+    const ml::Dataset<ml::Dynamic, float> dynamic(2, 5);
+    EXPECT_EQ(dynamic.stride(), 16u);
+    EXPECT_EQ(dynamic.view().numFeatures(), 5u);
+}
+
+TEST(TestDataset, dynamic) {
+    ml::TrainingSet<ml::Dynamic> trainingSet;
+    for (const auto &[x, y] : createTrainingSet())
+        trainingSet.emplace_back(ml::DynamicVector({x[0], x[1], x[2]}), y);
+    const ml::Dataset<ml::Dynamic> dataset(trainingSet);
+    const ml::Dataset<3> expected(createTrainingSet());
+
+    ASSERT_EQ(dataset.size(), expected.size());
+    EXPECT_EQ(dataset.numFeatures(), 3u);
+    EXPECT_EQ(dataset.stride(), expected.stride());
+    for (size_t i = 0; i < dataset.size(); i++) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(dataset.row(i)) % ml::CacheLineSize, 0u);
+        for (size_t j = 0; j < 3; j++)
+            EXPECT_EQ(dataset.row(i)[j], expected.row(i)[j]);
+        EXPECT_EQ(dataset.label(i), expected.label(i));
+    }
+
+    const auto slice = dataset.view().slice(1, 3);
+    EXPECT_EQ(slice.numFeatures(), 3u);
+    EXPECT_EQ(slice.row(1)[2], 9.0);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
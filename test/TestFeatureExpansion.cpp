@@ -0,0 +1,154 @@
+#include <melon/FeatureExpansion.h>
+#include <melon/LBFGS.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/NormalEquation.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <set>
+#include <vector>
+
+namespace {
+
+/**
+ * Examples of two features labelled by 1 + 2 x0^2 - x0 x1 + 0.5 x1^3, or by its sign when
+ * binary.
+ */
+ml::Dataset<ml::Dynamic> createCubicDataset(const size_t numExamples, const bool binary) {
+    ml::Random random(3);
+    ml::Dataset<ml::Dynamic> dataset(0, 2);
+    for (size_t i = 0; i < numExamples; i++) {
+        const auto x = random.uniform<ml::DynamicVector>(2, -2.0, 2.0);
+        const double y = 1.0 + 2.0 * x[0] * x[0] - x[0] * x[1] + 0.5 * x[1] * x[1] * x[1] +
+                         random.normal(0.0, 0.1);
+        dataset.emplace_back(x, binary ? (y > 2.0 ? 1.0 : 0.0) : y);
+    }
+
+    return dataset;
+}
+
+/**
+ * Copy of dataset with the expanded features of every example.
+ */
+ml::Dataset<ml::Dynamic> materialize(const ml::Dataset<ml::Dynamic> &dataset,
+                                     const ml::FeatureExpansion &expansion) {
+    ml::Dataset<ml::Dynamic> expanded(0, expansion.numOutputs());
+    ml::DynamicVector x(expansion.numOutputs());
+    for (size_t i = 0; i < dataset.size(); i++) {
+        expansion.expand(dataset.row(i), x.data());
+        expanded.emplace_back(x, dataset.label(i));
+    }
+
+    return expanded;
+}
+} // namespace
+
+TEST(TestFeatureExpansion, expand) {
+    ml::FeatureExpansion expansion(3);
+    expansion.withPowers(3).withInteractions();
+    EXPECT_EQ(expansion.numInputs(), 3u);
+    EXPECT_EQ(expansion.numOutputs(), 3u + 6u + 3u);
+
+    // Complete polynomials include the powers and interactions, which are not repeated.
+    ml::FeatureExpansion polynomial(3);
+    polynomial.withPolynomialDegree(3).withPowers(2).withInteraction(2, 0);
+    EXPECT_EQ(polynomial.numOutputs(), 3u + 6u + 10u);
+
+    const float x[] = {1.5f, -2.0f, 0.5f};
+    for (const auto *e : {&expansion, &polynomial}) {
+        std::vector<double> out(e->numOutputs());
+        e->expand(x, out.data());
+
+        std::set<std::vector<size_t>> monomials;
+        for (size_t t = 0; t < e->numOutputs(); t++) {
+            const auto factors = e->factors(t);
+            EXPECT_TRUE(monomials.insert(factors).second) << t;
+            EXPECT_EQ(factors.size() == 1, t < 3) << t;
+
+            double product = 1.0;
+            for (const size_t j : factors)
+                product *= x[j];
+            EXPECT_DOUBLE_EQ(out[t], product) << t;
+        }
+    }
+}
+
+TEST(TestFeatureExpansion, statistics) {
+    const auto dataset = createCubicDataset(10000, false);
+    ml::FeatureExpansion expansion(2);
+    expansion.withPolynomialDegree(4);
+
+    const auto expected = ml::computeFeatureStatistics(materialize(dataset, expansion).view());
+    ml::ThreadPool pool(3);
+    for (auto *threadPool : {static_cast<ml::ThreadPool *>(nullptr), &pool}) {
+        const auto statistics = ml::computeFeatureStatistics(dataset.view(), expansion, threadPool);
+        ASSERT_EQ(statistics.numFeatures(), expansion.numOutputs());
+        EXPECT_EQ(statistics.count(), dataset.size());
+        for (size_t j = 0; j < expansion.numOutputs(); j++) {
+            EXPECT_NEAR(statistics.mean()[j], expected.mean()[j], 1E-9) << j;
+            EXPECT_NEAR(statistics.variance()[j], expected.variance()[j],
+                        1E-9 * expected.variance()[j])
+                << j;
+        }
+    }
+}
+
+TEST(TestFeatureExpansion, linearRegression) {
+    const auto dataset = createCubicDataset(2000, false);
+    ml::FeatureExpansion expansion(2);
+    expansion.withPolynomialDegree(3);
+
+    ml::LinearRegression<ml::Dynamic> lazy, explicitly, raw;
+    lazy.withFeatureExpansion(expansion).fit(dataset.view(), ml::NormalEquation());
+    explicitly.fit(materialize(dataset, expansion), ml::NormalEquation());
+    raw.fit(dataset.view(), ml::NormalEquation());
+
+    const auto &parameters = lazy.scoringModel().parameters();
+    ASSERT_EQ(parameters.size(), expansion.numOutputs() + 1);
+    for (size_t j = 0; j < parameters.size(); j++)
+        EXPECT_NEAR(parameters[j], explicitly.scoringModel().parameters()[j], 1E-8) << j;
+
+    // The expanded model fits the cubic target, the linear model on raw features does not.
+    std::vector<double> predictions(dataset.size());
+    lazy.predictBatch(dataset.view(), predictions.data());
+    double expandedError = 0.0, rawError = 0.0;
+    for (size_t i = 0; i < dataset.size(); i++) {
+        const ml::DynamicVector x(dataset.row(i), dataset.row(i) + 2);
+        EXPECT_NEAR(predictions[i], lazy.predict(x), 1E-10);
+        expandedError += std::fabs(predictions[i] - dataset.label(i)) / dataset.size();
+        rawError += std::fabs(raw.predict(x) - dataset.label(i)) / dataset.size();
+    }
+    EXPECT_LT(expandedError, 0.1);
+    EXPECT_GT(rawError, 1.0);
+}
+
+TEST(TestFeatureExpansion, logisticRegression) {
+    auto dataset = createCubicDataset(2000, true);
+    ml::FeatureExpansion expansion(2);
+    expansion.withPowers(3).withInteractions();
+
+    ml::LogisticRegression<ml::Dynamic> lazy, explicitly;
+    lazy.withRegularizationFactor(1.0).withFeatureExpansion(expansion);
+    explicitly.withRegularizationFactor(1.0);
+    explicitly.fit(materialize(dataset, expansion), ml::LBFGS());
+    lazy.fit(dataset.view(), ml::LBFGS());
+
+    for (size_t j = 0; j < expansion.numOutputs() + 1; j++)
+        EXPECT_NEAR(lazy.scoringModel().parameters()[j],
+                    explicitly.scoringModel().parameters()[j], 1E-6)
+            << j;
+
+    // A dataset handed over is expanded as it is read rather than normalized in place.
+    ml::LogisticRegression<ml::Dynamic> moved;
+    moved.withRegularizationFactor(1.0).withFeatureExpansion(expansion);
+    moved.fit(std::move(dataset), ml::LBFGS());
+    EXPECT_EQ(moved.scoringModel().parameters(), lazy.scoringModel().parameters());
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,100 @@
+#include <melon/FeatureStatistics.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+
+namespace {
+
+ml::Dataset<2> createDataset(const size_t size, const double offset) {
+    std::mt19937 generator(42);
+    std::uniform_real_distribution<double> uniform(-1.0, 1.0);
+    ml::Dataset<2> dataset(size);
+    for (size_t i = 0; i < size; i++) {
+        dataset.row(i)[0] = offset + uniform(generator);
+        dataset.row(i)[1] = 3.0 * uniform(generator);
+    }
+    return dataset;
+}
+
+std::pair<std::array<double, 2>, std::array<double, 2>>
+twoPassStatistics(const ml::DatasetView<2> &dataset) {
+    std::array<double, 2> mean{}, variance{};
+    for (size_t i = 0; i < dataset.size(); i++)
+        for (size_t j = 0; j < 2; j++)
+            mean[j] += dataset.row(i)[j] / static_cast<double>(dataset.size());
+
+    for (size_t i = 0; i < dataset.size(); i++) {
+        for (size_t j = 0; j < 2; j++) {
+            const double diff = dataset.row(i)[j] - mean[j];
+            variance[j] += diff * diff / static_cast<double>(dataset.size());
+        }
+    }
+    return {mean, variance};
+}
+} // namespace
+
+TEST(TestFeatureStatistics, singlePass) {
+    ml::FeatureStatistics<2> statistics;
+    const double rows[3][2] = {{1.0, -2.0}, {2.0, 0.0}, {6.0, 2.0}};
+    for (const auto &row : rows)
+        statistics.add(row);
+
+    EXPECT_EQ(statistics.count(), 3u);
+    EXPECT_DOUBLE_EQ(statistics.mean()[0], 3.0);
+    EXPECT_DOUBLE_EQ(statistics.mean()[1], 0.0);
+    EXPECT_DOUBLE_EQ(statistics.variance()[0], 14.0 / 3.0);
+    EXPECT_DOUBLE_EQ(statistics.sdev()[1], std::sqrt(8.0 / 3.0));
+}
+
+TEST(TestFeatureStatistics, largeOffset) {
+    const auto dataset = createDataset(10000, 1E9);
+    const auto [mean, variance] = twoPassStatistics(dataset);
+    const auto statistics = ml::computeFeatureStatistics(dataset.view());
+
+    for (size_t j = 0; j < 2; j++) {
+        EXPECT_NEAR(statistics.mean()[j], mean[j], 1E-6 * std::fabs(mean[j]) + 1E-12);
+        EXPECT_NEAR(statistics.variance()[j], variance[j], 1E-6 * variance[j]);
+    }
+}
+
+TEST(TestFeatureStatistics, merge) {
+    const auto dataset = createDataset(1000, 5.0);
+    const auto all = ml::computeFeatureStatistics(dataset.view());
+
+    auto merged = ml::computeFeatureStatistics(dataset.view().slice(0, 300));
+    merged.merge(ml::computeFeatureStatistics(dataset.view().slice(300, 1000)));
+    merged.merge(ml::FeatureStatistics<2>());
+
+    EXPECT_EQ(merged.count(), all.count());
+    for (size_t j = 0; j < 2; j++) {
+        EXPECT_NEAR(merged.mean()[j], all.mean()[j], 1E-12);
+        EXPECT_NEAR(merged.variance()[j], all.variance()[j], 1E-12);
+    }
+}
+
+TEST(TestFeatureStatistics, threadPool) {
+    const auto dataset = createDataset(20000, -3.0);
+    ml::ThreadPool threadPool(4);
+    const auto serial = ml::computeFeatureStatistics(dataset.view());
+    const auto parallel = ml::computeFeatureStatistics(dataset.view(), &threadPool);
+
+    EXPECT_EQ(parallel.count(), dataset.size());
+    for (size_t j = 0; j < 2; j++) {
+        EXPECT_NEAR(parallel.mean()[j], serial.mean()[j], 1E-12);
+        EXPECT_NEAR(parallel.variance()[j], serial.variance()[j], 1E-12);
+    }
+}
+
+TEST(TestFeatureStatistics, dynamic) {
+    const auto dataset = createDataset(100, 2.0);
+    const ml::DatasetView<ml::Dynamic> view(dataset.features(), dataset.labels(), dataset.size(),
+                                            dataset.stride(), 2);
+    const auto fixed = ml::computeFeatureStatistics(dataset.view());
+    const auto dynamic = ml::computeFeatureStatistics(view);
+
+    ASSERT_EQ(dynamic.numFeatures(), 2u);
+    for (size_t j = 0; j < 2; j++)
+        EXPECT_DOUBLE_EQ(dynamic.mean()[j], fixed.mean()[j]);
+}
@@ -2,27 +2,86 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 const double tolerance = 0.1;
 
-TEST(TestGradientDescent, optimize) {
-    class ParaboloidFunction {
-      public:
-        using argument_type = ml::Vector<2>;
-        using gradient_type = argument_type;
-
-        double eval(const argument_type &x) const {
-            return (x[0] - 20.0) * (x[0] - 20.0) + x[1] * x[1] + 50.0;
-        }
-        gradient_type gradient(const argument_type &x) const {
-            return {2.0 * (x[0] - 20.0), 2 * x[1]};
-        }
-    };
+class ParaboloidFunction {
+  public:
+    using argument_type = ml::Vector<2>;
+    using gradient_type = argument_type;
+
+    double eval(const argument_type &x) const {
+        return (x[0] - 20.0) * (x[0] - 20.0) + x[1] * x[1] + 50.0;
+    }
+    gradient_type gradient(const argument_type &x) const { return {2.0 * (x[0] - 20.0), 2 * x[1]}; }
+};
+
+/**
+ * Paraboloid whose gradient points uphill, so no step against it decreases the function.
+ */
+class WrongGradientFunction : public ParaboloidFunction {
+  public:
+    gradient_type gradient(const argument_type &x) const {
+        const auto downhill = ParaboloidFunction::gradient(x);
+        return {-downhill[0], -downhill[1]};
+    }
+};
 
+TEST(TestGradientDescent, optimize) {
     ml::GradientDescent optimizer;
     const auto result = optimizer.optimize(ParaboloidFunction(), {100.0, 100.0});
     EXPECT_NEAR(result.optimalValue, 50.0, 0.001);
 }
 
+TEST(TestGradientDescent, observer) {
+    ml::StatsObserver observer;
+    const auto result = ml::GradientDescent().optimize(ParaboloidFunction(), {100.0, 100.0},
+                                                       observer);
+    const auto expected = ml::GradientDescent().optimize(ParaboloidFunction(), {100.0, 100.0});
+    EXPECT_EQ(result.optimalValue, expected.optimalValue);
+    EXPECT_EQ(result.stopReason, ml::StopReason::Converged);
+
+    const auto &stats = observer.stats();
+    ASSERT_EQ(stats.iterations.size(), result.numIterations);
+    EXPECT_EQ(stats.numEvals, result.numFunctionEvaluations);
+    EXPECT_EQ(stats.numGradients, result.numGradientEvaluations);
+    EXPECT_FALSE(stats.stoppedEarly);
+
+    size_t lineSearchEvaluations = 0;
+    for (size_t i = 0; i < stats.iterations.size(); i++) {
+        const auto &info = stats.iterations[i];
+        EXPECT_EQ(info.iteration, i + 1);
+        EXPECT_LE(info.value, i == 0 ? 6450.0 + 10000.0 : stats.iterations[i - 1].value);
+        EXPECT_GE(info.stepSize, 0.0);
+        lineSearchEvaluations += info.lineSearchEvaluations;
+    }
+    EXPECT_DOUBLE_EQ(stats.iterations[0].gradientNorm, std::sqrt(160.0 * 160.0 + 200.0 * 200.0));
+    EXPECT_EQ(lineSearchEvaluations + result.numIterations + 1, result.numFunctionEvaluations);
+}
+
+TEST(TestGradientDescent, stopReason) {
+    ml::StatsObserver observer([](const ml::IterationInfo &info) { return info.iteration < 3; });
+    const auto stopped = ml::GradientDescent().optimize(ParaboloidFunction(), {100.0, 100.0},
+                                                        observer);
+    EXPECT_EQ(stopped.stopReason, ml::StopReason::Observer);
+    EXPECT_EQ(stopped.numIterations, 3u);
+    EXPECT_TRUE(observer.stats().stoppedEarly);
+
+    ml::GradientDescent::HyperParameters hyperParameters;
+    hyperParameters.maxIter = 2;
+    const auto truncated = ml::GradientDescent()
+                               .withHyperParameters(hyperParameters)
+                               .optimize(ParaboloidFunction(), {100.0, 100.0});
+    EXPECT_EQ(truncated.stopReason, ml::StopReason::MaxIterations);
+
+    const auto failed = ml::GradientDescent().optimize(WrongGradientFunction(), {100.0, 100.0});
+    EXPECT_EQ(failed.stopReason, ml::StopReason::LineSearchFailed);
+    EXPECT_EQ(failed.numIterations, 1u);
+    EXPECT_EQ(failed.optimalArguments[0], 100.0);
+    EXPECT_EQ(failed.optimalArguments[1], 100.0);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
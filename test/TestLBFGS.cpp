@@ -0,0 +1,103 @@
+#include <melon/GradientDescent.h>
+#include <melon/LBFGS.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+class RosenbrockFunction {
+  public:
+    using argument_type = ml::Vector<2>;
+    using gradient_type = argument_type;
+
+    double eval(const argument_type &x) const {
+        return 100.0 * (x[1] - x[0] * x[0]) * (x[1] - x[0] * x[0]) + (1.0 - x[0]) * (1.0 - x[0]);
+    }
+
+    gradient_type gradient(const argument_type &x) const {
+        return {-400.0 * x[0] * (x[1] - x[0] * x[0]) - 2.0 * (1.0 - x[0]),
+                200.0 * (x[1] - x[0] * x[0])};
+    }
+};
+
+template <size_t dim>
+ml::TrainingSet<dim> createSyntheticTrainingSet(const ml::LogisticModel<dim> &model,
+                                                const size_t numExamples) {
+    ml::TrainingSet<dim> trainingSet;
+    ml::Random random;
+
+    for (size_t count = 0; count < numExamples; count++) {
+        const auto x = random.uniform<ml::Vector<dim>>(-1.0, 1.0);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+} // namespace
+
+TEST(TestLBFGS, rosenbrock) {
+    const auto result = ml::LBFGS().optimize(RosenbrockFunction(), {-1.2, 1.0});
+
+    EXPECT_NEAR(result.optimalArguments[0], 1.0, 1E-5);
+    EXPECT_NEAR(result.optimalArguments[1], 1.0, 1E-5);
+    EXPECT_LT(result.numIterations, 100u);
+    EXPECT_EQ(result.numFunctionEvaluations, result.numGradientEvaluations);
+}
+
+TEST(TestLBFGS, logisticRegression) {
+    ml::LogisticModel<5> model({3.0, -1.0, 2.0, 0.5, -4.0, 1.0});
+    const auto trainingSet = createSyntheticTrainingSet(model, 2000);
+    const ml::LogisticRegressionCostFunction<5> costFunction(trainingSet);
+    const ml::Vector<6> initial = {0.0};
+
+    const auto lbfgs = ml::LBFGS().optimize(costFunction, initial);
+    const auto gd = ml::GradientDescent().optimize(costFunction, initial);
+
+    EXPECT_LE(lbfgs.optimalValue, gd.optimalValue + 1E-9);
+    for (size_t i = 0; i < initial.size(); i++)
+        EXPECT_NEAR(lbfgs.optimalArguments[i], model.parameters()[i], 0.05);
+    EXPECT_LT(lbfgs.numGradientEvaluations * 10, gd.numGradientEvaluations);
+}
+
+TEST(TestLBFGS, historySize) {
+    ml::LBFGS::HyperParameters hyperParameters;
+    hyperParameters.historySize = 1;
+
+    ml::LBFGS optimizer;
+    optimizer.withHyperParameters(hyperParameters);
+    const auto result = optimizer.optimize(RosenbrockFunction(), {-1.2, 1.0});
+
+    EXPECT_NEAR(result.optimalArguments[0], 1.0, 1E-4);
+    EXPECT_NEAR(result.optimalArguments[1], 1.0, 1E-4);
+}
+
+TEST(TestLBFGS, observer) {
+    ml::LogisticModel<5> model({3.0, -1.0, 2.0, 0.5, -4.0, 1.0});
+    const auto trainingSet = createSyntheticTrainingSet(model, 2000);
+
+    ml::StatsObserver observer;
+    ml::LogisticRegression<5> observed, plain;
+    observed.fit(trainingSet, ml::observed(ml::LBFGS(), observer));
+    plain.fit(trainingSet, ml::LBFGS());
+
+    // Observing does not change the optimization.
+    for (size_t i = 0; i < 6; i++)
+        EXPECT_EQ(observed.model().parameters()[i], plain.model().parameters()[i]);
+
+    const auto &stats = observer.stats();
+    ASSERT_FALSE(stats.iterations.empty());
+    EXPECT_EQ(stats.numEvals, 0u);
+    EXPECT_GT(stats.numGradients, stats.iterations.size());
+    EXPECT_GT(stats.gradientSeconds, 0.0);
+    for (size_t i = 1; i < stats.iterations.size(); i++) {
+        EXPECT_LE(stats.iterations[i].value, stats.iterations[i - 1].value);
+        EXPECT_GE(stats.iterations[i].lineSearchEvaluations, 1u);
+    }
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
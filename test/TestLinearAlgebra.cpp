@@ -0,0 +1,61 @@
+#include <melon/LinearAlgebra.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+// A = [[4, 2, 0], [2, 5, 3], [0, 3, 6]], A x = b for x = [1, -1, 2].
+ml::SquareMatrix createMatrix() {
+    ml::SquareMatrix a(3);
+    const double values[3][3] = {{4.0, 2.0, 0.0}, {2.0, 5.0, 3.0}, {0.0, 3.0, 6.0}};
+    for (size_t i = 0; i < 3; i++)
+        for (size_t j = 0; j < 3; j++)
+            a(i, j) = values[i][j];
+    return a;
+}
+} // namespace
+
+TEST(TestLinearAlgebra, cholesky) {
+    auto a = createMatrix();
+    double b[3] = {2.0, 3.0, 9.0};
+
+    ASSERT_TRUE(ml::choleskyDecompose(a));
+    ml::choleskySolve(a, b);
+
+    EXPECT_NEAR(b[0], 1.0, 1E-12);
+    EXPECT_NEAR(b[1], -1.0, 1E-12);
+    EXPECT_NEAR(b[2], 2.0, 1E-12);
+}
+
+TEST(TestLinearAlgebra, choleskySingular) {
+    ml::SquareMatrix a(2);
+    a(0, 0) = 1.0;
+    a(1, 0) = a(0, 1) = 1.0;
+    a(1, 1) = 1.0;
+
+    EXPECT_FALSE(ml::choleskyDecompose(a));
+}
+
+TEST(TestLinearAlgebra, givensLeastSquares) {
+    const auto a = createMatrix();
+    const double b[3] = {2.0, 3.0, 9.0};
+    ml::GivensLeastSquares leastSquares(3);
+
+    for (size_t i = 0; i < 3; i++)
+        leastSquares.addRow(a.row(i), b[i]);
+
+    // Redundant rows that are consistent with the solution leave it unchanged.
+    const double extra[3] = {1.0, 1.0, 1.0};
+    leastSquares.addRow(extra, 2.0);
+
+    double x[3];
+    ASSERT_TRUE(leastSquares.solve(x));
+    EXPECT_NEAR(x[0], 1.0, 1E-12);
+    EXPECT_NEAR(x[1], -1.0, 1E-12);
+    EXPECT_NEAR(x[2], 2.0, 1E-12);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
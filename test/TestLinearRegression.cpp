@@ -1,5 +1,8 @@
+#include <melon/GradientDescent.h>
+#include <melon/LBFGS.h>
 #include <melon/LinearModel.h>
 #include <melon/LinearRegression.h>
+#include <melon/NormalEquation.h>
 #include <melon/Random.h>
 
 #include <gtest/gtest.h>
@@ -20,6 +23,33 @@ ml::TrainingSet<dim> createSyntheticTrainingSet(const ml::LinearModel<dim> &mode
 
     return trainingSet;
 }
+
+/**
+ * LBFGS that records the number of iterations of its last run.
+ */
+struct CountingOptimizer {
+    size_t *numIterations;
+
+    template <typename TDifferentiableFunction>
+    auto optimize(const TDifferentiableFunction &function,
+                  const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        const auto result = ml::LBFGS().optimize(function, initialArguments);
+        *numIterations = result.numIterations;
+        return result;
+    }
+};
+
+/**
+ * Optimizer that returns its initial arguments.
+ */
+struct InitialArguments {
+    template <typename TDifferentiableFunction>
+    auto optimize(const TDifferentiableFunction &function,
+                  const typename TDifferentiableFunction::argument_type &initialArguments) const {
+        return ml::OptimizationResult<typename TDifferentiableFunction::argument_type>{
+            initialArguments, function.eval(initialArguments)};
+    }
+};
 } // namespace
 
 TEST(TestLinearRegression, predict) {
@@ -43,6 +73,229 @@ TEST(TestLinearRegression, predict) {
     EXPECT_EQ(numTests, passed);
 }
 
+TEST(TestLinearRegression, squaredError) {
+    const ml::TrainingSet<2> trainingSet = {{{1.0, 2.0}, 1.0}, {{-1.0, 0.0}, 2.0},
+                                            {{3.0, 1.0}, -1.0}};
+    ml::LinearRegressionCostFunction<2> costFunction(trainingSet);
+    costFunction.setRegularizationFactor(0.5);
+
+    // Residuals -0.5, -0.5 and 3.5; the penalty leaves the bias out.
+    const ml::Vector<3> parameters = {0.5, -1.0, 2.0};
+    const auto [value, gradient] = costFunction.valueAndGradient(parameters);
+    EXPECT_NEAR(value, (6.375 + 0.3125) / 3.0, 1E-12);
+    EXPECT_DOUBLE_EQ(costFunction.eval(parameters), value);
+    EXPECT_NEAR(gradient[0], 10.75 / 3.0, 1E-12);
+    EXPECT_NEAR(gradient[1], 2.0 / 3.0, 1E-12);
+    EXPECT_NEAR(gradient[2], 2.5 / 3.0, 1E-12);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_DOUBLE_EQ(gradient[i], costFunction.gradient(parameters)[i]);
+}
+
+TEST(TestLinearRegression, dynamic) {
+    ml::LinearModel<4> model({3.0, 1.0, -4.0, 10.0, 1.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000);
+
+    ml::TrainingSet<ml::Dynamic> dynamicTrainingSet;
+    for (const auto &[x, y] : trainingSet)
+        dynamicTrainingSet.emplace_back(ml::DynamicVector(x.begin(), x.end()), y);
+
+    ml::LinearRegression<4> regression;
+    regression.fit(trainingSet);
+    ml::LinearRegression<ml::Dynamic> dynamicRegression;
+    dynamicRegression.fit(dynamicTrainingSet);
+
+    ml::Random random;
+    for (size_t i = 0; i < 100; i++) {
+        const auto x = random.uniform<ml::Vector<4>>(-1.0, 1.0);
+        EXPECT_NEAR(dynamicRegression.predict(ml::DynamicVector(x.begin(), x.end())),
+                    regression.predict(x), 1E-9);
+    }
+}
+
+TEST(TestLinearRegression, predictBatch) {
+    ml::LinearModel<5> model({3.0, 1.0, -4.0, 10.0, 1.5, -2.0});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000);
+
+    ml::LinearRegression<5> regression;
+    regression.fit(trainingSet);
+
+    const ml::Dataset<5> dataset(createSyntheticTrainingSet(model, 103));
+    std::vector<double> predictions(dataset.size());
+    regression.predictBatch(dataset, predictions.data());
+
+    for (size_t i = 0; i < dataset.size(); i++) {
+        ml::Vector<5> x;
+        std::copy(dataset.row(i), dataset.row(i) + 5, x.begin());
+        EXPECT_NEAR(predictions[i], regression.predict(x), 1E-9 * std::fabs(dataset.label(i)));
+        EXPECT_NEAR(predictions[i], dataset.label(i), 1E-3);
+    }
+}
+
+TEST(TestLinearRegression, float32) {
+    ml::LinearModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7, -4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 10000);
+
+    ml::LinearRegression<10> regression;
+    regression.fit(trainingSet);
+    ml::LinearRegression<10, float> floatRegression;
+    floatRegression.fit(trainingSet);
+
+    // Features rounded to float carry a relative error of 6E-8, labels up to 1E3 an absolute
+    // error of 6E-5, which bounds the error of the fitted model.
+    ml::Random random;
+    for (size_t i = 0; i < 1000; i++) {
+        const auto x = random.uniform<ml::Vector<10>>(-1.0, 1.0);
+        EXPECT_NEAR(floatRegression.predict(x), model.eval(x), 1E-3);
+        EXPECT_NEAR(floatRegression.predict(x), regression.predict(x), 1E-3);
+    }
+
+    const ml::Dataset<10, float> dataset(createSyntheticTrainingSet(model, 100));
+    std::vector<double> predictions(dataset.size());
+    floatRegression.predictBatch(dataset.view(), predictions.data());
+    for (size_t i = 0; i < dataset.size(); i++)
+        EXPECT_NEAR(predictions[i], dataset.label(i), 1E-3 * (1.0 + std::fabs(dataset.label(i))));
+}
+
+TEST(TestLinearRegression, lazyNormalization) {
+    ml::LinearModel<5> model({3.0, 1.0, -4.0, 10.0, 1.5, -2.0});
+    ml::Dataset<5> dataset(createSyntheticTrainingSet(model, 1000));
+    for (size_t i = 0; i < dataset.size(); i++)
+        dataset.row(i)[4] = 7.0;
+
+    ml::LinearRegression<5> lazy;
+    lazy.fit(dataset.view(), ml::NormalEquation());
+    EXPECT_EQ(dataset.row(0)[4], 7.0);
+
+    ml::LinearRegression<5> inPlace;
+    inPlace.fit(std::move(dataset), ml::NormalEquation());
+
+    const auto &expected = inPlace.scoringModel().parameters();
+    const auto &parameters = lazy.scoringModel().parameters();
+    for (size_t i = 0; i < parameters.size(); i++) {
+        EXPECT_TRUE(std::isfinite(parameters[i]));
+        EXPECT_NEAR(parameters[i], expected[i], 1E-9 * (1.0 + std::fabs(expected[i])));
+    }
+}
+
+TEST(TestLinearRegression, refit) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 4.0});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 1000));
+
+    size_t coldIterations = 0, warmIterations = 0;
+    ml::LinearRegression<3> regression;
+    regression.fit(dataset.view().slice(0, 900), CountingOptimizer{&coldIterations});
+    regression.refit(dataset.view(), CountingOptimizer{&warmIterations});
+    EXPECT_LT(warmIterations, coldIterations);
+
+    const auto expected = ml::computeFeatureStatistics(dataset.view());
+    const auto &statistics = regression.statistics();
+    EXPECT_EQ(statistics.count(), dataset.size());
+    for (size_t j = 0; j < 3; j++) {
+        EXPECT_NEAR(statistics.mean()[j], expected.mean()[j], 1E-9);
+        EXPECT_NEAR(statistics.sdev()[j], expected.sdev()[j], 1E-9);
+    }
+
+    const auto &parameters = regression.scoringModel().parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(parameters[i], model.parameters()[i], 1E-4);
+}
+
+TEST(TestLinearRegression, partialFit) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 4.0});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 1000));
+
+    ml::LinearRegression<3> regression;
+    for (size_t begin = 0; begin < dataset.size(); begin += 200)
+        regression.partialFit(dataset.view().slice(begin, begin + 200), ml::GradientDescent());
+
+    const auto expected = ml::computeFeatureStatistics(dataset.view());
+    EXPECT_EQ(regression.statistics().count(), dataset.size());
+    for (size_t j = 0; j < 3; j++)
+        EXPECT_NEAR(regression.statistics().mean()[j], expected.mean()[j], 1E-9);
+
+    const auto &parameters = regression.scoringModel().parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(parameters[i], model.parameters()[i], 1E-3);
+
+    // The state of a model is enough to resume it elsewhere.
+    ml::LinearRegression<3> resumed;
+    resumed.setState(regression.statistics(), regression.refitOffset(),
+                     regression.model().parameters());
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(resumed.scoringModel().parameters()[i], parameters[i], 1E-12);
+}
+
+TEST(TestLinearRegression, partialFitKeepsEarlierBatches) {
+    ml::LinearModel<3> first({1.0, -2.0, 0.5, 4.0}), second({-1.0, 2.0, 1.5, 0.0});
+    const ml::Dataset<3> firstBatch(createSyntheticTrainingSet(first, 1000));
+    const ml::Dataset<3> secondBatch(createSyntheticTrainingSet(second, 200));
+
+    ml::LinearRegression<3> regression;
+    regression.partialFit(firstBatch.view(), ml::GradientDescent());
+    regression.partialFit(secondBatch.view());
+    EXPECT_EQ(regression.statistics().count(), 1200u);
+
+    // One epoch over the second batch only nudges the model fitted on the first.
+    const auto &parameters = regression.scoringModel().parameters();
+    ml::Vector<4> toFirst, toSecond;
+    for (size_t i = 0; i < parameters.size(); i++) {
+        toFirst[i] = parameters[i] - first.parameters()[i];
+        toSecond[i] = parameters[i] - second.parameters()[i];
+    }
+    EXPECT_LT(ml::sqLength(toFirst), 0.1 * ml::sqLength(toSecond));
+}
+
+TEST(TestLinearRegression, refitAfterPartialFit) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 4.0});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 1000));
+    const ml::Dataset<3> batch(createSyntheticTrainingSet(model, 300));
+
+    ml::LinearRegression<3> regression;
+    regression.fit(dataset.view().slice(0, 500), ml::LBFGS());
+    regression.partialFit(batch.view());
+    regression.refit(dataset.view(), ml::LBFGS());
+
+    // The refit reads rows 500 to 1000 of dataset, after the 500 of the fit and the batch.
+    EXPECT_EQ(regression.statistics().count(), dataset.size() + batch.size());
+    const auto &parameters = regression.scoringModel().parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(parameters[i], model.parameters()[i], 1E-4);
+}
+
+TEST(TestLinearRegression, partialFitRejectsOtherFeatures) {
+    ml::LinearModel<4> model({3.0, 1.0, -4.0, 10.0, 1.5});
+    ml::TrainingSet<ml::Dynamic> trainingSet, batch;
+    for (const auto &[x, y] : createSyntheticTrainingSet(model, 200)) {
+        trainingSet.emplace_back(ml::DynamicVector(x.begin(), x.end()), y);
+        batch.emplace_back(ml::DynamicVector(x.begin(), x.end() - 1), y);
+    }
+    const ml::Dataset<ml::Dynamic> dataset(trainingSet), otherFeatures(batch);
+
+    ml::LinearRegression<ml::Dynamic> regression;
+    regression.partialFit(dataset.view());
+    EXPECT_THROW(regression.partialFit(otherFeatures.view()), std::invalid_argument);
+    EXPECT_THROW(regression.refit(otherFeatures.view()), std::invalid_argument);
+
+    // The model is left as it was.
+    EXPECT_EQ(regression.statistics().count(), dataset.size());
+    EXPECT_EQ(regression.statistics().numFeatures(), 4u);
+}
+
+TEST(TestLinearRegression, seed) {
+    ml::LinearModel<3> model({1.0, -2.0, 0.5, 4.0});
+    const ml::Dataset<3> dataset(createSyntheticTrainingSet(model, 100));
+
+    ml::LinearRegression<3> first, second, other;
+    first.withSeed(42).fit(dataset.view(), InitialArguments());
+    second.withSeed(42).fit(dataset.view(), InitialArguments());
+    other.withSeed(43).fit(dataset.view(), InitialArguments());
+
+    const auto expected = ml::Random(42).uniform<ml::Vector<4>>(-0.5, 0.5);
+    EXPECT_EQ(first.model().parameters(), expected);
+    EXPECT_EQ(second.model().parameters(), expected);
+    EXPECT_NE(other.model().parameters(), expected);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -3,6 +3,8 @@
 
 #include <gtest/gtest.h>
 
+#include <cmath>
+
 namespace {
 
 template <size_t dim>
@@ -43,6 +45,122 @@ TEST(TestLogisticRegression, predict) {
     EXPECT_LT(avgError, errorTolerance);
 }
 
+TEST(TestLogisticRegression, float32) {
+    ml::LogisticModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7 - 4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000);
+
+    ml::LogisticRegression<10> regression;
+    regression.fit(trainingSet);
+    ml::LogisticRegression<10, float> floatRegression;
+    floatRegression.fit(trainingSet);
+
+    ml::Random random;
+    const size_t numTests = 1000;
+    double avgError = 0.0, avgDifference = 0.0;
+    for (size_t i = 0; i < numTests; i++) {
+        const auto x = random.uniform<ml::Vector<10>>(-10.0, 10.0);
+        avgError += std::fabs(model.eval(x) - floatRegression.predict(x));
+        avgDifference += std::fabs(regression.predict(x) - floatRegression.predict(x));
+    }
+
+    EXPECT_LT(avgError / static_cast<double>(numTests), 0.02);
+    EXPECT_LT(avgDifference / static_cast<double>(numTests), 1E-3);
+}
+
+TEST(TestLogisticRegression, crossEntropy) {
+    const ml::TrainingSet<1> trainingSet = {{{1.0}, 1.0}, {{-1.0}, 1.0}, {{0.0}, 0.0}};
+    ml::LogisticRegressionCostFunction<1> costFunction(trainingSet);
+    costFunction.setRegularizationFactor(0.0);
+
+    // Predictions 0.75, 0.25 and 0.5.
+    const ml::Vector<2> parameters = {std::log(3.0), 0.0};
+    const auto [value, gradient] = costFunction.valueAndGradient(parameters);
+    EXPECT_NEAR(value, (std::log(4.0 / 3.0) + std::log(4.0) + std::log(2.0)) / 3.0, 1E-12);
+    EXPECT_DOUBLE_EQ(costFunction.eval(parameters), value);
+    EXPECT_NEAR(gradient[0], 0.5 / 3.0, 1E-12);
+    EXPECT_NEAR(gradient[1], -0.5 / 3.0, 1E-12);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_DOUBLE_EQ(gradient[i], costFunction.gradient(parameters)[i]);
+}
+
+TEST(TestLogisticRegression, saturatedPredictions) {
+    ml::LogisticModel<1> model({1.0, 0.0});
+    const ml::TrainingSet<1> trainingSet = {{{-500.0}, 0.0}, {{500.0}, 1.0}, {{-1000.0}, 1.0},
+                                            {{1000.0}, 0.0}};
+    const ml::LogisticRegressionCostFunction<1> costFunction(trainingSet);
+
+    // Correct predictions cost nothing and wrong ones cost their score, even where the
+    // predictions round to 0 or 1.
+    const ml::Vector<2> parameters = {1.0, 0.0};
+    const auto [value, gradient] = costFunction.valueAndGradient(parameters);
+    const double regularization = 0.5 * costFunction.regularizationFactor();
+    EXPECT_NEAR(value, (2000.0 + regularization) / 4.0, 1E-9);
+    EXPECT_DOUBLE_EQ(costFunction.eval(parameters), value);
+    EXPECT_TRUE(std::isfinite(gradient[0]) && std::isfinite(gradient[1]));
+    EXPECT_NEAR(gradient[0], (2000.0 + costFunction.regularizationFactor()) / 4.0, 1E-9);
+    EXPECT_NEAR(gradient[1], 0.0, 1E-12);
+}
+
+TEST(TestLogisticRegression, parallelValueAndGradient) {
+    ml::LogisticModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto trainingSet = createSyntheticTrainingSet(model, 10000);
+    const ml::Vector<4> parameters = {0.1, 0.2, -0.3, 0.4};
+
+    const ml::LogisticRegressionCostFunction<3> serial(trainingSet);
+    ml::LogisticRegressionCostFunction<3> parallel(trainingSet);
+    parallel.setThreadPool(std::make_shared<ml::ThreadPool>(4));
+
+    const auto expected = serial.valueAndGradient(parameters);
+    const auto actual = parallel.valueAndGradient(parameters);
+    EXPECT_NEAR(actual.value, expected.value, 1E-12);
+    EXPECT_NEAR(parallel.eval(parameters), expected.value, 1E-12);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(actual.gradient[i], expected.gradient[i], 1E-12);
+
+    for (size_t run = 0; run < 10; run++) {
+        const auto repeated = parallel.valueAndGradient(parameters);
+        EXPECT_EQ(repeated.value, actual.value);
+        EXPECT_EQ(repeated.gradient, actual.gradient);
+    }
+}
+
+TEST(TestLogisticRegression, dynamicValueAndGradient) {
+    ml::LogisticModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto trainingSet = createSyntheticTrainingSet(model, 100);
+
+    ml::TrainingSet<ml::Dynamic> dynamicTrainingSet;
+    for (const auto &[x, y] : trainingSet)
+        dynamicTrainingSet.emplace_back(ml::DynamicVector(x.begin(), x.end()), y);
+
+    const ml::LogisticRegressionCostFunction<3> costFunction(trainingSet);
+    const ml::LogisticRegressionCostFunction<ml::Dynamic> dynamicCostFunction(dynamicTrainingSet);
+
+    const auto expected = costFunction.valueAndGradient({0.1, 0.2, -0.3, 0.4});
+    const auto actual = dynamicCostFunction.valueAndGradient({0.1, 0.2, -0.3, 0.4});
+    EXPECT_DOUBLE_EQ(actual.value, expected.value);
+    ASSERT_EQ(actual.gradient.size(), expected.gradient.size());
+    for (size_t i = 0; i < expected.gradient.size(); i++)
+        EXPECT_DOUBLE_EQ(actual.gradient[i], expected.gradient[i]);
+}
+
+TEST(TestLogisticRegression, predictBatch) {
+    ml::LogisticModel<5> model({3.0, 1.0, -4.0, 10.0, 1.5, -2.0});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000);
+
+    ml::LogisticRegression<5> regression;
+    regression.fit(trainingSet);
+
+    const ml::Dataset<5> dataset(createSyntheticTrainingSet(model, 103));
+    std::vector<double> predictions(dataset.size());
+    regression.predictBatch(dataset.row(0), dataset.size(), dataset.stride(), predictions.data());
+
+    for (size_t i = 0; i < dataset.size(); i++) {
+        ml::Vector<5> x;
+        std::copy(dataset.row(i), dataset.row(i) + 5, x.begin());
+        EXPECT_NEAR(predictions[i], regression.predict(x), 1E-12);
+    }
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,291 @@
+#include <melon/FeatureExpansion.h>
+#include <melon/LBFGS.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/ModelFile.h>
+#include <melon/Random.h>
+#include <melon/SoftmaxRegression.h>
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename TModel>
+ml::Dataset<3> createSyntheticDataset(const TModel &model, const size_t numExamples) {
+    ml::Dataset<3> dataset;
+    ml::Random random;
+
+    for (size_t i = 0; i < numExamples; i++) {
+        const auto x = random.uniform<ml::Vector<3>>(-10.0, 10.0);
+        dataset.emplace_back(x, model.eval(x));
+    }
+
+    return dataset;
+}
+
+/**
+ * Model file removed when the test ends.
+ */
+class TemporaryFile {
+  public:
+    explicit TemporaryFile(const std::string &name) : m_path(::testing::TempDir() + name) {}
+
+    ~TemporaryFile() { std::remove(m_path.c_str()); }
+
+    const std::string &path() const { return m_path; }
+
+  private:
+    std::string m_path;
+};
+} // namespace
+
+TEST(TestModelFile, folded) {
+    const ml::LogisticModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto dataset = createSyntheticDataset(model, 500);
+    ml::LogisticRegression<3> regression;
+    regression.fit(dataset.view(), ml::LBFGS());
+
+    const TemporaryFile file("folded.model");
+    ml::saveModel(file.path(), regression);
+    const ml::MappedModel mapped(file.path());
+    EXPECT_TRUE(mapped.folded());
+    EXPECT_EQ(mapped.kind(), ml::ModelKind::Logistic);
+    EXPECT_EQ(mapped.numFeatures(), 3u);
+    EXPECT_EQ(mapped.means(), nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(mapped.parameters()) % ml::CacheLineSize, 0u);
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_EQ(mapped.parameters()[i], regression.scoringModel().parameters()[i]);
+
+    std::vector<double> expected(dataset.size()), actual(dataset.size());
+    regression.predictBatch(dataset.view(), expected.data());
+    mapped.predictBatch(dataset.row(0), dataset.size(), dataset.stride(), actual.data());
+    for (size_t i = 0; i < dataset.size(); i++) {
+        EXPECT_NEAR(actual[i], expected[i], 1E-12);
+        EXPECT_NEAR(mapped.predict(dataset.row(i)), expected[i], 1E-12);
+    }
+
+    ml::LogisticRegression<3> loaded;
+    ml::loadModel(file.path(), loaded);
+    const auto &expectedParameters = regression.scoringModel().parameters();
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_NEAR(loaded.scoringModel().parameters()[i], expectedParameters[i], 1E-12);
+}
+
+TEST(TestModelFile, normalized) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto dataset = createSyntheticDataset(model, 500);
+    ml::LinearRegression<3> regression;
+    regression.fit(dataset.view(), ml::LBFGS());
+
+    const TemporaryFile file("normalized.model");
+    ml::saveModel(file.path(), regression, false);
+    const ml::MappedModel mapped(file.path());
+    EXPECT_FALSE(mapped.folded());
+    EXPECT_EQ(mapped.count(), dataset.size());
+    for (size_t i = 0; i < dataset.size(); i++)
+        EXPECT_NEAR(mapped.predict(dataset.row(i)), regression.predict({dataset.row(i)[0],
+                                                                       dataset.row(i)[1],
+                                                                       dataset.row(i)[2]}),
+                    1E-9);
+
+    // Statistics survive the round trip, so training can resume.
+    ml::LinearRegression<3> loaded;
+    ml::loadModel(file.path(), loaded);
+    EXPECT_EQ(loaded.statistics().count(), dataset.size());
+    for (size_t j = 0; j < 3; j++) {
+        EXPECT_EQ(loaded.statistics().mean()[j], regression.statistics().mean()[j]);
+        EXPECT_NEAR(loaded.statistics().sdev()[j], regression.statistics().sdev()[j], 1E-12);
+    }
+    for (size_t i = 0; i < 4; i++)
+        EXPECT_EQ(loaded.model().parameters()[i], regression.model().parameters()[i]);
+}
+
+TEST(TestModelFile, refitAfterPartialFit) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto dataset = createSyntheticDataset(model, 1000);
+    const auto batch = createSyntheticDataset(model, 300);
+    ml::LinearRegression<3> regression;
+    regression.fit(dataset.view().slice(0, 500), ml::LBFGS());
+    regression.partialFit(batch.view());
+
+    const TemporaryFile file("refitAfterPartialFit.model");
+    ml::saveModel(file.path(), regression, false);
+    EXPECT_EQ(ml::MappedModel(file.path()).refitOffset(), 500u);
+
+    // The batch counts in the statistics but not in the dataset refit() extends.
+    ml::LinearRegression<3> loaded;
+    ml::loadModel(file.path(), loaded);
+    EXPECT_EQ(loaded.statistics().count(), 800u);
+    EXPECT_EQ(loaded.refitOffset(), 500u);
+    loaded.refit(dataset.view(), ml::LBFGS());
+    EXPECT_EQ(loaded.statistics().count(), dataset.size() + batch.size());
+
+    const auto &parameters = loaded.scoringModel().parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(parameters[i], model.parameters()[i], 1E-4);
+}
+
+TEST(TestModelFile, refitTruncatedDataset) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto dataset = createSyntheticDataset(model, 500);
+    ml::LinearRegression<3> regression;
+    regression.fit(dataset.view(), ml::LBFGS());
+
+    const TemporaryFile file("refitTruncatedDataset.model");
+    ml::saveModel(file.path(), regression, false);
+    ml::LinearRegression<3> loaded;
+    ml::loadModel(file.path(), loaded);
+    EXPECT_THROW(loaded.refit(dataset.view().slice(0, 400), ml::LBFGS()),
+                 std::invalid_argument);
+    EXPECT_EQ(loaded.refitOffset(), dataset.size());
+}
+
+TEST(TestModelFile, softmax) {
+    const ml::SoftmaxModel<3> model(3, {2.0, 0.0, 0.5, 0.0, -1.0, 2.0, 0.0, 0.0, -1.0, -2.0,
+                                        0.25, 0.5});
+    const auto dataset = createSyntheticDataset(model, 500);
+    ml::SoftmaxRegression<3> regression(3);
+    regression.fit(dataset.view(), ml::LBFGS());
+
+    const TemporaryFile file("softmax.model");
+    ml::saveModel(file.path(), regression);
+    const ml::MappedModel mapped(file.path());
+    EXPECT_EQ(mapped.numClasses(), 3u);
+
+    std::vector<double> expected(3 * dataset.size()), actual(3 * dataset.size());
+    regression.predictBatch(dataset.view(), expected.data());
+    mapped.predictBatch(dataset.row(0), dataset.size(), dataset.stride(), actual.data());
+    for (size_t i = 0; i < actual.size(); i++)
+        EXPECT_NEAR(actual[i], expected[i], 1E-12);
+
+    ml::LinearRegression<3> linear;
+    EXPECT_THROW(ml::loadModel(file.path(), linear), std::runtime_error);
+    ml::SoftmaxRegression<3> fourClasses(4);
+    EXPECT_THROW(ml::loadModel(file.path(), fourClasses), std::runtime_error);
+}
+
+TEST(TestModelFile, invalidFile) {
+    const TemporaryFile file("invalid.model");
+    {
+        std::ofstream out(file.path(), std::ios::binary);
+        const std::vector<char> zeros(256, 0);
+        out.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+    }
+
+    EXPECT_THROW(ml::MappedModel(file.path()), std::runtime_error);
+    EXPECT_THROW(ml::MappedModel(file.path() + ".missing"), std::runtime_error);
+}
+
+TEST(TestModelFile, featureExpansion) {
+    ml::Dataset<ml::Dynamic> dataset(0, 2);
+    ml::Random random;
+    for (size_t i = 0; i < 100; i++) {
+        const auto x = random.uniform<ml::DynamicVector>(2, -1.0, 1.0);
+        dataset.emplace_back(x, x[0] * x[1]);
+    }
+
+    ml::FeatureExpansion expansion(2);
+    expansion.withPolynomialDegree(2);
+    ml::LinearRegression<ml::Dynamic> regression;
+    regression.withFeatureExpansion(expansion).fit(dataset.view(), ml::LBFGS());
+
+    // The file would be scored on raw features as if they were expanded.
+    const TemporaryFile file("featureExpansion.model");
+    EXPECT_THROW(ml::saveModel(file.path(), regression), std::logic_error);
+    EXPECT_THROW(ml::MappedModel(file.path()), std::runtime_error);
+
+    ml::LinearRegression<ml::Dynamic> plain;
+    plain.fit(dataset.view(), ml::LBFGS());
+    ml::saveModel(file.path(), plain);
+    ml::LinearRegression<ml::Dynamic> expanded;
+    expanded.withFeatureExpansion(expansion);
+    EXPECT_THROW(ml::loadModel(file.path(), expanded), std::logic_error);
+}
+
+TEST(TestModelFile, corruptHeader) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    ml::LinearRegression<3> regression;
+    regression.fit(createSyntheticDataset(model, 100).view(), ml::LBFGS());
+    const TemporaryFile file("corruptHeader.model");
+
+    const auto expectCorrupt = [&](const uint64_t numFeatures, const uint64_t numClasses,
+                                   const uint64_t numParameters) {
+        ml::saveModel(file.path(), regression);
+        ml::ModelFileHeader header;
+        std::fstream stream(file.path(), std::ios::in | std::ios::out | std::ios::binary);
+        stream.read(reinterpret_cast<char *>(&header), sizeof(header));
+        header.numFeatures = ml::detail::littleEndian(numFeatures);
+        header.numClasses = ml::detail::littleEndian(numClasses);
+        header.numParameters = ml::detail::littleEndian(numParameters);
+        stream.seekp(0);
+        stream.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        stream.close();
+        EXPECT_THROW(ml::MappedModel(file.path()), std::runtime_error);
+    };
+
+    // Parameters that do not match the shape, and a size that wraps around.
+    expectCorrupt(3, 1, 5);
+    expectCorrupt(3, 0, 0);
+    expectCorrupt((uint64_t(1) << 61) - 1, 1, uint64_t(1) << 61);
+    expectCorrupt(7, (uint64_t(1) << 61) + 1, 8);
+}
+
+TEST(TestModelFile, truncatedFile) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    ml::LinearRegression<3> regression;
+    regression.fit(createSyntheticDataset(model, 100).view(), ml::LBFGS());
+
+    const TemporaryFile file("truncated.model");
+    ml::saveModel(file.path(), regression, false);
+    std::vector<char> bytes;
+    {
+        std::ifstream in(file.path(), std::ios::binary);
+        bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    }
+
+    std::ofstream out(file.path(), std::ios::binary | std::ios::trunc);
+    out.write(bytes.data(), static_cast<std::streamsize>(bytes.size() - ml::CacheLineSize));
+    out.close();
+    EXPECT_THROW(ml::MappedModel(file.path()), std::runtime_error);
+}
+
+TEST(TestModelFile, hotSwap) {
+    const ml::LinearModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto dataset = createSyntheticDataset(model, 200);
+    ml::LinearRegression<3> first, second;
+    first.fit(dataset.view(), ml::LBFGS());
+    second.withRegularizationFactor(1000.0).fit(dataset.view(), ml::LBFGS());
+
+    const TemporaryFile file("hotSwap.model");
+    ml::saveModel(file.path(), first);
+    ml::HotSwappableModel serving(file.path());
+    const auto before = serving.current();
+
+    ml::saveModel(file.path(), second);
+    serving.load(file.path());
+    const auto after = serving.current();
+
+    // Readers holding the previous snapshot keep using it.
+    EXPECT_NEAR(before->predict(dataset.row(0)), first.predict({dataset.row(0)[0],
+                                                                dataset.row(0)[1],
+                                                                dataset.row(0)[2]}),
+                1E-12);
+    EXPECT_NEAR(after->predict(dataset.row(0)), second.predict({dataset.row(0)[0],
+                                                                dataset.row(0)[1],
+                                                                dataset.row(0)[2]}),
+                1E-12);
+
+    EXPECT_THROW(serving.load(file.path() + ".missing"), std::runtime_error);
+    EXPECT_EQ(serving.current(), after);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
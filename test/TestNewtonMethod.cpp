@@ -0,0 +1,79 @@
+#include <melon/GradientDescent.h>
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/NewtonMethod.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename TModel>
+ml::TrainingSet<TModel::ArgumentDim> createSyntheticTrainingSet(const TModel &model,
+                                                                const size_t numExamples) {
+    ml::TrainingSet<TModel::ArgumentDim> trainingSet;
+    ml::Random random;
+
+    for (size_t count = 0; count < numExamples; count++) {
+        const auto x = random.uniform<ml::Vector<TModel::ArgumentDim>>(-1.0, 1.0);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+} // namespace
+
+TEST(TestNewtonMethod, hessian) {
+    ml::LogisticModel<3> model({1.0, -2.0, 0.5, 0.25});
+    const auto trainingSet = createSyntheticTrainingSet(model, 100);
+    const ml::LogisticRegressionCostFunction<3> costFunction(trainingSet);
+
+    const ml::Vector<4> parameters = {0.1, 0.2, -0.3, 0.4};
+    const auto hessian = costFunction.hessian(parameters);
+
+    const double h = 1E-6;
+    for (size_t j = 0; j < parameters.size(); j++) {
+        auto forward = parameters, backward = parameters;
+        forward[j] += h;
+        backward[j] -= h;
+        const auto gradientForward = costFunction.gradient(forward);
+        const auto gradientBackward = costFunction.gradient(backward);
+        for (size_t i = j; i < parameters.size(); i++)
+            EXPECT_NEAR(hessian(i, j), (gradientForward[i] - gradientBackward[i]) / (2 * h), 1E-6);
+    }
+}
+
+TEST(TestNewtonMethod, linearRegression) {
+    ml::LinearModel<4> model({3.0, 1.0, -4.0, 10.0, 1.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000);
+
+    ml::LinearRegression<4> regression;
+    regression.fit(trainingSet, ml::NewtonMethod());
+
+    ml::Random random;
+    for (size_t i = 0; i < 100; i++) {
+        const auto x = random.uniform<ml::Vector<4>>(-1.0, 1.0);
+        EXPECT_NEAR(regression.predict(x), model.eval(x), 1E-4);
+    }
+}
+
+TEST(TestNewtonMethod, logisticRegression) {
+    ml::LogisticModel<5> model({3.0, -1.0, 2.0, 0.5, -4.0, 1.0});
+    const auto trainingSet = createSyntheticTrainingSet(model, 2000);
+    const ml::LogisticRegressionCostFunction<5> costFunction(trainingSet);
+    const ml::Vector<6> initial = {0.0};
+
+    const auto newton = ml::NewtonMethod().optimize(costFunction, initial);
+    const auto gd = ml::GradientDescent().optimize(costFunction, initial);
+
+    EXPECT_LE(newton.optimalValue, gd.optimalValue + 1E-9);
+    for (size_t i = 0; i < initial.size(); i++)
+        EXPECT_NEAR(newton.optimalArguments[i], model.parameters()[i], 0.05);
+    EXPECT_LT(newton.numIterations, 20u);
+    EXPECT_LT(newton.numGradientEvaluations * 10, gd.numGradientEvaluations);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
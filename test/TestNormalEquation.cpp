@@ -0,0 +1,122 @@
+#include <melon/LinearRegression.h>
+#include <melon/NormalEquation.h>
+#include <melon/Random.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <size_t dim>
+ml::TrainingSet<dim> createSyntheticTrainingSet(const ml::LinearModel<dim> &model,
+                                                const size_t numExamples) {
+    ml::TrainingSet<dim> trainingSet;
+    ml::Random random;
+
+    for (size_t count = 0; count < numExamples; count++) {
+        const auto x = random.uniform<ml::Vector<dim>>(-100.0, 100.0);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+
+template <size_t dim>
+size_t countAccuratePredictions(const ml::LinearModel<dim> &model,
+                                const ml::LinearRegression<dim> &regression) {
+    ml::Random random;
+    size_t passed = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        const auto x = random.uniform<ml::Vector<dim>>(-1.0, 1.0);
+        if (std::fabs(model.eval(x) - regression.predict(x)) < 1E-5)
+            passed++;
+    }
+
+    return passed;
+}
+
+using Method = ml::NormalEquation::Method;
+} // namespace
+
+class TestNormalEquation : public ::testing::TestWithParam<Method> {};
+
+TEST_P(TestNormalEquation, predict) {
+    ml::LinearModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7, -4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 10000);
+
+    ml::NormalEquation::HyperParameters hyperParameters;
+    hyperParameters.method = GetParam();
+
+    ml::LinearRegression<10> regression;
+    regression.fit(trainingSet, ml::NormalEquation().withHyperParameters(hyperParameters));
+
+    EXPECT_EQ(countAccuratePredictions(model, regression), 1000u);
+}
+
+TEST_P(TestNormalEquation, parallel) {
+    ml::LinearModel<4> model({3.0, 1.0, -4.0, 10.0, 1.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 20000);
+
+    ml::NormalEquation::HyperParameters hyperParameters;
+    hyperParameters.method = GetParam();
+
+    ml::LinearRegression<4> regression;
+    regression.withNumThreads(4);
+    regression.fit(trainingSet, ml::NormalEquation().withHyperParameters(hyperParameters));
+
+    EXPECT_EQ(countAccuratePredictions(model, regression), 1000u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Methods, TestNormalEquation,
+                         ::testing::Values(Method::Automatic, Method::Cholesky, Method::QR));
+
+TEST(TestNormalEquation, collinearFeatures) {
+    ml::LinearModel<3> model({2.0, 0.0, -1.0, 0.5});
+    auto trainingSet = createSyntheticTrainingSet(model, 1000);
+    for (auto &[x, y] : trainingSet)
+        x[1] = 2.0 * x[0];
+
+    ml::LinearRegression<3> regression;
+    regression.fit(trainingSet, ml::NormalEquation());
+
+    ml::Random random;
+    for (size_t i = 0; i < 100; i++) {
+        auto x = random.uniform<ml::Vector<3>>(-1.0, 1.0);
+        x[1] = 2.0 * x[0];
+        EXPECT_NEAR(regression.predict(x), model.eval(x), 1E-4);
+    }
+}
+
+TEST(TestNormalEquation, singular) {
+    ml::LinearModel<3> model({2.0, 0.0, -1.0, 0.5});
+    auto trainingSet = createSyntheticTrainingSet(model, 1000);
+    for (auto &[x, y] : trainingSet)
+        x[1] = 2.0 * x[0];
+
+    // Without regularization the Gram matrix of collinear features has no Cholesky factor.
+    ml::LinearRegressionCostFunction<3> costFunction(trainingSet);
+    costFunction.setRegularizationFactor(0.0);
+    ml::NormalEquation::HyperParameters hyperParameters;
+    hyperParameters.method = Method::Cholesky;
+
+    const ml::Vector<4> initialArguments = {1.0, 2.0, 3.0, 4.0};
+    const auto result = ml::NormalEquation()
+                            .withHyperParameters(hyperParameters)
+                            .optimize(costFunction, initialArguments);
+    EXPECT_EQ(result.stopReason, ml::StopReason::Singular);
+    for (size_t i = 0; i < initialArguments.size(); i++)
+        EXPECT_EQ(result.optimalArguments[i], initialArguments[i]);
+}
+
+TEST(TestNormalEquation, l1Penalty) {
+    ml::LinearModel<3> model({2.0, 0.0, -1.0, 0.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 100);
+
+    ml::LinearRegression<3> regression;
+    regression.withL1RegularizationFactor(0.1);
+    EXPECT_THROW(regression.fit(trainingSet, ml::NormalEquation()), std::logic_error);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
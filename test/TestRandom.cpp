@@ -2,6 +2,11 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <numeric>
+#include <thread>
+#include <vector>
+
 const double tolerance = 0.1;
 
 TEST(TestRandom, uniform) {
@@ -40,6 +45,106 @@ TEST(TestRandom, normal) {
     }
 }
 
+TEST(TestRandom, xoshiro) {
+    // Reference output of xoshiro256++ for the state {1, 2, 3, 4}.
+    ml::Xoshiro256 generator(1, 2, 3, 4);
+    EXPECT_EQ(generator(), 41943041u);
+    EXPECT_EQ(generator(), 58720359u);
+
+    // A jump is a fixed linear map: jumping then stepping equals stepping then jumping.
+    ml::Xoshiro256 a(42), b(42);
+    a.jump();
+    a();
+    b();
+    b.jump();
+    EXPECT_EQ(a(), b());
+}
+
+TEST(TestRandom, reproducible) {
+    // Values drawn one at a time and in bulk, with any split, form the same sequence.
+    const size_t n = 1000;
+    ml::Random single(7), bulk(7);
+    std::vector<double> expected(n), actual(n);
+    for (auto &value : expected)
+        value = single.uniform();
+    bulk.uniform(actual.data(), 3, 0.0, 1.0);
+    bulk.uniform(actual.data() + 3, 500, 0.0, 1.0);
+    for (size_t i = 503; i < n; i++)
+        actual[i] = bulk.uniform();
+    EXPECT_EQ(expected, actual);
+
+    // Streams of a seed and different seeds give different sequences.
+    EXPECT_NE(ml::Random(7, 0).uniform(), ml::Random(7, 1).uniform());
+    EXPECT_NE(ml::Random(7).uniform(), ml::Random(8).uniform());
+    EXPECT_EQ(ml::Random(7, 3).uniform(), ml::Random(7, 3).uniform());
+}
+
+TEST(TestRandom, parallelStreams) {
+    // Streams filled by concurrent threads match the same streams filled serially.
+    const size_t numStreams = 4, n = 10000;
+    std::vector<std::vector<double>> parallel(numStreams, std::vector<double>(n));
+    std::vector<std::thread> threads;
+    for (size_t s = 0; s < numStreams; s++)
+        threads.emplace_back([&, s] { ml::Random(11, s).normal(parallel[s].data(), n, 0.0, 1.0); });
+    for (auto &thread : threads)
+        thread.join();
+
+    for (size_t s = 0; s < numStreams; s++) {
+        std::vector<double> serial(n);
+        ml::Random(11, s).normal(serial.data(), n, 0.0, 1.0);
+        EXPECT_EQ(serial, parallel[s]);
+
+        // Uncorrelated with the first stream.
+        if (s > 0) {
+            double correlation = 0.0;
+            for (size_t i = 0; i < n; i++)
+                correlation += parallel[0][i] * parallel[s][i];
+            EXPECT_NEAR(correlation / n, 0.0, 0.05);
+        }
+    }
+}
+
+TEST(TestRandom, normalMoments) {
+    ml::Random random;
+    const size_t n = 100001;
+    std::vector<double> values(n);
+    random.normal(values.data(), n, 4.0, 2.0);
+
+    double sum = 0.0, sumOfSquares = 0.0;
+    for (const double value : values) {
+        sum += value;
+        sumOfSquares += (value - 4.0) * (value - 4.0);
+    }
+    EXPECT_NEAR(sum / n, 4.0, 0.05);
+    EXPECT_NEAR(sumOfSquares / n, 4.0, 0.1);
+}
+
+TEST(TestRandom, indices) {
+    ml::Random random(3);
+    std::vector<size_t> sample(10000);
+    random.indices(sample.data(), sample.size(), 10);
+
+    std::vector<size_t> counts(10, 0);
+    for (const size_t i : sample) {
+        ASSERT_LT(i, 10u);
+        counts[i]++;
+    }
+    for (const size_t count : counts)
+        EXPECT_NEAR(count, 1000.0, 150.0);
+
+    std::vector<int> permutation(100);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    random.shuffle(permutation.begin(), permutation.end());
+    EXPECT_FALSE(std::is_sorted(permutation.begin(), permutation.end()));
+    std::sort(permutation.begin(), permutation.end());
+    for (int i = 0; i < 100; i++)
+        EXPECT_EQ(permutation[i], i);
+
+    // Random is a uniform random bit generator.
+    std::shuffle(permutation.begin(), permutation.end(), random);
+    EXPECT_FALSE(std::is_sorted(permutation.begin(), permutation.end()));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,224 @@
+#include <melon/Random.h>
+#include <melon/Simd.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+namespace {
+
+std::vector<double> randomValues(const size_t n, const double lo, const double hi) {
+    ml::Random random;
+    std::vector<double> values(n);
+    for (auto &value : values)
+        value = random.uniform<ml::Vector<1>>(lo, hi)[0];
+    return values;
+}
+} // namespace
+
+TEST(TestSimd, dot) {
+    for (size_t n = 0; n < 40; n++) {
+        const auto a = randomValues(n, -1.0, 1.0), b = randomValues(n, -1.0, 1.0);
+        const auto w = randomValues(n, 0.0, 1.0);
+        double expectedDot = 0.0, expectedSquares = 0.0, expectedWeighted = 0.0;
+        for (size_t i = 0; i < n; i++) {
+            expectedDot += a[i] * b[i];
+            expectedSquares += a[i] * a[i];
+            expectedWeighted += w[i] * a[i] * b[i];
+        }
+
+        EXPECT_NEAR(ml::simd::dot(a.data(), b.data(), n), expectedDot, 1E-12);
+        EXPECT_NEAR(ml::simd::sumOfSquares(a.data(), n), expectedSquares, 1E-12);
+        EXPECT_NEAR(ml::simd::weightedDot(a.data(), b.data(), w.data(), n), expectedWeighted,
+                    1E-12);
+    }
+}
+
+TEST(TestSimd, axpy) {
+    for (size_t n = 0; n < 20; n++) {
+        const auto x = randomValues(n, -1.0, 1.0);
+        auto y = randomValues(n, -1.0, 1.0);
+        const auto expected = y;
+
+        ml::simd::axpy(2.5, x.data(), y.data(), n);
+        for (size_t i = 0; i < n; i++)
+            EXPECT_NEAR(y[i], expected[i] + 2.5 * x[i], 1E-15);
+    }
+}
+
+TEST(TestSimd, gemv) {
+    const size_t cols = 11, stride = 16;
+    for (size_t rows = 0; rows < 10; rows++) {
+        const auto a = randomValues(rows * stride, -1.0, 1.0), x = randomValues(cols, -1.0, 1.0);
+        std::vector<double> y(rows);
+
+        ml::simd::gemv(a.data(), rows, cols, stride, x.data(), y.data());
+        for (size_t r = 0; r < rows; r++)
+            EXPECT_NEAR(y[r], ml::simd::dot(a.data() + r * stride, x.data(), cols), 1E-12);
+    }
+}
+
+TEST(TestSimd, gemm) {
+    const size_t cols = 11, stride = 16, bStride = 12, rows = 5;
+    const auto a = randomValues(rows * stride, -1.0, 1.0);
+    for (size_t numB = 0; numB < 10; numB++) {
+        const auto b = randomValues(numB * bStride, -1.0, 1.0);
+        std::vector<double> out(rows * numB);
+        ml::simd::gemm(a.data(), rows, cols, stride, b.data(), numB, bStride, out.data());
+        for (size_t r = 0; r < rows; r++)
+            for (size_t c = 0; c < numB; c++)
+                EXPECT_NEAR(out[r * numB + c],
+                            ml::simd::dot(a.data() + r * stride, b.data() + c * bStride, cols),
+                            1E-12);
+    }
+}
+
+TEST(TestSimd, softmax) {
+    const size_t rows = 3, cols = 5;
+    std::vector<double> z = {1.0,   2.0,    3.0,   4.0,   5.0, // well scaled
+                             0.0,   0.0,    0.0,   0.0,   0.0, // uniform
+                             800.0, -800.0, 799.0, 700.0, 0.0};
+    const std::vector<double> logits = z;
+    std::vector<double> logSumExp(rows);
+    ml::simd::softmax(z.data(), rows, cols, logSumExp.data());
+
+    for (size_t r = 0; r < rows; r++) {
+        const double *zr = logits.data() + r * cols;
+        const double maximum = *std::max_element(zr, zr + cols);
+        double sum = 0.0;
+        for (size_t c = 0; c < cols; c++)
+            sum += std::exp(zr[c] - maximum);
+
+        EXPECT_NEAR(logSumExp[r], maximum + std::log(sum), 1E-12);
+        for (size_t c = 0; c < cols; c++)
+            EXPECT_NEAR(z[r * cols + c], std::exp(zr[c] - maximum) / sum, 1E-14);
+    }
+}
+
+TEST(TestSimd, mixedPrecision) {
+    const size_t cols = 13, stride = 16, rows = 7;
+    const auto a = randomValues(rows * stride, -1.0, 1.0), x = randomValues(cols, -1.0, 1.0);
+    const std::vector<float> af(a.begin(), a.end());
+    const std::vector<double> widened(af.begin(), af.end());
+
+    std::vector<double> converted(af.size());
+    ml::simd::convert(af.data(), converted.data(), af.size());
+    EXPECT_EQ(converted, widened);
+
+    std::vector<double> y(rows), expected(rows);
+    ml::simd::gemv(af.data(), rows, cols, stride, x.data(), y.data());
+    ml::simd::gemv(widened.data(), rows, cols, stride, x.data(), expected.data());
+    for (size_t r = 0; r < rows; r++) {
+        EXPECT_NEAR(y[r], expected[r], 1E-12);
+        EXPECT_NEAR(ml::simd::dot(af.data() + r * stride, x.data(), cols), expected[r], 1E-12);
+    }
+
+    std::vector<double> sum(cols, 1.0), expectedSum(cols, 1.0);
+    ml::simd::axpy(0.5, af.data(), sum.data(), cols);
+    ml::simd::axpy(0.5, widened.data(), expectedSum.data(), cols);
+    EXPECT_EQ(sum, expectedSum);
+}
+
+TEST(TestSimd, sparse) {
+    const size_t n = 1000;
+    const auto x = randomValues(n, -1.0, 1.0);
+    for (size_t nnz = 0; nnz < 20; nnz++) {
+        std::vector<uint32_t> indices(nnz);
+        std::vector<double> values(nnz), dense(n, 0.0);
+        for (size_t k = 0; k < nnz; k++) {
+            indices[k] = static_cast<uint32_t>(k * 47 + 3);
+            values[k] = 0.5 * static_cast<double>(k) - 2.0;
+            dense[indices[k]] = values[k];
+        }
+
+        EXPECT_NEAR(ml::simd::sparseDot(indices.data(), values.data(), nnz, x.data()),
+                    ml::simd::dot(dense.data(), x.data(), n), 1E-12);
+
+        std::vector<double> y(x), expected(x);
+        ml::simd::sparseAxpy(-2.0, indices.data(), values.data(), nnz, y.data());
+        ml::simd::axpy(-2.0, dense.data(), expected.data(), n);
+        EXPECT_EQ(y, expected);
+    }
+}
+
+TEST(TestSimd, elementwise) {
+    const size_t n = 13;
+    const auto a = randomValues(n, 1.0, 2.0), b = randomValues(n, 1.0, 2.0);
+    std::vector<double> out(n);
+
+    ml::simd::add(a.data(), b.data(), out.data(), n);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(out[i], a[i] + b[i]);
+
+    ml::simd::sub(a.data(), b.data(), out.data(), n);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(out[i], a[i] - b[i]);
+
+    ml::simd::mul(a.data(), b.data(), out.data(), n);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(out[i], a[i] * b[i]);
+
+    ml::simd::div(a.data(), b.data(), out.data(), n);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(out[i], a[i] / b[i]);
+
+    ml::simd::mul(a.data(), 3.0, out.data(), n);
+    for (size_t i = 0; i < n; i++)
+        EXPECT_EQ(out[i], a[i] * 3.0);
+}
+
+TEST(TestSimd, sigmoid) {
+    const size_t n = 1001;
+    std::vector<double> z(n), out(n);
+    for (size_t i = 0; i < n; i++)
+        z[i] = -750.0 + 1.5 * static_cast<double>(i);
+
+    ml::simd::sigmoid(z.data(), out.data(), n);
+    for (size_t i = 0; i < n; i++) {
+        const double expected = 1.0 / (1.0 + std::exp(-z[i]));
+        EXPECT_NEAR(out[i], expected, 1E-14 * expected + 1E-300);
+    }
+}
+
+TEST(TestSimd, logisticLoss) {
+    const size_t n = 1001;
+    std::vector<double> z(n), y(n), loss(n), residual(n);
+    for (size_t i = 0; i < n; i++) {
+        z[i] = -750.0 + 1.5 * static_cast<double>(i);
+        y[i] = static_cast<double>(i % 3) / 2.0;
+    }
+
+    ml::simd::logisticLoss(z.data(), y.data(), loss.data(), residual.data(), n);
+    for (size_t i = 0; i < n; i++) {
+        const long double zi = z[i], yi = y[i];
+        const double expected = static_cast<double>(std::log1p(std::exp(-std::fabs(zi))) +
+                                                    (std::max(zi, 0.0L) - yi * zi));
+        EXPECT_TRUE(std::isfinite(loss[i]));
+        EXPECT_NEAR(loss[i], expected, 1E-14 * std::fabs(expected) + 1E-300);
+        EXPECT_NEAR(loss[i], ml::simd::logisticLoss(z[i], y[i]),
+                    1E-14 * std::fabs(expected) + 1E-300);
+
+        const double sigmoid = static_cast<double>(1.0L / (1.0L + std::exp(-zi)));
+        EXPECT_NEAR(residual[i], sigmoid - y[i], 1E-14);
+    }
+
+    // Losses of correct predictions keep their relative accuracy down to the smallest ones.
+    std::vector<double> zs = {-690.0, -46.0, -18.0, -2.3, -0.7, 0.0, -1E-9, -3.0};
+    std::vector<double> ys(zs.size(), 0.0), losses(zs.size()), residuals(zs.size());
+    ml::simd::logisticLoss(zs.data(), ys.data(), losses.data(), residuals.data(), zs.size());
+    for (size_t i = 0; i < zs.size(); i++) {
+        const double expected = std::log1p(std::exp(zs[i]));
+        EXPECT_NEAR(losses[i], expected, 1E-14 * expected);
+    }
+
+    EXPECT_DOUBLE_EQ(ml::simd::softplus(800.0), 800.0);
+    EXPECT_DOUBLE_EQ(ml::simd::softplus(-800.0), 0.0);
+    EXPECT_NEAR(ml::simd::softplus(0.0), std::log(2.0), 1E-15);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,144 @@
+#include <melon/LBFGS.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+#include <melon/SoftmaxRegression.h>
+#include <melon/StochasticGradientDescent.h>
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+namespace {
+
+/**
+ * Examples labeled with the most likely class of model.
+ */
+template <size_t dim>
+ml::TrainingSet<dim> createSyntheticTrainingSet(const ml::SoftmaxModel<dim> &model,
+                                                const size_t numExamples) {
+    ml::TrainingSet<dim> trainingSet;
+    ml::Random random;
+
+    for (size_t i = 0; i < numExamples; i++) {
+        const auto x = random.uniform<ml::Vector<dim>>(-3.0, 3.0);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+
+const ml::SoftmaxModel<2> threeClasses(3, {2.0, 0.0, 0.5, -1.0, 2.0, 0.0, -1.0, -2.0, 0.25});
+} // namespace
+
+TEST(TestSoftmaxRegression, valueAndGradient) {
+    const auto trainingSet = createSyntheticTrainingSet(threeClasses, 100);
+    const ml::SoftmaxRegressionCostFunction<2> costFunction(trainingSet, 3);
+
+    const ml::DynamicVector parameters = {0.1, 0.2, -0.3, 0.4, -0.5, 0.6, 0.7, -0.8, 0.9};
+    const auto [value, gradient] = costFunction.valueAndGradient(parameters);
+    EXPECT_NEAR(value, costFunction.eval(parameters), 1E-12);
+
+    const double h = 1E-6;
+    for (size_t i = 0; i < parameters.size(); i++) {
+        auto forward = parameters, backward = parameters;
+        forward[i] += h;
+        backward[i] -= h;
+        const double expected =
+            (costFunction.eval(forward) - costFunction.eval(backward)) / (2 * h);
+        EXPECT_NEAR(gradient[i], expected, 1E-6);
+        EXPECT_DOUBLE_EQ(gradient[i], costFunction.gradient(parameters)[i]);
+    }
+
+    std::vector<size_t> batch(trainingSet.size());
+    std::iota(batch.begin(), batch.end(), 0);
+    const auto batchGradient = costFunction.batchGradient(parameters, batch.data(), batch.size());
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(batchGradient[i], gradient[i], 1E-12);
+}
+
+TEST(TestSoftmaxRegression, twoClassesMatchLogistic) {
+    ml::LogisticModel<2> model({1.0, -2.0, 0.5});
+    ml::TrainingSet<2> trainingSet;
+    ml::Random random;
+    for (size_t i = 0; i < 200; i++) {
+        const auto x = random.uniform<ml::Vector<2>>(-3.0, 3.0);
+        trainingSet.emplace_back(x, model.eval(x) > 0.5 ? 1.0 : 0.0);
+    }
+
+    // With the weights of class 0 at zero, the softmax logit of class 1 is the logistic score.
+    const ml::SoftmaxRegressionCostFunction<2> softmax(trainingSet, 2);
+    const ml::LogisticRegressionCostFunction<2> logistic(trainingSet);
+    EXPECT_NEAR(softmax.eval({0.0, 0.0, 0.0, 0.3, -0.7, 0.2}), logistic.eval({0.3, -0.7, 0.2}),
+                1E-12);
+
+    // Logits far beyond the range of exp still give a finite cost.
+    EXPECT_TRUE(std::isfinite(softmax.eval({0.0, 0.0, 0.0, 900.0, -900.0, 0.0})));
+}
+
+TEST(TestSoftmaxRegression, predict) {
+    const auto trainingSet = createSyntheticTrainingSet(threeClasses, 2000);
+
+    ml::SoftmaxRegression<2> regression(3);
+    regression.fit(trainingSet, ml::LBFGS());
+
+    const auto testSet = createSyntheticTrainingSet(threeClasses, 1000);
+    size_t numCorrect = 0;
+    for (const auto &[x, y] : testSet)
+        numCorrect += regression.predict(x) == y ? 1 : 0;
+
+    EXPECT_GT(static_cast<double>(numCorrect) / static_cast<double>(testSet.size()), 0.97);
+}
+
+TEST(TestSoftmaxRegression, predictBatch) {
+    const auto trainingSet = createSyntheticTrainingSet(threeClasses, 500);
+
+    ml::SoftmaxRegression<2> regression(3);
+    regression.fit(trainingSet);
+
+    const ml::Dataset<2> dataset(createSyntheticTrainingSet(threeClasses, 103));
+    std::vector<double> probabilities(3 * dataset.size());
+    regression.predictBatch(dataset.row(0), dataset.size(), dataset.stride(),
+                            probabilities.data());
+
+    for (size_t i = 0; i < dataset.size(); i++) {
+        const ml::Vector<2> x = {dataset.row(i)[0], dataset.row(i)[1]};
+        const double *p = probabilities.data() + 3 * i;
+        EXPECT_NEAR(p[0] + p[1] + p[2], 1.0, 1E-12);
+
+        const size_t best = static_cast<size_t>(std::max_element(p, p + 3) - p);
+        EXPECT_EQ(static_cast<double>(best), regression.predict(x));
+
+        double expected[3];
+        regression.predictProbabilities(x, expected);
+        for (size_t c = 0; c < 3; c++)
+            EXPECT_NEAR(p[c], expected[c], 1E-12);
+    }
+}
+
+TEST(TestSoftmaxRegression, stochasticGradientDescent) {
+    const auto trainingSet = createSyntheticTrainingSet(threeClasses, 2000);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.learningRate = 0.05;
+    hyperParameters.maxEpochs = 30;
+
+    ml::SoftmaxRegression<ml::Dynamic> regression(3);
+    ml::TrainingSet<ml::Dynamic> dynamicTrainingSet;
+    for (const auto &[x, y] : trainingSet)
+        dynamicTrainingSet.emplace_back(ml::DynamicVector(x.begin(), x.end()), y);
+    regression.fit(dynamicTrainingSet,
+                   ml::StochasticGradientDescent().withHyperParameters(hyperParameters));
+
+    size_t numCorrect = 0;
+    for (const auto &[x, y] : createSyntheticTrainingSet(threeClasses, 1000))
+        numCorrect += regression.predict(ml::DynamicVector(x.begin(), x.end())) == y ? 1 : 0;
+
+    EXPECT_GT(static_cast<double>(numCorrect) / 1000.0, 0.95);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,63 @@
+#include <melon/SparseDataset.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+ml::Dataset<4> createDataset() {
+    return ml::Dataset<4>(ml::TrainingSet<4>{{{0.0, 2.0, 0.0, 0.0}, 1.0},
+                                             {{0.0, 0.0, 0.0, 0.0}, -1.0},
+                                             {{5.0, 0.0, 0.0, -1.5}, 0.5}});
+}
+} // namespace
+
+TEST(TestSparseDataset, fromDense) {
+    const auto dense = createDataset();
+    const ml::SparseDataset dataset(dense.view());
+
+    ASSERT_EQ(dataset.size(), 3u);
+    EXPECT_EQ(dataset.numFeatures(), 4u);
+    EXPECT_EQ(dataset.nnz(), 3u);
+
+    const auto row = dataset.row(2);
+    ASSERT_EQ(row.size, 2u);
+    EXPECT_EQ(row.indices[0], 0u);
+    EXPECT_EQ(row.values[0], 5.0);
+    EXPECT_EQ(row.indices[1], 3u);
+    EXPECT_EQ(row.values[1], -1.5);
+    EXPECT_EQ(dataset.row(1).size, 0u);
+    EXPECT_EQ(dataset.label(2), 0.5);
+}
+
+TEST(TestSparseDataset, emplaceBack) {
+    ml::SparseDataset dataset(1000);
+    dataset.emplace_back({{3, 1.0}, {999, 2.0}}, 1.0);
+    const uint32_t indices[] = {7, 8, 9};
+    const double values[] = {0.5, 0.25, 0.125};
+    dataset.emplace_back(indices, values, 3, 0.0);
+
+    EXPECT_EQ(dataset.size(), 2u);
+    EXPECT_EQ(dataset.nnz(), 5u);
+    EXPECT_EQ(dataset.row(0).indices[1], 999u);
+    EXPECT_EQ(dataset.row(1).values[2], 0.125);
+}
+
+TEST(TestSparseDataset, slice) {
+    const ml::SparseDataset dataset(createDataset().view());
+    const auto slice = dataset.view().slice(1, 3);
+
+    ASSERT_EQ(slice.size(), 2u);
+    EXPECT_EQ(slice.nnz(), 2u);
+    EXPECT_EQ(slice.row(0).size, 0u);
+    EXPECT_EQ(slice.row(1).values[0], 5.0);
+    EXPECT_EQ(slice.label(1), 0.5);
+}
+
+TEST(TestSparseDataset, dot) {
+    const ml::SparseDataset dataset(createDataset().view());
+    const double weights[] = {1.0, -1.0, 3.0, 2.0};
+
+    EXPECT_DOUBLE_EQ(ml::dot(dataset.row(0), weights), -2.0);
+    EXPECT_DOUBLE_EQ(ml::dot(dataset.row(1), weights), 0.0);
+    EXPECT_DOUBLE_EQ(ml::dot(dataset.row(2), weights), 2.0);
+}
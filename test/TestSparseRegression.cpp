@@ -0,0 +1,187 @@
+#include <melon/LBFGS.h>
+#include <melon/SparseRegression.h>
+#include <melon/StochasticGradientDescent.h>
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+
+namespace {
+
+constexpr size_t NumFeatures = 200;
+constexpr size_t NonZerosPerRow = 5;
+
+/**
+ * Examples with NonZerosPerRow random features of random magnitude each, labelled by model.
+ */
+template <typename TModel>
+ml::SparseDataset createSyntheticDataset(const TModel &model, const size_t numExamples,
+                                         const unsigned seed = 1) {
+    std::mt19937 generator(seed);
+    std::uniform_int_distribution<uint32_t> feature(0, NumFeatures - 1);
+    std::uniform_real_distribution<double> value(0.5, 4.0);
+
+    ml::SparseDataset dataset(NumFeatures);
+    std::vector<uint32_t> indices;
+    std::vector<double> values(NonZerosPerRow);
+    for (size_t i = 0; i < numExamples; i++) {
+        indices.clear();
+        while (indices.size() < NonZerosPerRow) {
+            const uint32_t j = feature(generator);
+            if (std::find(indices.begin(), indices.end(), j) == indices.end())
+                indices.push_back(j);
+        }
+        std::sort(indices.begin(), indices.end());
+        for (auto &v : values)
+            v = value(generator);
+
+        const ml::SparseVectorView x{indices.data(), values.data(), NonZerosPerRow};
+        dataset.emplace_back(indices.data(), values.data(), NonZerosPerRow, model.eval(x));
+    }
+
+    return dataset;
+}
+
+ml::Dataset<ml::Dynamic> toDense(const ml::SparseDataset &sparse) {
+    ml::Dataset<ml::Dynamic> dataset(sparse.size(), sparse.numFeatures());
+    for (size_t i = 0; i < sparse.size(); i++) {
+        const auto x = sparse.row(i);
+        for (size_t n = 0; n < x.size; n++)
+            dataset.row(i)[x.indices[n]] = x.values[n];
+        dataset.label(i) = sparse.label(i);
+    }
+    return dataset;
+}
+
+template <typename TModel> TModel randomModel(const double lo, const double hi) {
+    return TModel(ml::Random().uniform<ml::DynamicVector>(NumFeatures + 1, lo, hi));
+}
+} // namespace
+
+TEST(TestSparseRegression, matchesDense) {
+    const auto model = randomModel<ml::LogisticModel<ml::Dynamic>>(-1.0, 1.0);
+    const auto sparse = createSyntheticDataset(model, 3000);
+    const auto dense = toDense(sparse);
+
+    const ml::SparseLogisticRegressionCostFunction<> sparseCost(sparse);
+    const ml::LogisticRegressionCostFunction<ml::Dynamic> denseCost(dense.view());
+
+    const auto parameters = ml::Random().uniform<ml::DynamicVector>(NumFeatures + 1, -0.1, 0.1);
+    const auto [value, gradient] = sparseCost.valueAndGradient(parameters);
+    const auto expected = denseCost.valueAndGradient(parameters);
+
+    EXPECT_NEAR(value, expected.value, 1E-12);
+    EXPECT_NEAR(sparseCost.eval(parameters), expected.value, 1E-12);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(gradient[i], expected.gradient[i], 1E-12);
+
+    const size_t batch[] = {4, 8, 15, 16, 23, 42};
+    const auto batchGradient = sparseCost.batchGradient(parameters, batch, 6);
+    const auto expectedBatchGradient = denseCost.batchGradient(parameters, batch, 6);
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_NEAR(batchGradient[i], expectedBatchGradient[i], 1E-12);
+}
+
+TEST(TestSparseRegression, scaledGradient) {
+    const auto model = randomModel<ml::LinearModel<ml::Dynamic>>(-1.0, 1.0);
+    const auto dataset = createSyntheticDataset(model, 500);
+
+    ml::SparseLinearRegressionCostFunction<> costFunction(dataset);
+    costFunction.setFeatureScaling(ml::Random().uniform<ml::DynamicVector>(NumFeatures, 0.5, 2.0));
+
+    const auto parameters = ml::Random().uniform<ml::DynamicVector>(NumFeatures + 1, -1.0, 1.0);
+    const auto gradient = costFunction.gradient(parameters);
+
+    const double h = 1E-6;
+    for (size_t i = 0; i < parameters.size(); i += 17) {
+        auto forward = parameters, backward = parameters;
+        forward[i] += h;
+        backward[i] -= h;
+        const double expected =
+            (costFunction.eval(forward) - costFunction.eval(backward)) / (2 * h);
+        EXPECT_NEAR(gradient[i], expected, 1E-5);
+    }
+}
+
+TEST(TestSparseRegression, sparseStep) {
+    const auto model = randomModel<ml::LogisticModel<ml::Dynamic>>(-1.0, 1.0);
+    const auto dataset = createSyntheticDataset(model, 100);
+
+    ml::SparseLogisticRegressionCostFunction<> costFunction(dataset);
+    costFunction.setFeatureScaling(ml::Random().uniform<ml::DynamicVector>(NumFeatures, 0.5, 2.0));
+
+    const auto initial = ml::Random().uniform<ml::DynamicVector>(NumFeatures + 1, -1.0, 1.0);
+    auto expected = initial, arguments = initial;
+    double weightScale = 1.0;
+    const double learningRate = 0.1;
+    const size_t batches[2][3] = {{3, 1, 4}, {15, 9, 2}};
+    for (const auto &batch : batches) {
+        expected = expected - learningRate * costFunction.batchGradient(expected, batch, 3);
+        costFunction.sparseStep(arguments, weightScale, batch, 3, learningRate);
+    }
+
+    EXPECT_LT(weightScale, 1.0);
+    costFunction.applyWeightScale(arguments, weightScale);
+    EXPECT_EQ(weightScale, 1.0);
+    for (size_t i = 0; i < arguments.size(); i++)
+        EXPECT_NEAR(arguments[i], expected[i], 1E-12);
+}
+
+TEST(TestSparseRegression, linearRegression) {
+    const auto model = randomModel<ml::LinearModel<ml::Dynamic>>(-5.0, 5.0);
+    const auto dataset = createSyntheticDataset(model, 5000);
+
+    ml::SparseLinearRegression<> regression;
+    regression.fit(dataset, ml::LBFGS());
+
+    const auto test = createSyntheticDataset(model, 1000, 2);
+    std::vector<double> predictions(test.size());
+    regression.predictBatch(test, predictions.data());
+    for (size_t i = 0; i < test.size(); i++) {
+        EXPECT_NEAR(predictions[i], test.label(i), 1E-3);
+        EXPECT_EQ(predictions[i], regression.predict(test.row(i)));
+    }
+}
+
+TEST(TestSparseRegression, logisticRegressionSGD) {
+    const auto model = randomModel<ml::LogisticModel<ml::Dynamic>>(-1.0, 1.0);
+    const auto dataset = createSyntheticDataset(model, 5000);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = ml::StochasticGradientDescent::Method::Plain;
+    hyperParameters.learningRate = 0.5;
+    hyperParameters.maxEpochs = 50;
+
+    ml::SparseLogisticRegression<> regression;
+    regression.fit(dataset, ml::StochasticGradientDescent().withHyperParameters(hyperParameters));
+
+    const auto test = createSyntheticDataset(model, 1000, 2);
+    double avgError = 0.0;
+    for (size_t i = 0; i < test.size(); i++)
+        avgError += std::fabs(regression.predict(test.row(i)) - test.label(i));
+
+    EXPECT_LT(avgError / static_cast<double>(test.size()), 0.02);
+}
+
+TEST(TestSparseRegression, observedSGD) {
+    const auto model = randomModel<ml::LogisticModel<ml::Dynamic>>(-1.0, 1.0);
+    const auto dataset = createSyntheticDataset(model, 500);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = ml::StochasticGradientDescent::Method::Plain;
+    hyperParameters.learningRate = 0.5;
+    hyperParameters.maxEpochs = 3;
+    const auto optimizer = ml::StochasticGradientDescent().withHyperParameters(hyperParameters);
+
+    // Observed functions keep their sparse steps, so the fit is the same.
+    ml::SparseLogisticRegression<> expected, regression;
+    expected.fit(dataset, optimizer);
+    ml::StatsObserver observer;
+    regression.fit(dataset, ml::observed(optimizer, observer));
+
+    EXPECT_EQ(observer.stats().iterations.size(), 3u);
+    const auto &parameters = regression.model().parameters();
+    for (size_t i = 0; i < parameters.size(); i++)
+        EXPECT_EQ(parameters[i], expected.model().parameters()[i]);
+}
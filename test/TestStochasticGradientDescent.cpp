@@ -0,0 +1,183 @@
+#include <melon/LinearRegression.h>
+#include <melon/LogisticRegression.h>
+#include <melon/Random.h>
+#include <melon/StochasticGradientDescent.h>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+template <typename TModel>
+ml::TrainingSet<TModel::ArgumentDim> createSyntheticTrainingSet(const TModel &model,
+                                                                const size_t numExamples,
+                                                                const double range) {
+    ml::TrainingSet<TModel::ArgumentDim> trainingSet;
+    ml::Random random;
+
+    for (size_t count = 0; count < numExamples; count++) {
+        const auto x = random.uniform<ml::Vector<TModel::ArgumentDim>>(-range, range);
+        trainingSet.emplace_back(x, model.eval(x));
+    }
+
+    return trainingSet;
+}
+
+using Method = ml::StochasticGradientDescent::Method;
+
+double logisticLearningRate(const Method method) {
+    switch (method) {
+    case Method::Plain:
+        return 2.0;
+    case Method::Momentum:
+        return 0.5;
+    case Method::Nesterov:
+        return 1.0;
+    case Method::Adam:
+    default:
+        return 0.2;
+    }
+}
+} // namespace
+
+class TestStochasticGradientDescent : public ::testing::TestWithParam<Method> {};
+
+TEST_P(TestStochasticGradientDescent, linearRegression) {
+    ml::LinearModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7, -4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 10000, 100.0);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = GetParam();
+    hyperParameters.learningRate = GetParam() == Method::Adam ? 0.5 : 0.01;
+    hyperParameters.maxEpochs = 20;
+
+    ml::LinearRegression<10> regression;
+    regression.fit(trainingSet,
+                   ml::StochasticGradientDescent().withHyperParameters(hyperParameters));
+
+    ml::Random random;
+    const size_t numTests = 1000;
+    const double errorTolerance = 1E-5;
+    size_t passed = 0;
+    for (size_t i = 0; i < numTests; i++) {
+        const auto x = random.uniform<ml::Vector<10>>(-1.0, 1.0);
+        if (std::fabs(model.eval(x) - regression.predict(x)) < errorTolerance)
+            passed++;
+    }
+
+    EXPECT_EQ(numTests, passed);
+}
+
+TEST_P(TestStochasticGradientDescent, learningRateSchedules) {
+    using Schedule = ml::StochasticGradientDescent::Schedule;
+
+    ml::LinearModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7, -4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 10000, 100.0);
+
+    for (const Schedule schedule : {Schedule::InverseTime, Schedule::Exponential}) {
+        ml::StochasticGradientDescent::HyperParameters hyperParameters;
+        hyperParameters.method = GetParam();
+        hyperParameters.schedule = schedule;
+        hyperParameters.learningRate = GetParam() == Method::Adam ? 0.5 : 0.01;
+        hyperParameters.decayRate = 0.1;
+        hyperParameters.decayFactor = 0.95;
+        hyperParameters.maxEpochs = 50;
+
+        const auto optimizer = ml::StochasticGradientDescent().withHyperParameters(hyperParameters);
+        for (size_t epoch = 0; epoch < hyperParameters.maxEpochs; epoch++) {
+            const double t = static_cast<double>(epoch);
+            const double expected =
+                schedule == Schedule::InverseTime
+                    ? hyperParameters.learningRate / (1.0 + hyperParameters.decayRate * t)
+                    : hyperParameters.learningRate * std::pow(hyperParameters.decayFactor, t);
+            EXPECT_DOUBLE_EQ(expected, optimizer.scheduledLearningRate(epoch));
+        }
+
+        ml::LinearRegression<10> regression;
+        regression.fit(trainingSet, optimizer);
+
+        ml::Random random;
+        const size_t numTests = 1000;
+        const double errorTolerance = 1E-5;
+        size_t passed = 0;
+        for (size_t i = 0; i < numTests; i++) {
+            const auto x = random.uniform<ml::Vector<10>>(-1.0, 1.0);
+            if (std::fabs(model.eval(x) - regression.predict(x)) < errorTolerance)
+                passed++;
+        }
+
+        EXPECT_EQ(numTests, passed);
+    }
+}
+
+TEST_P(TestStochasticGradientDescent, logisticRegression) {
+    ml::LogisticModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7 - 4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000, 10.0);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = GetParam();
+    hyperParameters.learningRate = logisticLearningRate(GetParam());
+    hyperParameters.batchSize = 8;
+    hyperParameters.maxEpochs = 50;
+
+    ml::LogisticRegression<10> regression;
+    regression.fit(trainingSet,
+                   ml::StochasticGradientDescent().withHyperParameters(hyperParameters));
+
+    ml::Random random;
+    const size_t numTests = 1000;
+    const double errorTolerance = 0.02;
+    double avgError = 0.0;
+    for (size_t i = 0; i < numTests; i++) {
+        const auto x = random.uniform<ml::Vector<10>>(-10.0, 10.0);
+        avgError += std::fabs(model.eval(x) - regression.predict(x));
+    }
+
+    avgError /= static_cast<double>(numTests);
+
+    EXPECT_LT(avgError, errorTolerance);
+}
+
+TEST_P(TestStochasticGradientDescent, observer) {
+    ml::LinearModel<10> model({3.0, 1.0, -4.0, 10.0, 1.5, -1.5, 3.0, 4.7, -4.7, -10.0, 4.5});
+    const auto trainingSet = createSyntheticTrainingSet(model, 1000, 100.0);
+
+    ml::StochasticGradientDescent::HyperParameters hyperParameters;
+    hyperParameters.method = GetParam();
+    hyperParameters.learningRate = GetParam() == Method::Adam ? 0.5 : 0.01;
+    hyperParameters.maxEpochs = 5;
+    hyperParameters.relativeStepTolerance = 0.0;
+    const auto optimizer = ml::StochasticGradientDescent().withHyperParameters(hyperParameters);
+
+    ml::LinearRegression<10> expected, regression;
+    expected.fit(trainingSet, optimizer);
+    ml::StatsObserver observer;
+    regression.fit(trainingSet, ml::observed(optimizer, observer));
+
+    // Observing reports one iteration per epoch and leaves the steps unchanged.
+    const auto &stats = observer.stats();
+    ASSERT_EQ(stats.iterations.size(), hyperParameters.maxEpochs);
+    EXPECT_EQ(stats.numGradients, 5 * (1000 / 32 + 1) + hyperParameters.maxEpochs + 1);
+    for (size_t i = 0; i < stats.iterations.size(); i++) {
+        EXPECT_EQ(stats.iterations[i].iteration, i + 1);
+        EXPECT_GT(stats.iterations[i].gradientNorm, 0.0);
+        EXPECT_GT(stats.iterations[i].stepSize, 0.0);
+    }
+    for (size_t i = 0; i < 11; i++)
+        EXPECT_EQ(regression.model().parameters()[i], expected.model().parameters()[i]);
+
+    ml::StatsObserver stopping([](const ml::IterationInfo &info) { return info.iteration < 2; });
+    const ml::LinearRegressionCostFunction<10> costFunction(trainingSet);
+    const auto stopped =
+        optimizer.optimize(costFunction, ml::zeros<ml::Vector<11>>(11), stopping);
+    EXPECT_EQ(stopped.stopReason, ml::StopReason::Observer);
+    EXPECT_EQ(stopped.numIterations, 2u);
+}
+
+INSTANTIATE_TEST_SUITE_P(Methods, TestStochasticGradientDescent,
+                         ::testing::Values(Method::Plain, Method::Momentum, Method::Nesterov,
+                                           Method::Adam));
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,99 @@
+#include <melon/ThreadPool.h>
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <numeric>
+#include <thread>
+
+TEST(TestThreadPool, parallelFor) {
+    ml::ThreadPool pool(4);
+    std::vector<int> visits(1000, 0);
+
+    pool.parallelFor(visits.size(), [&](const size_t i) { visits[i]++; });
+
+    for (const auto &count : visits)
+        EXPECT_EQ(count, 1);
+}
+
+TEST(TestThreadPool, nestedParallelFor) {
+    ml::ThreadPool pool(4);
+    std::vector<std::vector<int>> visits(8, std::vector<int>(8, 0));
+
+    pool.parallelFor(visits.size(), [&](const size_t i) {
+        pool.parallelFor(visits[i].size(), [&](const size_t j) { visits[i][j]++; });
+    });
+
+    for (const auto &row : visits)
+        for (const auto &count : row)
+            EXPECT_EQ(count, 1);
+}
+
+TEST(TestThreadPool, shardedReduce) {
+    ml::ThreadPool pool(3);
+    std::vector<double> values(10000);
+    for (size_t i = 0; i < values.size(); i++)
+        values[i] = 1.0 / static_cast<double>(i + 1);
+
+    const auto sum = [&](ml::ThreadPool *threadPool) {
+        return ml::shardedReduce(
+            threadPool, values.size(), 100,
+            [&](const size_t begin, const size_t end) {
+                return std::accumulate(values.begin() + begin, values.begin() + end, 0.0);
+            },
+            [](double &result, const double partial) { result += partial; });
+    };
+
+    const double expected = std::accumulate(values.begin(), values.end(), 0.0);
+    const double actual = sum(&pool);
+    EXPECT_NEAR(actual, expected, 1E-12);
+    EXPECT_EQ(sum(nullptr), expected);
+
+    for (size_t run = 0; run < 10; run++)
+        EXPECT_EQ(sum(&pool), actual);
+}
+
+TEST(TestThreadPool, parallelForWorkStealing) {
+    ml::ThreadPool pool(4);
+    std::vector<int> visits(1000, 0);
+    std::vector<size_t> workers(visits.size());
+
+    // Tasks are dealt round-robin: the slow tasks all go to thread 0, so the other threads
+    // steal from it.
+    pool.parallelForWorkStealing(visits.size(), [&](const size_t i, const size_t worker) {
+        if (i < 32 && i % 4 == 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        visits[i]++;
+        workers[i] = worker;
+    });
+
+    for (const auto &count : visits)
+        EXPECT_EQ(count, 1);
+    for (const auto &worker : workers)
+        EXPECT_LT(worker, pool.size());
+
+    // Every task runs once whether or not the threads are dealt the same number of tasks.
+    for (const size_t numTasks : {3u, 4u, 7u, 9u, 1001u}) {
+        std::vector<std::atomic<int>> dealt(numTasks);
+        pool.parallelForWorkStealing(numTasks, [&](const size_t i, size_t) { dealt[i]++; });
+        for (const auto &count : dealt)
+            EXPECT_EQ(count.load(), 1);
+    }
+
+    // Nested loops run serially on the worker of the enclosing task.
+    std::vector<size_t> nested(16, 0);
+    pool.parallelForWorkStealing(4, [&](const size_t i, const size_t worker) {
+        pool.parallelForWorkStealing(4, [&](const size_t j, const size_t nestedWorker) {
+            EXPECT_EQ(nestedWorker, worker);
+            nested[i * 4 + j]++;
+        });
+    });
+    for (const auto &count : nested)
+        EXPECT_EQ(count, 1u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -2,6 +2,9 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cmath>
+
 TEST(TestTypes, sqLength) {
     {
         ml::Vector<2> vec = {4.0, 3.0};
@@ -47,6 +50,83 @@ TEST(TestTypes, scalarMul) {
     }
 }
 
+TEST(TestTypes, dynamicVector) {
+    const ml::DynamicVector lhs = {4.0, 3.0, -1.0}, rhs = {-1.0, 2.0, 0.5};
+
+    EXPECT_EQ(lhs.size(), 3u);
+    EXPECT_EQ(ml::sqLength(lhs), 26.0);
+    EXPECT_EQ(ml::dot(lhs, rhs), 1.5);
+    EXPECT_EQ(ml::operator-(lhs, rhs), ml::DynamicVector({5.0, 1.0, -1.5}));
+    EXPECT_EQ(ml::operator*(2.0, lhs), ml::DynamicVector({8.0, 6.0, -2.0}));
+    EXPECT_EQ(ml::zeros<ml::Vector<ml::Dynamic>>(2), ml::DynamicVector({0.0, 0.0}));
+}
+
+TEST(TestTypes, expression) {
+    using ml::operator+, ml::operator-, ml::operator*, ml::operator/;
+    using ml::operator+=, ml::operator-=, ml::operator*=, ml::operator/=;
+    const ml::Vector<3> x = {1.0, -2.0, 3.0}, y = {0.5, 4.0, -1.0};
+
+    const auto lazy = 2.0 * x - y / 2.0;
+    const ml::Vector<3> expected = {1.75, -6.0, 6.5};
+    EXPECT_EQ(expected, lazy);
+    EXPECT_EQ(expected, -(y / 2.0 - x * 2.0));
+
+    // Temporaries are owned by the expression, named vectors are referenced.
+    const auto owned = ml::Vector<3>{1.0, 1.0, 1.0} + x;
+    EXPECT_EQ(ml::Vector<3>({2.0, -1.0, 4.0}), owned);
+
+    const auto clipped = ml::map([](double a, double b) { return std::max(a, b); }, x, y);
+    EXPECT_EQ(ml::Vector<3>({1.0, 4.0, 3.0}), clipped);
+
+    ml::Vector<3> z = x;
+    z += x * y;
+    z -= 1.0;
+    z *= 2.0;
+    z /= ml::Vector<3>{2.0, 1.0, 4.0};
+    EXPECT_EQ(ml::Vector<3>({0.5, -22.0, -0.5}), z);
+
+    // The right-hand side may refer to the assigned vector.
+    z = z - z * 0.5;
+    EXPECT_EQ(ml::Vector<3>({0.25, -11.0, -0.25}), z);
+
+    EXPECT_EQ(ml::Vector<3>({1.0, 4.0, 9.0}),
+              ml::apply(x, [](const double a) { return a * a; }));
+}
+
+TEST(TestTypes, apply) {
+    const ml::Vector<3> x = {1.0, -2.0, 4.0};
+    const double offset = 0.5;
+
+    // The dimension is deduced from the vector, and any callable is accepted.
+    EXPECT_EQ(ml::Vector<3>({1.5, -1.5, 4.5}),
+              ml::apply(x, [offset](const double a) { return a + offset; }));
+    EXPECT_EQ(ml::Vector<3>({-1.0, 2.0, -4.0}), ml::apply(x, std::negate<>()));
+    EXPECT_EQ(ml::DynamicVector({1.0, 2.0, 4.0}),
+              ml::apply(ml::DynamicVector({1.0, -2.0, 4.0}),
+                        [](const double a) { return std::abs(a); }));
+}
+
+TEST(TestTypes, expressionReductions) {
+    // Longer than a reduction block, with a partial last block.
+    const size_t size = 1000;
+    ml::DynamicVector x(size), y(size);
+    double expectedLength = 0.0, expectedDot = 0.0;
+    for (size_t i = 0; i < size; i++) {
+        x[i] = 0.01 * static_cast<double>(i);
+        y[i] = 1.0 - 0.002 * static_cast<double>(i);
+        expectedLength += (x[i] - y[i]) * (x[i] - y[i]);
+        expectedDot += (x[i] + 1.0) * y[i];
+    }
+
+    EXPECT_NEAR(expectedLength, ml::sqLength(x - y), 1E-9 * expectedLength);
+    EXPECT_NEAR(expectedDot, ml::dot(x + 1.0, y), 1E-9 * std::abs(expectedDot));
+    EXPECT_NEAR(expectedDot, ml::dot(y, x + 1.0), 1E-9 * std::abs(expectedDot));
+
+    const ml::DynamicVector difference = x - y;
+    ASSERT_EQ(difference.size(), size);
+    EXPECT_DOUBLE_EQ(difference[size - 1], x[size - 1] - y[size - 1]);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();